@@ -0,0 +1,58 @@
+// Measures the CPU cycles spent by Wireless to authenticate a frame, on a computer, to compare with mac-benchmark.ino on the board
+// From the benchmarks/mac-benchmark directory:
+// g++ -O2 -o mac-benchmark-host host/mac-benchmark-host.cpp src/libs/crypto/siphash.cpp && ./mac-benchmark-host
+
+#include <chrono>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER 1
+#endif
+
+#include "../src/libs/crypto/siphash.h"
+
+// Authenticated bytes: payload + 4-byte counter + radio ID of the sender (same as mac-benchmark.ino)
+const uint8_t AUTHENTICATED_SIZES[] = { 7, 9, 12, 27 };
+
+const unsigned int REPETITIONS = 1000000;
+
+uint8_t key[SIPHASH_KEY_SIZE];
+uint8_t data[32];
+volatile uint64_t result; // Volatile for the computation to not be optimized away
+
+int main()
+{
+  printf("MAC benchmark (SipHash-2-4)\n");
+
+  for (uint8_t i = 0; i < SIPHASH_KEY_SIZE; i++) {
+    key[i] = i;
+  }
+  for (uint8_t i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+
+  for (uint8_t size : AUTHENTICATED_SIZES) {
+    const auto start = std::chrono::steady_clock::now();
+#ifdef HAS_CYCLE_COUNTER
+    const unsigned long long startCycles = __rdtsc();
+#endif
+
+    for (unsigned int repetition = 0; repetition < REPETITIONS; repetition++) {
+      result = siphash24(key, data, size);
+    }
+
+#ifdef HAS_CYCLE_COUNTER
+    const unsigned long long cycles = (__rdtsc() - startCycles) / REPETITIONS; // Reference cycles of the time-stamp counter
+#endif
+    const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / REPETITIONS;
+
+    printf("%u bytes: ", size);
+#ifdef HAS_CYCLE_COUNTER
+    printf("%llu cycles, ", cycles);
+#endif
+    printf("%.1f ns on average\n", nanoseconds);
+  }
+
+  return 0;
+}
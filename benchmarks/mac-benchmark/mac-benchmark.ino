@@ -0,0 +1,78 @@
+// Measures the CPU cycles spent by Wireless to authenticate a frame, on the board (ATmega328 at 16 MHz)
+// Upload it, and open the Serial Monitor at 115200 bauds
+// See host/mac-benchmark-host.cpp for the same measure on a computer
+
+#include "src/libs/crypto/siphash.h"
+
+// Authenticated bytes: payload + 4-byte counter + radio ID of the sender
+// Polling (2 bytes), door status (4 bytes), 4 button presses (7 bytes), largest payload (22 bytes)
+const uint8_t AUTHENTICATED_SIZES[] = { 7, 9, 12, 27 };
+const uint8_t AUTHENTICATED_SIZES_COUNT = sizeof(AUTHENTICATED_SIZES) / sizeof(uint8_t);
+
+const unsigned int REPETITIONS = 1000;
+
+uint8_t key[SIPHASH_KEY_SIZE];
+uint8_t data[32];
+volatile uint64_t result; // Volatile for the computation to not be optimized away
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("MAC benchmark (SipHash-2-4)");
+
+  for (uint8_t i = 0; i < SIPHASH_KEY_SIZE; i++) {
+    key[i] = i;
+  }
+  for (uint8_t i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+
+  // Timer1 without prescaler counts CPU cycles (stopping the millis() timer is not needed: interrupts are disabled during measures)
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+
+  const uint16_t measureOverhead = measureCycles(0, false);
+
+  for (uint8_t i = 0; i < AUTHENTICATED_SIZES_COUNT; i++) {
+    const uint8_t size = AUTHENTICATED_SIZES[i];
+
+    const uint16_t cycles = measureCycles(size, true) - measureOverhead;
+    const bool overflowed = (TIFR1 & _BV(TOV1));
+
+    const unsigned long start = micros();
+    for (unsigned int repetition = 0; repetition < REPETITIONS; repetition++) {
+      result = siphash24(key, data, size);
+    }
+    const unsigned long averageMicros = (micros() - start) / REPETITIONS;
+
+    Serial.print(size);
+    Serial.print(" bytes: ");
+    if (overflowed) {
+      Serial.print("more than 65535");
+    } else {
+      Serial.print(cycles);
+    }
+    Serial.print(" cycles, ");
+    Serial.print(averageMicros);
+    Serial.println(" us on average");
+  }
+}
+
+uint16_t measureCycles(uint8_t size, bool hash)
+{
+  noInterrupts();
+  TIFR1 = _BV(TOV1); // Clear the overflow flag
+  TCNT1 = 0;
+  const uint16_t start = TCNT1;
+  if (hash) {
+    result = siphash24(key, data, size);
+  }
+  const uint16_t end = TCNT1;
+  interrupts();
+
+  return end - start;
+}
+
+void loop()
+{
+}
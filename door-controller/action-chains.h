@@ -18,7 +18,9 @@ const unsigned long WILL_CLOSE_SOON_DURATION_MS = 2 * MINUTES_AS_MS;
 const unsigned long WILL_CLOSE_SOON_DURATION_MS_DEMO = 10 * SECONDS_AS_MS;
 const unsigned int  WILL_CLOSE_SOON_MELODY_COUNT = 2;
 
-const unsigned long CLOSING_RETRY_DELAY_MS = 25 * SECONDS_AS_MS; // Must be more than enough for the door to open or close completely (timed at 20 seconds: add some margin)
+#ifndef CLOSING_RETRY_DELAY_MS // Can be set when building (see host/Makefile)
+#define CLOSING_RETRY_DELAY_MS (25 * SECONDS_AS_MS) // Must be more than enough for the door to open or close completely (timed at 20 seconds: add some margin)
+#endif
 const unsigned long CLOSING_RETRY_DELAY_MS_DEMO = 5 * SECONDS_AS_MS;
 
 ActionOrchestrator actionOrchestrator = ActionOrchestrator();
@@ -30,35 +32,53 @@ extern void sendEventStartClosingFailed();
 // Actions in a chain are run one at a time.
 // Only one action-chain is active at a given time: there is only one ActionOrchestrator.
 // When a chain is replaced by another one, previously started actions are all cancelled: turn off LEDs, buzzer...
+// Actions are static objects (never allocated with `new`) and chains are stored in flash memory (PROGMEM), to save SRAM.
 
-const Action* DOOR_SENSOR_ANOMALY_ACTION_CHAIN[] = {
+const Action *const DOOR_SENSOR_ANOMALY_ACTION_CHAIN[] PROGMEM = {
 };
 const uint8_t DOOR_SENSOR_ANOMALY_ACTION_CHAIN_SIZE = sizeof(DOOR_SENSOR_ANOMALY_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* CLOSED_ACTION_CHAIN[] = {
+const Action *const CLOSED_ACTION_CHAIN[] PROGMEM = {
 };
 const uint8_t CLOSED_ACTION_CHAIN_SIZE = sizeof(CLOSED_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* OPEN_ACTION_CHAIN[] = {
-  new DemoModeAwareWaitAction(
-    OPEN_DURATION_MS,
-    OPEN_DURATION_MS_DEMO),
-  new RunnableAction([]() { sendEventStartWillCloseSoon(); })
+const DemoModeAwareWaitAction OPEN_WAIT_ACTION = DemoModeAwareWaitAction(
+  OPEN_DURATION_MS,
+  OPEN_DURATION_MS_DEMO);
+const RunnableAction SEND_EVENT_START_WILL_CLOSE_SOON_ACTION = RunnableAction(&sendEventStartWillCloseSoon);
+
+const Action *const OPEN_ACTION_CHAIN[] PROGMEM = {
+  &OPEN_WAIT_ACTION,
+  &SEND_EVENT_START_WILL_CLOSE_SOON_ACTION
 };
 const uint8_t OPEN_ACTION_CHAIN_SIZE = sizeof(OPEN_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* WILL_CLOSE_SOON_ACTION_CHAIN[] = {
-  new LoopBeginAction(WILL_CLOSE_SOON_MELODY_COUNT),
-  new StartPlayingMelodyAction(&buzzer, &WILL_CLOSE_SOON_MELODY),
-  new DemoModeAwareWaitAction(
-    WILL_CLOSE_SOON_DURATION_MS / WILL_CLOSE_SOON_MELODY_COUNT,
-    WILL_CLOSE_SOON_DURATION_MS_DEMO / WILL_CLOSE_SOON_MELODY_COUNT),
+const LoopBeginAction WILL_CLOSE_SOON_LOOP_BEGIN_ACTION = LoopBeginAction(WILL_CLOSE_SOON_MELODY_COUNT);
+const StartPlayingMelodyAction PLAY_WILL_CLOSE_SOON_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &WILL_CLOSE_SOON_MELODY);
+const DemoModeAwareWaitAction WILL_CLOSE_SOON_WAIT_ACTION = DemoModeAwareWaitAction(
+  WILL_CLOSE_SOON_DURATION_MS / WILL_CLOSE_SOON_MELODY_COUNT,
+  WILL_CLOSE_SOON_DURATION_MS_DEMO / WILL_CLOSE_SOON_MELODY_COUNT);
+const RunnableAction SEND_EVENT_START_AUTO_CLOSE_ACTION = RunnableAction(&sendEventStartAutoClose);
+
+const Action *const WILL_CLOSE_SOON_ACTION_CHAIN[] PROGMEM = {
+  &WILL_CLOSE_SOON_LOOP_BEGIN_ACTION,
+  &PLAY_WILL_CLOSE_SOON_MELODY_ACTION,
+  &WILL_CLOSE_SOON_WAIT_ACTION,
   &LOOP_END_ACTION,
-  new RunnableAction([]() { sendEventStartAutoClose(); })
+  &SEND_EVENT_START_AUTO_CLOSE_ACTION
 };
 const uint8_t WILL_CLOSE_SOON_ACTION_CHAIN_SIZE = sizeof(WILL_CLOSE_SOON_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* CLOSING_ACTION_CHAIN[] = {
+const LoopBeginAction CLOSING_LOOP_BEGIN_ACTION = LoopBeginAction(4);
+const TemporarilyPowerOnRelayAction POWER_ON_DOOR_RELAY_1_ACTION = TemporarilyPowerOnRelayAction(&doorRelay1, 1000);
+const WaitAction DOOR_RELAYS_STAGGER_WAIT_ACTION = WaitAction(150); // Not at the same time, to avoid too much power draw at once: that would lock the NRF24L01+ up until Wireless re-initializes it, or even power-cycles it (see Wireless::loop())
+const TemporarilyPowerOnRelayAction POWER_ON_DOOR_RELAY_2_ACTION = TemporarilyPowerOnRelayAction(&doorRelay2, 1000);
+const DemoModeAwareWaitAction CLOSING_RETRY_WAIT_ACTION = DemoModeAwareWaitAction(
+  CLOSING_RETRY_DELAY_MS,
+  CLOSING_RETRY_DELAY_MS_DEMO);
+const RunnableAction SEND_EVENT_START_CLOSING_FAILED_ACTION = RunnableAction(&sendEventStartClosingFailed);
+
+const Action *const CLOSING_ACTION_CHAIN[] PROGMEM = {
   // IMPORTANT:
   // * Odd number of attempts, in case the door sensor is bad:
   //   if we opened the door, make sure we close it; then abort attempts to close it.
@@ -66,24 +86,24 @@ const Action* CLOSING_ACTION_CHAIN[] = {
   //   powering on the door will first re-open it, and then close it
   // * In-between retries, make sure to wait enough time to completely open or close the door
   //   to be sure we try our best for a successful closing
-  new LoopBeginAction(4),
-  new TemporarilyPowerOnRelayAction(&doorRelay1, 1000),
-  new WaitAction(150), // Not at the same time, to avoid too much power draw at once: that would render the NRF24L01+ unusable until a hard-reset
-  new TemporarilyPowerOnRelayAction(&doorRelay2, 1000),
-  new DemoModeAwareWaitAction(
-    CLOSING_RETRY_DELAY_MS,
-    CLOSING_RETRY_DELAY_MS_DEMO),
+  &CLOSING_LOOP_BEGIN_ACTION,
+  &POWER_ON_DOOR_RELAY_1_ACTION,
+  &DOOR_RELAYS_STAGGER_WAIT_ACTION,
+  &POWER_ON_DOOR_RELAY_2_ACTION,
+  &CLOSING_RETRY_WAIT_ACTION,
   &LOOP_END_ACTION,
-  new RunnableAction([]() { sendEventStartClosingFailed(); })
+  &SEND_EVENT_START_CLOSING_FAILED_ACTION
 };
 const uint8_t CLOSING_ACTION_CHAIN_SIZE = sizeof(CLOSING_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* CLOSING_FAILED_ACTION_CHAIN[] = {
+const Action *const CLOSING_FAILED_ACTION_CHAIN[] PROGMEM = {
 };
 const uint8_t CLOSING_FAILED_ACTION_CHAIN_SIZE = sizeof(CLOSING_FAILED_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* KEPT_OPEN_ACTION_CHAIN[] = {
-  new TurnOnLedAction(&keptOpenLed)
+const TurnOnLedAction TURN_ON_KEPT_OPEN_LED_ACTION = TurnOnLedAction(&keptOpenLed);
+
+const Action *const KEPT_OPEN_ACTION_CHAIN[] PROGMEM = {
+  &TURN_ON_KEPT_OPEN_LED_ACTION
 };
 const uint8_t KEPT_OPEN_ACTION_CHAIN_SIZE = sizeof(KEPT_OPEN_ACTION_CHAIN) / sizeof(Action*);
 
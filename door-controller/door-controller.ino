@@ -6,7 +6,7 @@
 #include "wireless-messages.h" // Defines messages exchanged by radio
 
 #include "src/libs/constants/duration-units.h"
-#include "src/libs/hardware/restarter.h"
+#include "src/libs/hardware/idle-sleeper.h"
 #include "src/libs/hardware/timer.h"
 
 extern bool sensingDoorIsOpen();
@@ -15,6 +15,7 @@ void setup()
 {
   Serial.begin(115200);
   Serial.println("Door Controller");
+  Serial.println(F("Send w to print the wireless link quality, r to reset it"));
 
   keptOpenLed.setup();
   disconnectedLed.setup();
@@ -33,50 +34,97 @@ void setup()
   autoCloseFeedback.setup();
 
   wireless.setup(WIRELESS_RADIO_ID, WIRELESS_DESTINATION_RADIO_ID, WIRELESS_CHANNEL);
-  wireless.enableReceptionTimeout(WIRELESS_RECEPTION_TIMEOUT_MS, &onReceptionTimeout);
-
-  // See documentation of the class Restarter for delay recommendations
-  Restarter::setup(
-    /* gracefulRestartDelay = */ 48 * DAYS_AS_MS + 12 * HOURS_AS_MS, // Hopefully, once in 3 months, it will be during night for nobody to notice the restart
-    /* forcedRestartDelay = */ 12 * HOURS_AS_MS,
-    []() {
-      return !sensingDoorIsOpen();
-    });
+#ifdef WIRELESS_AUTHENTICATION_KEY_TO_PROVISION
+  const uint8_t key[SIPHASH_KEY_SIZE] = WIRELESS_AUTHENTICATION_KEY_TO_PROVISION;
+  Wireless::provisionAuthenticationKey(WIRELESS_EEPROM_ADDRESS, key);
+#endif
+  wireless.enableAuthentication(WIRELESS_EEPROM_ADDRESS);
+  wireless.enableAdaptiveReceptionTimeout(WIRELESS_RECEPTION_TIMEOUT_MS, WIRELESS_MIN_RECEPTION_TIMEOUT_MS, WIRELESS_MAX_RECEPTION_TIMEOUT_MS, &onReceptionTimeout);
 
   doorStateMachine.start(sensingDoorIsOpen() ? &OPEN_STATE : &CLOSED_STATE);
 }
 
+bool dashboardWantsReplyInAck = false; // Depends on the header of the last message received from the dashboard
+extern void preloadDoorStatusInAck(bool force);
+
 void loop()
 {
-  keptOpenLed.loop();
-  disconnectedLed.loop();
+  const Timestamp now = millis();
+
+  keptOpenLed.loop(now);
+  disconnectedLed.loop(now);
 
-  keepOpenButton.loop();
+  InputBank::loop(now);
+  keepOpenButton.loop(now);
+  doorSensor.loop(now);
 
-  doorSensor.loop();
+  buzzer.loop(now);
 
-  buzzer.loop();
+  doorRelay1.loop(now);
+  doorRelay2.loop(now);
 
-  doorRelay1.loop();
-  doorRelay2.loop();
+  loopWireless(now);
 
-  loopWireless();
+  actionOrchestrator.loop(now);
 
-  actionOrchestrator.loop();
+  if (dashboardWantsReplyInAck) {
+    preloadDoorStatusInAck(false); // In case the status changed during this loop
+  }
+
+  loopSerialCommands();
 
-  Restarter::loop();
+  sleepUntilNextDeadline();
+}
+
+void loopSerialCommands()
+{
+  while (Serial.available() > 0) { // Received bytes wake the microcontroller up
+    const int command = Serial.read();
+    if (command == 'w') {
+      wireless.printLinkQuality();
+    } else if (command == 'r') {
+      wireless.resetLinkQuality();
+      Serial.println(F("Wireless link quality reset"));
+    }
+  }
+}
+
+void sleepUntilNextDeadline()
+{
+  IdleSleeper::wakeUpAt(keptOpenLed.nextDeadline());
+  IdleSleeper::wakeUpAt(disconnectedLed.nextDeadline());
+
+  IdleSleeper::wakeUpAt(InputBank::nextDeadline());
+  IdleSleeper::wakeUpAt(keepOpenButton.nextDeadline());
+  IdleSleeper::wakeUpAt(doorSensor.nextDeadline());
+
+  IdleSleeper::wakeUpAt(buzzer.nextDeadline());
+
+  IdleSleeper::wakeUpAt(doorRelay1.nextDeadline());
+  IdleSleeper::wakeUpAt(doorRelay2.nextDeadline());
+
+  IdleSleeper::wakeUpAt(wireless.nextDeadline());
+
+  IdleSleeper::wakeUpAt(actionOrchestrator.nextDeadline());
+
+  IdleSleeper::sleep();
 }
 
 extern void sendDoorStatus();
 
-void loopWireless()
+void loopWireless(const Timestamp now)
 {
   bool justReceived = wireless.receive(&handleWirelessDataReceived);
   if (justReceived) {
-    sendDoorStatus();
+    if (dashboardWantsReplyInAck) {
+      preloadDoorStatusInAck(true); // The previous one was just sent in the ACK of the received message
+    } else {
+      sendDoorStatus();
+      preloadDoorStatusInAck(true); // The send removed the outdated one: ready for when the dashboard retries replies in ACKs
+    }
   }
 
-  wireless.loop();
+  wireless.loop(now);
 }
 
 void onReceptionTimeout(bool timeout)
@@ -104,38 +152,65 @@ void handleDoorSensorChange(RedundantSensor::State state)
 
 void handleWirelessDataReceived(byte data[], uint8_t size)
 {
-  const byte header = data[0];
-  const byte eventId = data[1];
-  const byte buttonIndex = data[2];
+  uint8_t buttonPressCount;
+  const DashboardMessage *message = decodeDashboardMessage(data, size, &buttonPressCount);
 
-  bool messageIsErroneous = size != 3 || header != MESSAGE_HEADER;
+  bool messageIsErroneous = (message == nullptr);
 
   if (!messageIsErroneous) {
-    messageIsErroneous = handleButtonPressedMessageReceived(eventId, buttonIndex);
+    dashboardWantsReplyInAck = message->replyInAck;
+    messageIsErroneous = handleButtonPressesMessageReceived(message->firstEventId, message->buttonIndexes, buttonPressCount);
   }
 
   if (messageIsErroneous) {
     Serial.print("Received erroneous message (size ");
     Serial.print(size);
-    Serial.print("): ");
-    Serial.print(data[0]);
-    Serial.print(" ");
-    Serial.print(data[1]);
-    Serial.print(" ");
-    Serial.println(data[2]);
+    Serial.print("):");
+    for (uint8_t i = 0; i < size; i++) {
+      Serial.print(" ");
+      Serial.print(data[i]);
+    }
+    Serial.println();
     // Serial.flush();
   }
 }
 
-byte ackedButtonPressEventId;
+byte ackedButtonPressEventId; // The last handled one, acknowledging all the previous ones too (0 if none yet)
 
-bool handleButtonPressedMessageReceived(uint8_t eventId, uint8_t buttonIndex)
+byte nextEventId(byte eventId)
 {
-  bool isPolling = (eventId == 0 && buttonIndex == MESSAGE_POLLING);
-  if (isPolling || eventId == ackedButtonPressEventId) {
+  return eventId == 255 ? 1 : eventId + 1; // 0 is reserved for "no button press"
+}
+
+bool isAlreadyHandledEventId(byte eventId)
+{
+  if (ackedButtonPressEventId == 0) {
     return false;
   }
 
+  // The dashboard re-sends its pending presses until it receives their ACK: they are the ones just before the acked one
+  const uint8_t idsSinceEventId = ((unsigned int) ackedButtonPressEventId + 255 - eventId) % 255;
+  return idsSinceEventId < MESSAGE_MAX_BUTTON_PRESSES;
+}
+
+bool handleButtonPressesMessageReceived(byte firstEventId, const byte *buttonIndexes, uint8_t count)
+{
+  bool messageIsErroneous = false;
+  byte eventId = firstEventId;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!isAlreadyHandledEventId(eventId)) {
+      if (handleButtonPressedMessageReceived(buttonIndexes[i])) {
+        messageIsErroneous = true;
+      }
+      ackedButtonPressEventId = eventId; // Even if erroneous, to not block the next presses
+    }
+    eventId = nextEventId(eventId);
+  }
+  return messageIsErroneous;
+}
+
+bool handleButtonPressedMessageReceived(uint8_t buttonIndex)
+{
   if (buttonIndex == MESSAGE_PRESSED_BUTTON_KEEP_OPEN) {
     doorStateMachine.handleEvent(&EVENT_PRESSED_BUTTON_KEEP_OPEN);
 
@@ -158,20 +233,37 @@ bool handleButtonPressedMessageReceived(uint8_t eventId, uint8_t buttonIndex)
     return true;
   }
 
-  ackedButtonPressEventId = eventId;
   return false;
 }
 
+void makeDoorStatus(DoorStatusMessage *message)
+{
+  message->header = MESSAGE_HEADER;
+  message->state = stateToMessage(doorStateMachine.getCurrentState());
+  message->isAutoClosed = autoCloseFeedback.isAutoClosed();
+  message->protocolVersion = PROTOCOL_VERSION;
+  message->isDemoMode = isDemoMode;
+  message->ackedButtonPressEventId = ackedButtonPressEventId;
+}
+
 void sendDoorStatus()
 {
-  byte payload[] = {
-    MESSAGE_HEADER,
-    stateToMessage(doorStateMachine.getCurrentState()),
-    autoCloseFeedback.isAutoClosed(),
-    isDemoMode,
-    ackedButtonPressEventId
-  };
-  wireless.send(payload, sizeof(payload));
+  DoorStatusMessage message;
+  makeDoorStatus(&message);
+  wireless.send((byte *) &message, sizeof(message));
+}
+
+// The same message as sendDoorStatus(): harmless if the radio ends up sending it as a regular message
+DoorStatusMessage preloadedDoorStatus;
+
+void preloadDoorStatusInAck(bool force)
+{
+  DoorStatusMessage message;
+  makeDoorStatus(&message);
+  if (force || memcmp(&message, &preloadedDoorStatus, sizeof(message)) != 0) {
+    preloadedDoorStatus = message;
+    wireless.setAckPayload((byte *) &message, sizeof(message));
+  }
 }
 
 byte stateToMessage(const State *state)
@@ -7,14 +7,39 @@
 
 extern StateMachine doorStateMachine;
 
+// IDs: index the transition table computed at compile time (keep the same order as DOOR_STATES below)
+
+enum DoorStateId : uint8_t {
+  OPEN_STATE_ID,
+  KEPT_OPEN_STATE_ID,
+  WILL_CLOSE_SOON_STATE_ID,
+  CLOSING_STATE_ID,
+  CLOSING_FAILED_STATE_ID,
+  CLOSED_STATE_ID,
+  DOOR_SENSOR_ANOMALY_STATE_ID,
+  DOOR_STATE_COUNT
+};
+
+enum DoorEventId : uint8_t {
+  EVENT_DETECTED_DOOR_SENSOR_ANOMALY_ID,
+  EVENT_SENSED_DOOR_IS_CLOSED_ID,
+  EVENT_SENSED_DOOR_IS_OPEN_ID,
+  EVENT_PRESSED_BUTTON_KEEP_OPEN_ID,
+  EVENT_PRESSED_BUTTON_CLOSE_ID,
+  EVENT_START_WILL_CLOSE_SOON_ID,
+  EVENT_START_AUTO_CLOSE_ID,
+  EVENT_START_CLOSING_FAILED_ID,
+  DOOR_EVENT_COUNT
+};
+
 // States: start an action chain when entering another state
 
-const State OPEN_STATE = State([]() {
+const State OPEN_STATE = State(OPEN_STATE_ID, []() {
   Serial.println("In OPEN_STATE");
   actionOrchestrator.start(OPEN_ACTION_CHAIN, OPEN_ACTION_CHAIN_SIZE);
 });
 
-const State KEPT_OPEN_STATE = State([]() {
+const State KEPT_OPEN_STATE = State(KEPT_OPEN_STATE_ID, []() {
   Serial.println("In KEPT_OPEN_STATE");
   actionOrchestrator.start(KEPT_OPEN_ACTION_CHAIN, KEPT_OPEN_ACTION_CHAIN_SIZE);
 });
@@ -23,22 +48,22 @@ const State KEPT_OPEN_STATE = State([]() {
 // but having a separate state allows to:
 // * trace WILL_CLOSE_SOON=>CLOSING=>CLOSED to detect a successful automatic-closing and
 // * send a separate command to the door-controller to raise an alarm
-const State WILL_CLOSE_SOON_STATE = State([]() {
+const State WILL_CLOSE_SOON_STATE = State(WILL_CLOSE_SOON_STATE_ID, []() {
   Serial.println("In WILL_CLOSE_SOON_STATE");
   actionOrchestrator.start(WILL_CLOSE_SOON_ACTION_CHAIN, WILL_CLOSE_SOON_ACTION_CHAIN_SIZE);
 });
 
-const State CLOSING_STATE = State([]() {
+const State CLOSING_STATE = State(CLOSING_STATE_ID, []() {
   Serial.println("In CLOSING_STATE");
   actionOrchestrator.start(CLOSING_ACTION_CHAIN, CLOSING_ACTION_CHAIN_SIZE);
 });
 
-const State CLOSING_FAILED_STATE = State([]() {
+const State CLOSING_FAILED_STATE = State(CLOSING_FAILED_STATE_ID, []() {
   Serial.println("In CLOSING_FAILED_STATE");
   actionOrchestrator.start(CLOSING_FAILED_ACTION_CHAIN, CLOSING_FAILED_ACTION_CHAIN_SIZE);
 });
 
-const State CLOSED_STATE = State([]() {
+const State CLOSED_STATE = State(CLOSED_STATE_ID, []() {
   if (doorStateMachine.getBeforeLastState() == &WILL_CLOSE_SOON_STATE &&
       doorStateMachine.getLastState() == &CLOSING_STATE) {
     autoCloseFeedback.registerSuccessfulAutoClose();
@@ -48,77 +73,87 @@ const State CLOSED_STATE = State([]() {
   actionOrchestrator.start(CLOSED_ACTION_CHAIN, CLOSED_ACTION_CHAIN_SIZE);
 });
 
-const State DOOR_SENSOR_ANOMALY_STATE = State([]() {
+const State DOOR_SENSOR_ANOMALY_STATE = State(DOOR_SENSOR_ANOMALY_STATE_ID, []() {
   Serial.println("In DOOR_SENSOR_ANOMALY_STATE");
   actionOrchestrator.start(DOOR_SENSOR_ANOMALY_ACTION_CHAIN, DOOR_SENSOR_ANOMALY_ACTION_CHAIN_SIZE);
 });
 
 // Events: they are the only triggers that can act on the state machine
 
-const Event EVENT_DETECTED_DOOR_SENSOR_ANOMALY = Event();
-const Event EVENT_SENSED_DOOR_IS_CLOSED = Event();
-const Event EVENT_SENSED_DOOR_IS_OPEN = Event();
+const Event EVENT_DETECTED_DOOR_SENSOR_ANOMALY = Event(EVENT_DETECTED_DOOR_SENSOR_ANOMALY_ID);
+const Event EVENT_SENSED_DOOR_IS_CLOSED = Event(EVENT_SENSED_DOOR_IS_CLOSED_ID);
+const Event EVENT_SENSED_DOOR_IS_OPEN = Event(EVENT_SENSED_DOOR_IS_OPEN_ID);
 
-const Event EVENT_PRESSED_BUTTON_KEEP_OPEN = Event();
-const Event EVENT_PRESSED_BUTTON_CLOSE = Event();
-const Event EVENT_START_WILL_CLOSE_SOON = Event();
-const Event EVENT_START_AUTO_CLOSE = Event();
-const Event EVENT_START_CLOSING_FAILED = Event();
+const Event EVENT_PRESSED_BUTTON_KEEP_OPEN = Event(EVENT_PRESSED_BUTTON_KEEP_OPEN_ID);
+const Event EVENT_PRESSED_BUTTON_CLOSE = Event(EVENT_PRESSED_BUTTON_CLOSE_ID);
+const Event EVENT_START_WILL_CLOSE_SOON = Event(EVENT_START_WILL_CLOSE_SOON_ID);
+const Event EVENT_START_AUTO_CLOSE = Event(EVENT_START_AUTO_CLOSE_ID);
+const Event EVENT_START_CLOSING_FAILED = Event(EVENT_START_CLOSING_FAILED_ID);
 
 // Transitions: **from** a given state, when an **event** is triggered, transition **to** the new state
 
-const Transition ANY_TO_DOOR_SENSOR_ANOMALY_TRANSITION = Transition(&State::ANY, &EVENT_DETECTED_DOOR_SENSOR_ANOMALY, &DOOR_SENSOR_ANOMALY_STATE);
-const Transition ANY_TO_CLOSED_TRANSITION = Transition(&State::ANY, &EVENT_SENSED_DOOR_IS_CLOSED, &CLOSED_STATE);
-const Transition DOOR_SENSOR_ANOMALY_TO_OPEN_TRANSITION = Transition(&DOOR_SENSOR_ANOMALY_STATE, &EVENT_SENSED_DOOR_IS_OPEN, &OPEN_STATE);
+constexpr Transition ANY_TO_DOOR_SENSOR_ANOMALY_TRANSITION = Transition(State::ANY_ID, EVENT_DETECTED_DOOR_SENSOR_ANOMALY_ID, DOOR_SENSOR_ANOMALY_STATE_ID);
+constexpr Transition ANY_TO_CLOSED_TRANSITION = Transition(State::ANY_ID, EVENT_SENSED_DOOR_IS_CLOSED_ID, CLOSED_STATE_ID);
+constexpr Transition DOOR_SENSOR_ANOMALY_TO_OPEN_TRANSITION = Transition(DOOR_SENSOR_ANOMALY_STATE_ID, EVENT_SENSED_DOOR_IS_OPEN_ID, OPEN_STATE_ID);
 
-const Transition CLOSED_TO_OPEN_TRANSITION = Transition(&CLOSED_STATE, &EVENT_SENSED_DOOR_IS_OPEN, &OPEN_STATE);
+constexpr Transition CLOSED_TO_OPEN_TRANSITION = Transition(CLOSED_STATE_ID, EVENT_SENSED_DOOR_IS_OPEN_ID, OPEN_STATE_ID);
 
-const Transition OPEN_TO_KEPT_OPEN_TRANSITION       = Transition(&OPEN_STATE, &EVENT_PRESSED_BUTTON_KEEP_OPEN, &KEPT_OPEN_STATE);
-const Transition OPEN_TO_CLOSING_TRANSITION         = Transition(&OPEN_STATE, &EVENT_PRESSED_BUTTON_CLOSE,     &CLOSING_STATE);
-const Transition OPEN_TO_WILL_CLOSE_SOON_TRANSITION = Transition(&OPEN_STATE, &EVENT_START_WILL_CLOSE_SOON,    &WILL_CLOSE_SOON_STATE);
+constexpr Transition OPEN_TO_KEPT_OPEN_TRANSITION       = Transition(OPEN_STATE_ID, EVENT_PRESSED_BUTTON_KEEP_OPEN_ID, KEPT_OPEN_STATE_ID);
+constexpr Transition OPEN_TO_CLOSING_TRANSITION         = Transition(OPEN_STATE_ID, EVENT_PRESSED_BUTTON_CLOSE_ID,     CLOSING_STATE_ID);
+constexpr Transition OPEN_TO_WILL_CLOSE_SOON_TRANSITION = Transition(OPEN_STATE_ID, EVENT_START_WILL_CLOSE_SOON_ID,    WILL_CLOSE_SOON_STATE_ID);
 
-const Transition KEPT_OPEN_TO_OPEN_TRANSITION    = Transition(&KEPT_OPEN_STATE, &EVENT_PRESSED_BUTTON_KEEP_OPEN, &OPEN_STATE);
-const Transition KEPT_OPEN_TO_CLOSING_TRANSITION = Transition(&KEPT_OPEN_STATE, &EVENT_PRESSED_BUTTON_CLOSE,     &CLOSING_STATE);
+constexpr Transition KEPT_OPEN_TO_OPEN_TRANSITION    = Transition(KEPT_OPEN_STATE_ID, EVENT_PRESSED_BUTTON_KEEP_OPEN_ID, OPEN_STATE_ID);
+constexpr Transition KEPT_OPEN_TO_CLOSING_TRANSITION = Transition(KEPT_OPEN_STATE_ID, EVENT_PRESSED_BUTTON_CLOSE_ID,     CLOSING_STATE_ID);
 
-const Transition WILL_CLOSE_SOON_TO_CLOSING_BY_BUTTON_TRANSITION = Transition(&WILL_CLOSE_SOON_STATE, &EVENT_PRESSED_BUTTON_CLOSE,     &CLOSING_STATE);
-const Transition WILL_CLOSE_SOON_TO_KEPT_OPEN_TRANSITION         = Transition(&WILL_CLOSE_SOON_STATE, &EVENT_PRESSED_BUTTON_KEEP_OPEN, &KEPT_OPEN_STATE);
-const Transition WILL_CLOSE_SOON_TO_CLOSING_TRANSITION           = Transition(&WILL_CLOSE_SOON_STATE, &EVENT_START_AUTO_CLOSE,         &CLOSING_STATE);
+constexpr Transition WILL_CLOSE_SOON_TO_CLOSING_BY_BUTTON_TRANSITION = Transition(WILL_CLOSE_SOON_STATE_ID, EVENT_PRESSED_BUTTON_CLOSE_ID,     CLOSING_STATE_ID);
+constexpr Transition WILL_CLOSE_SOON_TO_KEPT_OPEN_TRANSITION         = Transition(WILL_CLOSE_SOON_STATE_ID, EVENT_PRESSED_BUTTON_KEEP_OPEN_ID, KEPT_OPEN_STATE_ID);
+constexpr Transition WILL_CLOSE_SOON_TO_CLOSING_TRANSITION           = Transition(WILL_CLOSE_SOON_STATE_ID, EVENT_START_AUTO_CLOSE_ID,         CLOSING_STATE_ID);
 
-const Transition CLOSING_TO_OPEN_TRANSITION           = Transition(&CLOSING_STATE, &EVENT_PRESSED_BUTTON_CLOSE,     &OPEN_STATE);
-const Transition CLOSING_TO_KEPT_OPEN_TRANSITION      = Transition(&CLOSING_STATE, &EVENT_PRESSED_BUTTON_KEEP_OPEN, &KEPT_OPEN_STATE);
-const Transition CLOSING_TO_CLOSING_FAILED_TRANSITION = Transition(&CLOSING_STATE, &EVENT_START_CLOSING_FAILED,     &CLOSING_FAILED_STATE);
+constexpr Transition CLOSING_TO_OPEN_TRANSITION           = Transition(CLOSING_STATE_ID, EVENT_PRESSED_BUTTON_CLOSE_ID,     OPEN_STATE_ID);
+constexpr Transition CLOSING_TO_KEPT_OPEN_TRANSITION      = Transition(CLOSING_STATE_ID, EVENT_PRESSED_BUTTON_KEEP_OPEN_ID, KEPT_OPEN_STATE_ID);
+constexpr Transition CLOSING_TO_CLOSING_FAILED_TRANSITION = Transition(CLOSING_STATE_ID, EVENT_START_CLOSING_FAILED_ID,     CLOSING_FAILED_STATE_ID);
 
-const Transition* DOOR_TRANSITION_VALUES[] = {
-  &ANY_TO_DOOR_SENSOR_ANOMALY_TRANSITION,
-  &ANY_TO_CLOSED_TRANSITION,
-  &DOOR_SENSOR_ANOMALY_TO_OPEN_TRANSITION,
+constexpr Transition DOOR_TRANSITION_VALUES[] = {
+  ANY_TO_DOOR_SENSOR_ANOMALY_TRANSITION,
+  ANY_TO_CLOSED_TRANSITION,
+  DOOR_SENSOR_ANOMALY_TO_OPEN_TRANSITION,
 
-  &CLOSED_TO_OPEN_TRANSITION,
+  CLOSED_TO_OPEN_TRANSITION,
 
-  &OPEN_TO_KEPT_OPEN_TRANSITION,
-  &OPEN_TO_CLOSING_TRANSITION,
-  &OPEN_TO_WILL_CLOSE_SOON_TRANSITION,
+  OPEN_TO_KEPT_OPEN_TRANSITION,
+  OPEN_TO_CLOSING_TRANSITION,
+  OPEN_TO_WILL_CLOSE_SOON_TRANSITION,
 
-  &KEPT_OPEN_TO_OPEN_TRANSITION,
-  &KEPT_OPEN_TO_CLOSING_TRANSITION,
+  KEPT_OPEN_TO_OPEN_TRANSITION,
+  KEPT_OPEN_TO_CLOSING_TRANSITION,
 
-  &WILL_CLOSE_SOON_TO_CLOSING_BY_BUTTON_TRANSITION,
-  &WILL_CLOSE_SOON_TO_KEPT_OPEN_TRANSITION,
-  &WILL_CLOSE_SOON_TO_CLOSING_TRANSITION,
+  WILL_CLOSE_SOON_TO_CLOSING_BY_BUTTON_TRANSITION,
+  WILL_CLOSE_SOON_TO_KEPT_OPEN_TRANSITION,
+  WILL_CLOSE_SOON_TO_CLOSING_TRANSITION,
 
-  &CLOSING_TO_OPEN_TRANSITION,
-  &CLOSING_TO_KEPT_OPEN_TRANSITION,
-  &CLOSING_TO_CLOSING_FAILED_TRANSITION
+  CLOSING_TO_OPEN_TRANSITION,
+  CLOSING_TO_KEPT_OPEN_TRANSITION,
+  CLOSING_TO_CLOSING_FAILED_TRANSITION
 };
 
-const Transitions DOOR_TRANSITIONS = {
-  .length = sizeof(DOOR_TRANSITION_VALUES) / sizeof(Transition*),
-  .values = DOOR_TRANSITION_VALUES
-};
+static_assert(!hasConflictingTransitions(DOOR_TRANSITION_VALUES), "Two transitions start from the same state on the same event");
+
+constexpr TransitionTable<DOOR_STATE_COUNT, DOOR_EVENT_COUNT> DOOR_TRANSITIONS =
+  makeTransitionTable<DOOR_STATE_COUNT, DOOR_EVENT_COUNT>(DOOR_TRANSITION_VALUES);
 
 // State Machine
 
-StateMachine doorStateMachine = StateMachine(&DOOR_TRANSITIONS);
+const State *const DOOR_STATES[DOOR_STATE_COUNT] = {
+  &OPEN_STATE,
+  &KEPT_OPEN_STATE,
+  &WILL_CLOSE_SOON_STATE,
+  &CLOSING_STATE,
+  &CLOSING_FAILED_STATE,
+  &CLOSED_STATE,
+  &DOOR_SENSOR_ANOMALY_STATE
+};
+
+StateMachine doorStateMachine = StateMachine(DOOR_STATES, &DOOR_TRANSITIONS);
 
 // Actions to send events elsewhere
 
@@ -1,9 +1,9 @@
 #ifndef DURATION_UNITS_H
 #define DURATION_UNITS_H
 
-unsigned long SECONDS_AS_MS = 1000;
-unsigned long MINUTES_AS_MS = 60 * SECONDS_AS_MS;
-unsigned long HOURS_AS_MS = 60 * MINUTES_AS_MS;
-unsigned long DAYS_AS_MS = 24 * HOURS_AS_MS;
+const unsigned long SECONDS_AS_MS = 1000;
+const unsigned long MINUTES_AS_MS = 60 * SECONDS_AS_MS;
+const unsigned long HOURS_AS_MS = 60 * MINUTES_AS_MS;
+const unsigned long DAYS_AS_MS = 24 * HOURS_AS_MS;
 
 #endif
@@ -0,0 +1,73 @@
+#include "siphash.h"
+
+// Reference: https://www.aumasson.jp/siphash/siphash.pdf
+
+static inline uint64_t rotateLeft(const uint64_t value, const uint8_t bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t readLittleEndian64(const uint8_t *bytes)
+{
+  uint64_t value = 0;
+  for (int8_t i = 7; i >= 0; i--) {
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
+struct SipHashState
+{
+  uint64_t v0;
+  uint64_t v1;
+  uint64_t v2;
+  uint64_t v3;
+
+  void round()
+  {
+    v0 += v1; v1 = rotateLeft(v1, 13); v1 ^= v0; v0 = rotateLeft(v0, 32);
+    v2 += v3; v3 = rotateLeft(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotateLeft(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotateLeft(v1, 17); v1 ^= v2; v2 = rotateLeft(v2, 32);
+  }
+
+  void compress(const uint64_t message)
+  {
+    v3 ^= message;
+    round(); // 2 compression rounds
+    round();
+    v0 ^= message;
+  }
+};
+
+uint64_t siphash24(const uint8_t key[SIPHASH_KEY_SIZE], const uint8_t *data, uint8_t size)
+{
+  const uint64_t k0 = readLittleEndian64(key);
+  const uint64_t k1 = readLittleEndian64(key + 8);
+
+  SipHashState state;
+  state.v0 = k0 ^ 0x736f6d6570736575ULL;
+  state.v1 = k1 ^ 0x646f72616e646f6dULL;
+  state.v2 = k0 ^ 0x6c7967656e657261ULL;
+  state.v3 = k1 ^ 0x7465646279746573ULL;
+
+  const uint8_t fullBlocksSize = size & ~7;
+  for (uint8_t i = 0; i < fullBlocksSize; i += 8) {
+    state.compress(readLittleEndian64(data + i));
+  }
+
+  // Last block: the remaining bytes, padded with zeros, and the size in the most significant byte
+  uint64_t lastBlock = (uint64_t) size << 56;
+  for (uint8_t i = fullBlocksSize; i < size; i++) {
+    lastBlock |= (uint64_t) data[i] << (8 * (i - fullBlocksSize));
+  }
+  state.compress(lastBlock);
+
+  state.v2 ^= 0xff;
+  state.round(); // 4 finalization rounds
+  state.round();
+  state.round();
+  state.round();
+
+  return state.v0 ^ state.v1 ^ state.v2 ^ state.v3;
+}
@@ -0,0 +1,15 @@
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+#include <stdint.h> // Without Arduino.h: also built on computers for benchmarks
+
+const uint8_t SIPHASH_KEY_SIZE = 16;
+
+/**
+ * SipHash-2-4: a keyed hash (MAC) designed for short messages, with a 128-bit key and a 64-bit result.
+ * Without the key, its result cannot be guessed nor forged, even when truncated (to 32 bits for radio frames).
+ * See benchmarks/mac-benchmark for its cost, in CPU cycles, on the boards and on a computer.
+ */
+uint64_t siphash24(const uint8_t key[SIPHASH_KEY_SIZE], const uint8_t *data, uint8_t size);
+
+#endif
@@ -24,34 +24,57 @@ void Buzzer::setup()
 #endif
 }
 
-void Buzzer::loop()
+void Buzzer::loop(const Timestamp now)
 {
-  if (this->melody == nullptr) {
-    return;
-  }
+  const Layer *rendered = renderedLayer();
+  bool renderedChanged = false;
 
-  const unsigned long now = millis();
-  if (now > this->nextNoteChangeTimestamp) {
-    this->currentNoteIndex++;
+  for (uint8_t i = 0; i < OUTPUT_LAYER_COUNT; i++) {
+    Layer *layer = &layers[i];
+    if (layer->melody == nullptr || !isAfter(now, layer->nextNoteChangeTimestamp)) {
+      continue;
+    }
 
-    if (this->currentNoteIndex == this->melody->noteCount) {
-      this->stop();
-      return;
+    layer->currentNoteIndex++;
+    if (layer->currentNoteIndex == layer->melody->noteCount) {
+      layer->melody = nullptr;
+    } else {
+      layer->nextNoteChangeTimestamp = now + layer->melody->frequencyDurationPairs[layer->currentNoteIndex * 2 + 1];
     }
 
-    this->playCurrentNote();
+    if (layer == rendered) {
+      renderedChanged = true; // The notes of hidden layers change silently
+    }
+  }
+
+  if (renderedChanged) {
+    render();
   }
 }
 
+Timestamp Buzzer::nextDeadline() const
+{
+  Timestamp deadline = NO_DEADLINE;
+
+  for (uint8_t i = 0; i < OUTPUT_LAYER_COUNT; i++) {
+    if (layers[i].melody != nullptr) {
+      deadline = earliestDeadline(deadline, deadlineAt(layers[i].nextNoteChangeTimestamp + 1)); // loop() changes note strictly after the timestamp
+    }
+  }
+
+  return deadline;
+}
+
 void Buzzer::play(const BuzzerMelody *melody) {
-  if (muted || this->melody == melody) {
+  Layer *layer = currentLayer();
+  if (muted || layer->melody == melody) {
     return;
   }
 
-  this->melody = melody;
-  this->currentNoteIndex = 0;
-
-  this->playCurrentNote();
+  startMelody(layer, melody);
+  if (renderedLayer() == layer) {
+    render();
+  }
 }
 
 void Buzzer::playSynchronously(const BuzzerMelody *melody) {
@@ -70,14 +93,22 @@ void Buzzer::playSynchronously(const BuzzerMelody *melody) {
 }
 
 void Buzzer::stop() {
-  this->melody = nullptr;
-  playNothing();
+  Layer *layer = currentLayer();
+  const bool wasRendered = (renderedLayer() == layer);
+
+  layer->melody = nullptr;
+  if (wasRendered) {
+    render(); // A lower layer still playing is heard again
+  }
 }
 
 void Buzzer::mute()
 {
   muted = true;
-  stop();
+  for (uint8_t i = 0; i < OUTPUT_LAYER_COUNT; i++) {
+    layers[i].melody = nullptr;
+  }
+  playNothing();
 }
 
 void Buzzer::unmute()
@@ -85,12 +116,37 @@ void Buzzer::unmute()
   muted = false;
 }
 
-void Buzzer::playCurrentNote() {
-  const unsigned int currentNoteFrequency = melody->frequencyDurationPairs[this->currentNoteIndex * 2];
-  const unsigned int currentNoteDuration = melody->frequencyDurationPairs[this->currentNoteIndex * 2 + 1];
+Buzzer::Layer *Buzzer::currentLayer()
+{
+  return &layers[OutputLayer::getCurrent()];
+}
+
+const Buzzer::Layer *Buzzer::renderedLayer() const
+{
+  for (uint8_t i = OUTPUT_LAYER_COUNT; i > 0; i--) {
+    if (layers[i - 1].melody != nullptr) {
+      return &layers[i - 1];
+    }
+  }
+  return nullptr;
+}
+
+void Buzzer::startMelody(Layer *layer, const BuzzerMelody *melody)
+{
+  layer->melody = melody;
+  layer->currentNoteIndex = 0;
+  layer->nextNoteChangeTimestamp = millis() + melody->frequencyDurationPairs[1];
+}
+
+void Buzzer::render()
+{
+  const Layer *layer = renderedLayer();
+  if (layer == nullptr) {
+    playNothing();
+    return;
+  }
 
-  this->nextNoteChangeTimestamp = millis() + currentNoteDuration;
-  playNote(currentNoteFrequency);
+  playNote(layer->melody->frequencyDurationPairs[layer->currentNoteIndex * 2]);
 }
 
 void Buzzer::playAllNotes() {
@@ -2,6 +2,8 @@
 #define LED_H
 
 #include "led-pattern.h"
+#include "output-layer.h"
+#include "../time/deadline.h"
 
 class Led {
   private:
@@ -10,20 +12,36 @@ class Led {
      */
     const uint8_t pin;
 
-    bool lit;
+    struct Layer {
+      bool active; // Always true for the base layer
+      bool lit;
 
-    const LedPattern *pattern;
-    uint8_t currentPatternIndex; // Irrelevant when pattern is nullptr
-    unsigned long nextPatternToggleTimestamp; // Irrelevant when pattern is nullptr
+      const LedPattern *pattern;
+      uint8_t currentPatternIndex; // Irrelevant when pattern is nullptr
+      Timestamp nextPatternToggleTimestamp; // Irrelevant when pattern is nullptr
+    };
+
+    Layer layers[OUTPUT_LAYER_COUNT];
+
+    Layer *currentLayer();
+    const Layer *renderedLayer() const;
+    void render();
 
   public:
     Led(uint8_t pin);
     void setup();
-    void loop();
+    void loop(const Timestamp now);
+    Timestamp nextDeadline() const;
     void set(bool lit);
     void turnOn();
     void turnOff();
     void blink(const LedPattern *pattern);
+
+    /**
+     * Turn off the LED in the base layer, or let the lower layers show through in any other layer.
+     */
+    void release();
+
     bool isLit();
 };
 
@@ -0,0 +1,3 @@
+#include "output-layer.h"
+
+uint8_t OutputLayer::current = BASE_OUTPUT_LAYER;
@@ -12,13 +12,20 @@ class RedundantSensor {
       ANOMALY
     };
 
+    static const unsigned long DEFAULT_ANOMALY_DELAY_MS = 1000;
+
+    /**
+     * anomalyDelayMs: how long the sensors can disagree before it is an anomaly (e.g. the sensors of a moving door do not switch at the same time)
+     */
     RedundantSensor(
       uint8_t pin1,
       uint8_t pin2,
-      ButtonResistor resistor
+      ButtonResistor resistor,
+      unsigned long anomalyDelayMs = DEFAULT_ANOMALY_DELAY_MS
     )
       : sensor1(pin1, resistor)
       , sensor2(pin2, resistor)
+      , anomalyDelayMs(anomalyDelayMs)
     {
       sensor1.setOnChange(&RedundantSensor::onSensorChangeProxy);
       sensor2.setOnChange(&RedundantSensor::onSensorChangeProxy);
@@ -39,21 +46,32 @@ class RedundantSensor {
       onChangeCallback = callback;
     }
 
-    void loop()
+    void loop(const Timestamp now)
     {
       callbackThis = this;
-      sensor1.loop();
+      sensor1.loop(now);
 
       callbackThis = this; // In case loop() triggered external code calling loop() on another RedundantSensor
-      sensor2.loop();
+      sensor2.loop(now);
 
-      if (nextAnomalyTimeMs != 0 && millis() >= nextAnomalyTimeMs) {
+      if (anomalyScheduled && !isBefore(now, nextAnomalyTimeMs)) {
         if (!anomaly) {
           anomaly = true;
           callChangeCallback();
         }
-        nextAnomalyTimeMs = 0;
+        anomalyScheduled = false;
+      }
+    }
+
+    Timestamp nextDeadline() const
+    {
+      Timestamp deadline = earliestDeadline(sensor1.nextDeadline(), sensor2.nextDeadline());
+
+      if (anomalyScheduled) {
+        deadline = earliestDeadline(deadline, deadlineAt(nextAnomalyTimeMs));
       }
+
+      return deadline;
     }
 
     State getState()
@@ -80,12 +98,14 @@ class RedundantSensor {
   private:
     Button sensor1;
     Button sensor2;
+    const unsigned long anomalyDelayMs;
 
     bool pressed1;
     bool pressed2;
 
     bool anomaly;
-    unsigned long nextAnomalyTimeMs;
+    bool anomalyScheduled = false;
+    Timestamp nextAnomalyTimeMs; // Irrelevant when anomalyScheduled is false
 
     void (*onChangeCallback)(State) = nullptr;
 
@@ -97,11 +117,8 @@ class RedundantSensor {
       pressed2 = sensor2.isPressed();
 
       if (!anomaly) {
-        if (pressed1 != pressed2) {
-          nextAnomalyTimeMs = millis() + 1000;
-        } else {
-          nextAnomalyTimeMs = 0;
-        }
+        anomalyScheduled = (pressed1 != pressed2);
+        nextAnomalyTimeMs = millis() + anomalyDelayMs;
 
         callChangeCallback();
       }
@@ -8,9 +8,9 @@ Timer::Timer(unsigned long duration, void (*runTask)())
 {
 }
 
-void Timer::loop()
+void Timer::loop(const Timestamp now)
 {
-  if (!started || millis() < runAtTimestamp) {
+  if (!started || isBefore(now, runAtTimestamp)) {
     return;
   }
 
@@ -23,6 +23,11 @@ void Timer::loop()
   runTask();
 }
 
+Timestamp Timer::nextDeadline() const
+{
+  return started ? deadlineAt(runAtTimestamp) : NO_DEADLINE;
+}
+
 void Timer::startOnce()
 {
   start(false);
@@ -4,9 +4,87 @@
 #include <SPI.h>
 #include <NRFLite.h>
 
+#include "input-bank.h"
+#include "../crypto/siphash.h"
+#include "../time/deadline.h"
+
+/**
+ * Counters of the reception work, to measure the SPI traffic spent to poll the radio.
+ */
+struct WirelessCounters
+{
+  unsigned long irqCount = 0; // Times the IRQ line was found asserted (only with an IRQ pin)
+  unsigned long readCount = 0; // Payloads read from the radio
+  unsigned long emptyPollCount = 0; // Times the radio was asked for data over SPI, but had none
+  unsigned long ackPayloadCount = 0; // Payloads received in the ACK of a sent payload
+  unsigned long ackPayloadMissCount = 0; // Sent payloads not acknowledged, or acknowledged without payload
+  unsigned long rejectedFrameCount = 0; // Received frames too short or with a wrong CRC (not passed to callbacks)
+  unsigned long duplicateFrameCount = 0; // Received frames with the same sequence number as the previous one, e.g. when an ACK was lost (not passed to callbacks)
+  unsigned long outOfOrderFrameCount = 0; // Received frames with a sequence number older than the previous one, e.g. after the other board restarted (still passed to callbacks)
+  unsigned long unauthenticatedFrameCount = 0; // Received frames with a wrong authentication tag: wrong key, or forged (not passed to callbacks)
+  unsigned long replayedFrameCount = 0; // Received frames with an authentication counter already received: replayed (not passed to callbacks)
+  unsigned long radioLockupCount = 0; // Times the radio was found locked up, and re-initialized (see Wireless::loop())
+  unsigned long radioInitFailureCount = 0; // Initializations of the radio that failed, each retried after a longer delay
+};
+
+const uint8_t LINK_GAP_HISTOGRAM_SIZE = 8;
+extern const uint16_t LINK_GAP_HISTOGRAM_UPPER_BOUNDS_MS[LINK_GAP_HISTOGRAM_SIZE - 1]; // In PROGMEM. The last bucket has no upper bound
+
+const uint8_t LINK_LOSS_WINDOW_SIZE = 32; // Frames
+
+/**
+ * Statistics of the link with the other radio, to place antennas and tune polling delays.
+ */
+struct WirelessLinkQuality
+{
+  unsigned long sentFrameCount = 0; // Including the preloaded ACK payload, until it is replaced before being sent
+  unsigned long receivedFrameCount = 0; // Accepted frames only
+  unsigned long lostFrameCount = 0; // Estimated from the gaps in the sequence numbers of received frames
+  unsigned long maxGapMs = 0; // Longest time between two received frames
+  unsigned int gapHistogram[LINK_GAP_HISTOGRAM_SIZE] = {}; // Times between two received frames, by LINK_GAP_HISTOGRAM_UPPER_BOUNDS_MS
+  Timestamp lastReceptionTimestamp = 0; // Since setup() or resetLinkQuality(), when receivedFrameCount is 0
+
+  uint32_t receptionWindow = 0; // One bit per expected frame, set if received: the latest one in the least significant bit
+  uint8_t receptionWindowSize = 0; // Up to LINK_LOSS_WINDOW_SIZE
+};
+
+/**
+ * Stored in EEPROM by Wireless when authentication is enabled.
+ */
+struct WirelessAuthenticationEeprom
+{
+  uint8_t key[SIPHASH_KEY_SIZE]; // The same in both boards
+  uint32_t sentCounterReservation; // Sent counters are below it: reserved by blocks, to not write EEPROM at each frame
+  uint32_t receivedCounterFloor; // Received counters up to it are replays, even after a restart
+};
+
 class Wireless {
   public:
-    Wireless(const uint8_t cePin, const uint8_t csnPin);
+    /**
+     * Use as irqPin to poll the radio over SPI at each call to receive().
+     */
+    static const uint8_t NO_IRQ_PIN = 0xFF;
+
+    /**
+     * Use as powerPin when the power of the radio cannot be switched: it is only re-initialized over SPI when locked up.
+     */
+    static const uint8_t NO_POWER_PIN = 0xFF;
+
+    /**
+     * Each payload is sent in a frame ending with a sequence number and a CRC-8 of the payload and sequence number.
+     * With authentication, the payload is first followed by a counter and a tag.
+     */
+    static const uint8_t FRAME_OVERHEAD = 2;
+    static const uint8_t AUTHENTICATION_OVERHEAD = 8;
+    static const uint8_t MAX_PAYLOAD_SIZE = 32 - AUTHENTICATION_OVERHEAD - FRAME_OVERHEAD;
+
+    /**
+     * With an irqPin wired to the IRQ pin of the radio (any digital pin: it uses pin change interrupts),
+     * receive() only talks to the radio over SPI when the radio signals received data, and the microcontroller can sleep until then.
+     * With a powerPin switching the power of the radio (HIGH powering it, e.g. through a transistor), a locked-up radio is power-cycled before being re-initialized,
+     * which also recovers the lockups that only a hard reset clears.
+     */
+    Wireless(const uint8_t cePin, const uint8_t csnPin, const uint8_t irqPin = NO_IRQ_PIN, const uint8_t powerPin = NO_POWER_PIN);
 
     void setup(
       const uint8_t radioId,
@@ -14,30 +92,175 @@ class Wireless {
 
       const uint8_t channel = 100 // Sending&receiving channel, can fill 0~128, send and receive must be consistent
     );
+    /**
+     * Authenticate all frames, sent and received, with the key stored in EEPROM (see WirelessAuthenticationEeprom), so nobody else can send commands:
+     * the payload is followed by a counter, always increasing, against replays, and by a tag: 32 bits of the SipHash-2-4 of the payload and counter,
+     * and of the radio ID of the sender (not sent), so that a frame recorded from a board cannot be replayed to that same board.
+     * Both boards must enable it, with the same key.
+     */
+    void enableAuthentication(const int eepromAddress);
+
+    /**
+     * Store a new key for enableAuthentication(), to do once on both boards, and restart its counters.
+     */
+    static void provisionAuthenticationKey(const int eepromAddress, const uint8_t key[SIPHASH_KEY_SIZE]);
+
     void enableReceptionTimeout(unsigned long receptionTimeout, void (*receptionTimeoutCallback)(bool));
+
+    /**
+     * Like enableReceptionTimeout(), but time out as soon as a few frames were missed at the pace of the recent receptions,
+     * allowing the other board to double its delay between two frames (as the polling of the dashboard backs off):
+     * a disconnection is reported within a few polling delays instead of after the worst-case delay of a restart of the other board.
+     * The pace follows a slower one right away but a faster one only slowly, so a lossy link keeps a longer timeout.
+     * The timeout is receptionTimeout until enough frames were received, then stays between minReceptionTimeout and maxReceptionTimeout.
+     */
+    void enableAdaptiveReceptionTimeout(unsigned long receptionTimeout, unsigned long minReceptionTimeout, unsigned long maxReceptionTimeout, void (*receptionTimeoutCallback)(bool));
+
+    /**
+     * Change the timeout of an enabled reception timeout (the one until the pace is known if adaptive), e.g. when the other radio is expected to send less often.
+     * It is counted from the last reception, as if the new timeout had always been used.
+     */
+    void setReceptionTimeout(unsigned long receptionTimeout);
+
+    /**
+     * The reception timeout currently applied after the last reception.
+     */
+    unsigned long getReceptionTimeout() const;
+
+    /**
+     * Do not time out during this duration from now, whatever the reception timeout:
+     * to call when receptions are known to stop for a while, e.g. while the radio is restarted.
+     */
+    void graceReceptionTimeout(unsigned long duration);
+
     bool inReceptionTimeout();
 
-    void loop();
+    /**
+     * True while the radio is locked up or failed to initialize: it is re-initialized in loop(), with a growing delay between attempts,
+     * and meanwhile nothing is sent nor received.
+     */
+    bool inRadioRecovery() const;
+
+    /**
+     * Besides the reception timeout, check the radio regularly, and recover it when locked up:
+     * when a register does not read back as configured, when sent payloads are not transmitted anymore, or after a prolonged silence.
+     */
+    void loop(const Timestamp now);
+    Timestamp nextDeadline() const;
 
     bool send(byte *payload, uint8_t size);
     bool receive(void (*receiveCallback)(byte *payload, uint8_t size));
 
+    /**
+     * Send a payload requiring an ACK, and pass the payload of the ACK, if any, to the callback: a request and its reply in a single exchange.
+     * The other radio must have preloaded its reply with setAckPayload().
+     * Returns true if an ACK payload was received.
+     */
+    bool sendForAckPayload(byte *payload, uint8_t size, void (*ackPayloadCallback)(byte *payload, uint8_t size));
+
+    /**
+     * False after several consecutive exchanges without ACK payload, until a retry delay elapsed:
+     * the other radio may not preload replies (e.g. older firmware), or the ACKs may start to lock the radio up (see send()).
+     * Meanwhile, use send() and receive() for requests and replies.
+     */
+    bool canSendForAckPayload();
+
+    /**
+     * Preload the payload to send back in the ACK of the next payload received from a sendForAckPayload(), replacing any previous one.
+     * A send() removes it if it was not sent yet, so the other radio never receives it after newer frames: preload it again after.
+     */
+    void setAckPayload(byte *payload, uint8_t size);
+
+    const WirelessCounters *getCounters() const;
+
+    const WirelessLinkQuality *getLinkQuality() const;
+    uint8_t getLossRatePercent() const; // Over the last LINK_LOSS_WINDOW_SIZE frames sent by the other radio
+    unsigned long timeSinceLastReception() const;
+    void resetLinkQuality();
+
+    /**
+     * Print the link quality and the counters to Serial, in a human-readable way.
+     */
+    void printLinkQuality() const;
+
   private:
     const uint8_t cePin;
     const uint8_t csnPin;
+    const uint8_t irqPin;
+    BankedInput irqInput; // Irrelevant when irqPin is NO_IRQ_PIN
+    const uint8_t powerPin;
+
+    WirelessCounters counters;
+    WirelessLinkQuality linkQuality;
+
+    uint8_t nextSentSequence = 0;
+    uint8_t lastReceivedSequence; // Irrelevant when hasReceivedSequence is false
+    bool hasReceivedSequence = false;
+
+    bool isAuthenticated = false;
+    int authenticationEepromAddress; // Irrelevant when isAuthenticated is false
+    uint8_t authenticationKey[SIPHASH_KEY_SIZE]; // Irrelevant when isAuthenticated is false
+    uint32_t lastSentCounter; // Irrelevant when isAuthenticated is false
+    uint32_t sentCounterReservation; // Irrelevant when isAuthenticated is false
+    uint32_t lastReceivedCounter; // Irrelevant when isAuthenticated is false
+    uint32_t receivedCounterFloor; // Irrelevant when isAuthenticated is false
+
+    bool hasPendingAckPayload = false; // Preloaded by setAckPayload(), and not known to be sent yet (see reclaimUnsentAckPayload())
+
+    uint8_t consecutiveAckPayloadMisses = 0;
+    Timestamp ackPayloadFallbackTimestamp; // Irrelevant while consecutiveAckPayloadMisses is under the maximum
 
     NRFLite _radio;
 
+    uint8_t _radioId;
     uint8_t _destinationRadioId;
+    uint8_t _channel;
+
+    bool isInRadioRecovery = false;
+    bool isRadioPoweredOff = false; // Only with a powerPin, during a recovery
+    uint8_t consecutiveSendFailures = 0;
+    Timestamp nextRadioCheckTimestamp; // Irrelevant during a recovery
+    Timestamp radioRecoveryStepTimestamp; // When to power the radio on, or to initialize it. Irrelevant when isInRadioRecovery is false
+    Timestamp lastRadioInitTimestamp;
+    unsigned long radioRecoveryDelay; // Between two initializations: doubles while they do not bring receptions back
 
-    unsigned long receptionTimeout;
-    unsigned long nextReceptionTimeoutTimestamp; // Irrelevant when receptionTimeout is 0
+    unsigned long receptionTimeout; // Until the pace of receptions is known when adaptive
+    unsigned long minReceptionTimeout = 0; // 0 when the reception timeout is not adaptive
+    unsigned long maxReceptionTimeout; // Irrelevant when minReceptionTimeout is 0
+    Timestamp lastReceptionTimestamp; // Or when the reception timeout was enabled. Irrelevant when receptionTimeout is 0
     void (*receptionTimeoutCallback)(bool); // Irrelevant when receptionTimeout is 0
     bool isInReceptionTimeout;
 
+    bool hasReceptionGrace = false;
+    Timestamp receptionGraceEndTimestamp; // Irrelevant when hasReceptionGrace is false
+
+    uint16_t slowestRecentGapMs = 0; // Between two receptions, for the adaptive reception timeout: decays slowly towards the current pace
+    uint8_t recentGapCount = 0; // Up to ADAPTIVE_RECEPTION_TIMEOUT_MIN_GAPS
+
     void (*errorHandler)();
 
+    uint8_t makeFrame(byte *frame, const byte *payload, uint8_t size);
+    uint8_t acceptFrame(const byte *frame, uint8_t frameSize); // Returns the size of its payload, or 0 if the frame must be ignored
+    void reclaimUnsentAckPayload();
+    void recordReception(const uint8_t sequence);
+    uint8_t authenticate(byte *frame, uint8_t payloadSize);
+    bool isAuthentic(const byte *frame, uint8_t payloadSize);
+    bool isReplayed(const byte *frame, uint8_t payloadSize);
+    void acceptCounter(const byte *frame, uint8_t payloadSize);
+
+    bool initRadio(const Timestamp now);
+    void loopRadioRecovery(const Timestamp now);
+    bool isRadioLockedUp(const Timestamp now);
+    void startRadioRecovery(const Timestamp now);
+    uint8_t readRadioRegister(const uint8_t reg);
+    void sendRadioCommand(const uint8_t command);
+    bool hasPowerPin() const;
+
     void resetReceptionTimeout();
+    bool isReceptionTimeoutEnabled() const;
+    Timestamp receptionTimeoutTimestamp() const;
+    bool hasIrqPin() const;
+    bool isIrqAsserted() const;
 };
 
 #endif
@@ -0,0 +1,35 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include "timestamp.h"
+
+/**
+ * Returned by nextDeadline() functions when a component has nothing to do by itself:
+ * only an external event (pin change, received message, call from another component...) can give it some work.
+ */
+const Timestamp NO_DEADLINE = 0xFFFFFFFF;
+
+/**
+ * Turn a timestamp into a deadline to return from a nextDeadline() function.
+ * Once every 49.71 days, millis() goes through the value of NO_DEADLINE: such a deadline is moved 1 ms earlier to not be lost.
+ */
+inline Timestamp deadlineAt(const Timestamp timestamp)
+{
+  return timestamp == NO_DEADLINE ? timestamp - 1 : timestamp;
+}
+
+/**
+ * Return the earliest of two deadlines (as returned by deadlineAt(), or NO_DEADLINE).
+ */
+inline Timestamp earliestDeadline(const Timestamp deadline1, const Timestamp deadline2)
+{
+  if (deadline1 == NO_DEADLINE) {
+    return deadline2;
+  }
+  if (deadline2 == NO_DEADLINE) {
+    return deadline1;
+  }
+  return isBefore(deadline1, deadline2) ? deadline1 : deadline2;
+}
+
+#endif
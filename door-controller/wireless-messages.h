@@ -1,7 +1,15 @@
 #ifndef WIRELESS_MESSAGES_H
 #define WIRELESS_MESSAGES_H
 
-// Bytes have both 1s and 0s to make sure noise don't send false signals
+#include <Arduino.h>
+#include <stddef.h>
+
+#include "src/libs/hardware/wireless.h"
+
+// The same file is in both the controller and dashboard sketches: keep them identical, and increase the version at each change of the messages or of their frames (see Wireless)
+const uint8_t PROTOCOL_VERSION                    = 4; // 0~63 (6 bits)
+
+// Bytes have both 1s and 0s to make sure noise don't send false signals (on top of the CRC of each frame, see Wireless)
 
 // Common to controller and dashboard
 const byte MESSAGE_HEADER                         = 0b11100111;
@@ -16,10 +24,92 @@ const byte MESSAGE_STATE_CLOSING                  = 0b10010110;
 const byte MESSAGE_STATE_CLOSING_FAILED           = 0b11010001;
 
 // Sent by dashboard
-const byte MESSAGE_POLLING                        = 0; // Requesting the controller to reply with its status
+const uint8_t MESSAGE_MAX_BUTTON_PRESSES          = 4; // Pending presses sent together, after the ID of the first one (the others have the next IDs)
 const byte MESSAGE_PRESSED_BUTTON_KEEP_OPEN       = 0b10110110;
 const byte MESSAGE_PRESSED_BUTTON_CLOSE           = 0b11001100;
 const byte MESSAGE_PRESSED_BUTTON_ACK_AUTO_CLOSED = 0b00110011;
 const byte MESSAGE_PRESSED_COMBO_TOGGLE_DEMO_MODE = 0b01100011;
 
+// Messages are sent and received as is: both boards are built by the same compiler, so they agree on the layout of bit-fields
+
+/**
+ * Sent by the dashboard to poll the controller, with its pending button presses, if any.
+ * When polling without button press, only the fields before firstEventId are sent.
+ */
+struct __attribute__((packed)) DashboardMessage
+{
+  byte header; // MESSAGE_HEADER
+  uint8_t replyInAck : 1; // Requesting the controller to reply in the ACK of the next message, instead of with a separate message
+  uint8_t protocolVersion : 6; // PROTOCOL_VERSION
+  uint8_t unused : 1;
+  byte firstEventId; // Never 0
+  byte buttonIndexes[MESSAGE_MAX_BUTTON_PRESSES]; // MESSAGE_PRESSED_* values: only the pending ones are sent
+};
+
+/**
+ * Sent by the controller, as a reply to each DashboardMessage.
+ */
+struct __attribute__((packed)) DoorStatusMessage
+{
+  byte header; // MESSAGE_HEADER
+  byte state; // One of the MESSAGE_STATE_* values
+  uint8_t isAutoClosed : 1;
+  uint8_t protocolVersion : 6; // PROTOCOL_VERSION
+  uint8_t isDemoMode : 1;
+  byte ackedButtonPressEventId; // Acknowledging the button press with this ID and the previous ones (0 if none yet)
+};
+
+static_assert(sizeof(DashboardMessage) == 3 + MESSAGE_MAX_BUTTON_PRESSES, "Unexpected padding in DashboardMessage");
+static_assert(sizeof(DashboardMessage) <= Wireless::MAX_PAYLOAD_SIZE, "DashboardMessage does not fit in a radio payload");
+static_assert(sizeof(DoorStatusMessage) == 4, "Unexpected padding in DoorStatusMessage");
+static_assert(sizeof(DoorStatusMessage) <= Wireless::MAX_PAYLOAD_SIZE, "DoorStatusMessage does not fit in a radio payload");
+
+inline uint8_t dashboardMessageSize(uint8_t buttonPressCount)
+{
+  return buttonPressCount == 0
+    ? offsetof(DashboardMessage, firstEventId)
+    : offsetof(DashboardMessage, buttonIndexes) + buttonPressCount;
+}
+
+/**
+ * Returns the message stored in data (without copying it), or nullptr if data is not a valid DashboardMessage.
+ */
+inline const DashboardMessage *decodeDashboardMessage(const byte *data, uint8_t size, uint8_t *buttonPressCount)
+{
+  const DashboardMessage *message = (const DashboardMessage *) data;
+
+  if (size < dashboardMessageSize(0) ||
+      size == offsetof(DashboardMessage, buttonIndexes) || // Event ID without button press
+      size > sizeof(DashboardMessage) ||
+      message->header != MESSAGE_HEADER ||
+      message->protocolVersion != PROTOCOL_VERSION
+  ) {
+    return nullptr;
+  }
+
+  *buttonPressCount = (size == dashboardMessageSize(0) ? 0 : size - offsetof(DashboardMessage, buttonIndexes));
+  if (*buttonPressCount > 0 && message->firstEventId == 0) {
+    return nullptr;
+  }
+
+  return message;
+}
+
+/**
+ * Returns the message stored in data (without copying it), or nullptr if data is not a valid DoorStatusMessage.
+ */
+inline const DoorStatusMessage *decodeDoorStatusMessage(const byte *data, uint8_t size)
+{
+  const DoorStatusMessage *message = (const DoorStatusMessage *) data;
+
+  if (size != sizeof(DoorStatusMessage) ||
+      message->header != MESSAGE_HEADER ||
+      message->protocolVersion != PROTOCOL_VERSION
+  ) {
+    return nullptr;
+  }
+
+  return message;
+}
+
 #endif
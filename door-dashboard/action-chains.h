@@ -21,75 +21,107 @@ const unsigned long KEPT_OPEN_FOR_TOO_LONG_DURATION_MS = 1 * HOURS_AS_MS;
 const unsigned long KEPT_OPEN_FOR_TOO_LONG_DURATION_MS_DEMO = 10 * SECONDS_AS_MS;
 
 ActionOrchestrator actionOrchestrator = ActionOrchestrator();
+ActionOrchestrator feedbackActionOrchestrator = ActionOrchestrator(OVERLAY_OUTPUT_LAYER);
 
 // Actions in a chain are run one at a time.
-// Only one action-chain is active at a given time: there is only one ActionOrchestrator.
+// Two action-chains can be active at a given time: one for the current state,
+// and one for combo feedback, shown over the former (on a higher output layer) without interrupting it.
 // When a chain is replaced by another one, previously started actions are all cancelled: turn off LEDs, buzzer...
+// Actions are static objects (never allocated with `new`) and chains are stored in flash memory (PROGMEM), to save SRAM.
 
-const Action *WAITING_FIRST_SIGNAL_ACTION_CHAIN[] = {
+const Action *const WAITING_FIRST_SIGNAL_ACTION_CHAIN[] PROGMEM = {
 };
 const uint8_t WAITING_FIRST_SIGNAL_ACTION_CHAIN_SIZE = sizeof(WAITING_FIRST_SIGNAL_ACTION_CHAIN) / sizeof(Action*);
 
-const Action *DISCONNECTED_ACTION_CHAIN[] = {
-  new StartBlinkingLedAction(&disconnectedLed, &DISCONNECTED_LED_PATTERN)
-  // new StartPlayingMelodyAction(&buzzer, &DISCONNECTED_MELODY)
+const StartBlinkingLedAction BLINK_DISCONNECTED_LED_ACTION = StartBlinkingLedAction(&disconnectedLed, &DISCONNECTED_LED_PATTERN);
+// const StartPlayingMelodyAction PLAY_DISCONNECTED_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &DISCONNECTED_MELODY);
+
+const Action *const DISCONNECTED_ACTION_CHAIN[] PROGMEM = {
+  &BLINK_DISCONNECTED_LED_ACTION
+  // &PLAY_DISCONNECTED_MELODY_ACTION
 };
 const uint8_t DISCONNECTED_ACTION_CHAIN_SIZE = sizeof(DISCONNECTED_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* DOOR_SENSOR_ANOMALY_ACTION_CHAIN[] = {
-  new StartAlternateBlinkingLedsAction(&openLed, &closingLed, 300),
-  new StartPlayingMelodyAction(&buzzer, &DOOR_SENSOR_ANOMALY_MELODY, true)
+const StartAlternateBlinkingLedsAction ALTERNATE_BLINKING_OPEN_AND_CLOSING_LEDS_ACTION = StartAlternateBlinkingLedsAction(&openLed, &closingLed, 300);
+const StartPlayingMelodyAction PLAY_DOOR_SENSOR_ANOMALY_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &DOOR_SENSOR_ANOMALY_MELODY, true);
+
+const Action *const DOOR_SENSOR_ANOMALY_ACTION_CHAIN[] PROGMEM = {
+  &ALTERNATE_BLINKING_OPEN_AND_CLOSING_LEDS_ACTION,
+  &PLAY_DOOR_SENSOR_ANOMALY_MELODY_ACTION
 };
 const uint8_t DOOR_SENSOR_ANOMALY_ACTION_CHAIN_SIZE = sizeof(DOOR_SENSOR_ANOMALY_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* CLOSED_ACTION_CHAIN[] = {
-  new StartPlayingMelodyAction(&buzzer, &CLOSED_MELODY, true)
+const StartPlayingMelodyAction PLAY_CLOSED_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &CLOSED_MELODY, true);
+
+const Action *const CLOSED_ACTION_CHAIN[] PROGMEM = {
+  &PLAY_CLOSED_MELODY_ACTION
 };
 const uint8_t CLOSED_ACTION_CHAIN_SIZE = sizeof(CLOSED_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* OPEN_ACTION_CHAIN[] = {
-  new TurnOnLedAction(&openLed),
-  new StartPlayingMelodyAction(&buzzer, &OPEN_MELODY, true),
-  new DemoModeAwareWaitAction(
-    OPEN_REMINDER_DELAY_MS,
-    OPEN_REMINDER_DELAY_MS_DEMO),
-  new StartBlinkingLedAction(&openLed, &OPEN_FOR_TOO_LONG_LED_PATTERN),
-  new StartPlayingMelodyAction(&buzzer, &OPEN_FOR_TOO_LONG_MELODY)
+const TurnOnLedAction TURN_ON_OPEN_LED_ACTION = TurnOnLedAction(&openLed);
+const StartPlayingMelodyAction PLAY_OPEN_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &OPEN_MELODY, true);
+const DemoModeAwareWaitAction OPEN_REMINDER_WAIT_ACTION = DemoModeAwareWaitAction(
+  OPEN_REMINDER_DELAY_MS,
+  OPEN_REMINDER_DELAY_MS_DEMO);
+const StartBlinkingLedAction BLINK_OPEN_FOR_TOO_LONG_LED_ACTION = StartBlinkingLedAction(&openLed, &OPEN_FOR_TOO_LONG_LED_PATTERN);
+const StartPlayingMelodyAction PLAY_OPEN_FOR_TOO_LONG_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &OPEN_FOR_TOO_LONG_MELODY);
+
+const Action *const OPEN_ACTION_CHAIN[] PROGMEM = {
+  &TURN_ON_OPEN_LED_ACTION,
+  &PLAY_OPEN_MELODY_ACTION,
+  &OPEN_REMINDER_WAIT_ACTION,
+  &BLINK_OPEN_FOR_TOO_LONG_LED_ACTION,
+  &PLAY_OPEN_FOR_TOO_LONG_MELODY_ACTION
 };
 const uint8_t OPEN_ACTION_CHAIN_SIZE = sizeof(OPEN_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* WILL_CLOSE_SOON_ACTION_CHAIN[] = {
-  new StartBlinkingLedAction(&openLed, &WILL_AUTO_CLOSE_SOON_LED_PATTERN),
-  new StartPlayingMelodyAction(&buzzer, &OPEN_FOR_TOO_LONG_MELODY, true)
+const StartBlinkingLedAction BLINK_WILL_AUTO_CLOSE_SOON_LED_ACTION = StartBlinkingLedAction(&openLed, &WILL_AUTO_CLOSE_SOON_LED_PATTERN);
+const StartPlayingMelodyAction PLAY_WILL_CLOSE_SOON_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &OPEN_FOR_TOO_LONG_MELODY, true);
+
+const Action *const WILL_CLOSE_SOON_ACTION_CHAIN[] PROGMEM = {
+  &BLINK_WILL_AUTO_CLOSE_SOON_LED_ACTION,
+  &PLAY_WILL_CLOSE_SOON_MELODY_ACTION
 };
 const uint8_t WILL_CLOSE_SOON_ACTION_CHAIN_SIZE = sizeof(WILL_CLOSE_SOON_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* CLOSING_ACTION_CHAIN[] = {
-  new TurnOnLedAction(&closingLed),
-  new StartPlayingMelodyAction(&buzzer, &CLOSING_MELODY, true)
+const TurnOnLedAction TURN_ON_CLOSING_LED_ACTION = TurnOnLedAction(&closingLed);
+const StartPlayingMelodyAction PLAY_CLOSING_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &CLOSING_MELODY, true);
+
+const Action *const CLOSING_ACTION_CHAIN[] PROGMEM = {
+  &TURN_ON_CLOSING_LED_ACTION,
+  &PLAY_CLOSING_MELODY_ACTION
 };
 const uint8_t CLOSING_ACTION_CHAIN_SIZE = sizeof(CLOSING_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* CLOSING_FAILED_ACTION_CHAIN[] = {
-  new StartBlinkingLedAction(&closingLed, &CLOSING_FAILED_LED_PATTERN),
-  new StartPlayingMelodyAction(&buzzer, &CLOSING_FAILED_MELODY, true)
+const StartBlinkingLedAction BLINK_CLOSING_FAILED_LED_ACTION = StartBlinkingLedAction(&closingLed, &CLOSING_FAILED_LED_PATTERN);
+const StartPlayingMelodyAction PLAY_CLOSING_FAILED_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &CLOSING_FAILED_MELODY, true);
+
+const Action *const CLOSING_FAILED_ACTION_CHAIN[] PROGMEM = {
+  &BLINK_CLOSING_FAILED_LED_ACTION,
+  &PLAY_CLOSING_FAILED_MELODY_ACTION
 };
 const uint8_t CLOSING_FAILED_ACTION_CHAIN_SIZE = sizeof(CLOSING_FAILED_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* KEPT_OPEN_ACTION_CHAIN[] = {
-  new StartPlayingMelodyAction(&buzzer, &KEPT_OPEN_MELODY, true),
+const StartPlayingMelodyAction PLAY_KEPT_OPEN_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &KEPT_OPEN_MELODY, true);
+const TurnOnLedAction TURN_ON_KEPT_OPEN_LED_ACTION = TurnOnLedAction(&keptOpenLed);
+const DemoModeAwareWaitAction KEPT_OPEN_FOR_TOO_LONG_WAIT_ACTION = DemoModeAwareWaitAction(
+  KEPT_OPEN_FOR_TOO_LONG_DURATION_MS,
+  KEPT_OPEN_FOR_TOO_LONG_DURATION_MS_DEMO);
+const StartBlinkingLedAction BLINK_KEPT_OPEN_FOR_TOO_LONG_LED_ACTION = StartBlinkingLedAction(&keptOpenLed, &KEPT_OPEN_FOR_TOO_LONG_LED_PATTERN);
+const WaitAction KEPT_OPEN_FOR_TOO_LONG_LED_PATTERN_WAIT_ACTION = WaitAction(KEPT_OPEN_FOR_TOO_LONG_LED_PATTERN.totalDuration());
+
+const Action *const KEPT_OPEN_ACTION_CHAIN[] PROGMEM = {
+  &PLAY_KEPT_OPEN_MELODY_ACTION,
   &LOOP_BEGIN_ACTION,
-  new TurnOnLedAction(&keptOpenLed),
-  new DemoModeAwareWaitAction(
-    KEPT_OPEN_FOR_TOO_LONG_DURATION_MS,
-    KEPT_OPEN_FOR_TOO_LONG_DURATION_MS_DEMO),
-  new StartBlinkingLedAction(&keptOpenLed, &KEPT_OPEN_FOR_TOO_LONG_LED_PATTERN),
-  new WaitAction(KEPT_OPEN_FOR_TOO_LONG_LED_PATTERN.totalDuration()),
+  &TURN_ON_KEPT_OPEN_LED_ACTION,
+  &KEPT_OPEN_FOR_TOO_LONG_WAIT_ACTION,
+  &BLINK_KEPT_OPEN_FOR_TOO_LONG_LED_ACTION,
+  &KEPT_OPEN_FOR_TOO_LONG_LED_PATTERN_WAIT_ACTION,
   &LOOP_END_ACTION
 };
 const uint8_t KEPT_OPEN_ACTION_CHAIN_SIZE = sizeof(KEPT_OPEN_ACTION_CHAIN) / sizeof(Action*);
 
-bool isAnOpenActionChain(const Action **actions) {
+bool isAnOpenActionChain(const Action *const *actions) {
   return
     actions == OPEN_ACTION_CHAIN ||
     actions == WILL_CLOSE_SOON_ACTION_CHAIN ||
@@ -108,39 +140,16 @@ Led *led3 = &closingLed;
 Led *led4 = &autoClosedLed;
 Led *led5 = &disconnectedLed;
 
-TurnOnLedAction *turnOnLed1Action = new TurnOnLedAction(led1);
-TurnOnLedAction *turnOnLed2Action = new TurnOnLedAction(led2);
-TurnOnLedAction *turnOnLed3Action = new TurnOnLedAction(led3);
-TurnOnLedAction *turnOnLed4Action = new TurnOnLedAction(led4);
-TurnOnLedAction *turnOnLed5Action = new TurnOnLedAction(led5);
-
-const Action* VOLUME_FEEDBACK_ACTION_CHAIN[] = {
-  turnOnLed5Action,
-  turnOnLed4Action,
-  turnOnLed3Action,
-  turnOnLed2Action,
-  turnOnLed1Action,
-  new StartPlayingMelodyAction(&buzzer, &VOLUME_FEEDBACK_MELODY),
-  new WaitAction(1 * SECONDS_AS_MS),
-  new RunnableAction(&stopRunningComboFeedback)
-};
-
-const Action** getActionChainForVolumeStep(uint8_t step)
-{
-  return VOLUME_FEEDBACK_ACTION_CHAIN + (5 - step);
-}
-
-uint8_t getActionChainSizeForVolumeStep(uint8_t step)
-{
-  return step + 3;
-}
-
+/**
+ * Set the five LEDs of the dashboard as a strip: 'O' for a lit LED, ' ' for an unlit one (release them at chain's end).
+ */
 class SetLedStripAction : public Action
 {
   private:
     const char *strip;
 
-    void set(const char *strip) const
+  protected:
+    static void set(const char *strip)
     {
       led1->set(strip[0] != ' ');
       led2->set(strip[1] != ' ');
@@ -150,7 +159,7 @@ class SetLedStripAction : public Action
     }
 
   public:
-    SetLedStripAction(const char *strip)
+    constexpr SetLedStripAction(const char *strip)
       : strip(strip)
     {
     }
@@ -162,52 +171,91 @@ class SetLedStripAction : public Action
 
     void destroy() const
     {
-      set("     ");
+      led1->release();
+      led2->release();
+      led3->release();
+      led4->release();
+      led5->release();
     }
 };
 
-SetLedStripAction *turnOnOnlyLed1Action = new SetLedStripAction("O    ");
-SetLedStripAction *turnOnOnlyLed2Action = new SetLedStripAction(" O   ");
-SetLedStripAction *turnOnOnlyLed3Action = new SetLedStripAction("  O  ");
-SetLedStripAction *turnOnOnlyLed4Action = new SetLedStripAction("   O ");
-SetLedStripAction *turnOnOnlyLed5Action = new SetLedStripAction("    O");
+/**
+ * Light as many LEDs as the current volume step (the others are unlit), from the first LED.
+ */
+class ShowVolumeStepAction : public SetLedStripAction
+{
+  private:
+    static const char *const STRIPS[];
+
+  public:
+    constexpr ShowVolumeStepAction()
+      : SetLedStripAction(nullptr)
+    {
+    }
+
+    void start() const
+    {
+      set(STRIPS[buzzerVolumeManager.getStep()]);
+    }
+};
+
+const char *const ShowVolumeStepAction::STRIPS[] = { "     ", "O    ", "OO   ", "OOO  ", "OOOO ", "OOOOO" };
+
+const ShowVolumeStepAction SHOW_VOLUME_STEP_ACTION = ShowVolumeStepAction();
+const StartPlayingMelodyAction PLAY_VOLUME_FEEDBACK_MELODY_ACTION = StartPlayingMelodyAction(&buzzer, &VOLUME_FEEDBACK_MELODY);
+const WaitAction VOLUME_FEEDBACK_WAIT_ACTION = WaitAction(1 * SECONDS_AS_MS);
+const RunnableAction STOP_RUNNING_COMBO_FEEDBACK_ACTION = RunnableAction(&stopRunningComboFeedback);
+
+const Action *const VOLUME_FEEDBACK_ACTION_CHAIN[] PROGMEM = {
+  &SHOW_VOLUME_STEP_ACTION,
+  &PLAY_VOLUME_FEEDBACK_MELODY_ACTION,
+  &VOLUME_FEEDBACK_WAIT_ACTION,
+  &STOP_RUNNING_COMBO_FEEDBACK_ACTION
+};
+const uint8_t VOLUME_FEEDBACK_ACTION_CHAIN_SIZE = sizeof(VOLUME_FEEDBACK_ACTION_CHAIN) / sizeof(Action*);
+
+const SetLedStripAction turnOnOnlyLed1Action = SetLedStripAction("O    ");
+const SetLedStripAction turnOnOnlyLed2Action = SetLedStripAction(" O   ");
+const SetLedStripAction turnOnOnlyLed3Action = SetLedStripAction("  O  ");
+const SetLedStripAction turnOnOnlyLed4Action = SetLedStripAction("   O ");
+const SetLedStripAction turnOnOnlyLed5Action = SetLedStripAction("    O");
 
 const unsigned long DEMO_MODE_ANIMATION_FRAME_DURATION_MS = 400;
 const unsigned long DEMO_MODE_ANIMATION_FRAME_DURATION_MS_DEMO = 75;
-const Action *DEMO_MODE_ANIMATION_FRAME_WAIT = new DemoModeAwareWaitAction(
+const DemoModeAwareWaitAction DEMO_MODE_ANIMATION_FRAME_WAIT = DemoModeAwareWaitAction(
   DEMO_MODE_ANIMATION_FRAME_DURATION_MS,
   DEMO_MODE_ANIMATION_FRAME_DURATION_MS_DEMO);
-const Action* DEMO_MODE_TOGGLE_ACTION_CHAIN[] = {
-  turnOnOnlyLed1Action, DEMO_MODE_ANIMATION_FRAME_WAIT,
-  turnOnOnlyLed2Action, DEMO_MODE_ANIMATION_FRAME_WAIT,
-  turnOnOnlyLed3Action, DEMO_MODE_ANIMATION_FRAME_WAIT,
-  turnOnOnlyLed4Action, DEMO_MODE_ANIMATION_FRAME_WAIT,
-  turnOnOnlyLed5Action, DEMO_MODE_ANIMATION_FRAME_WAIT,
-  new RunnableAction(&stopRunningComboFeedback)
+const Action *const DEMO_MODE_TOGGLE_ACTION_CHAIN[] PROGMEM = {
+  &turnOnOnlyLed1Action, &DEMO_MODE_ANIMATION_FRAME_WAIT,
+  &turnOnOnlyLed2Action, &DEMO_MODE_ANIMATION_FRAME_WAIT,
+  &turnOnOnlyLed3Action, &DEMO_MODE_ANIMATION_FRAME_WAIT,
+  &turnOnOnlyLed4Action, &DEMO_MODE_ANIMATION_FRAME_WAIT,
+  &turnOnOnlyLed5Action, &DEMO_MODE_ANIMATION_FRAME_WAIT,
+  &STOP_RUNNING_COMBO_FEEDBACK_ACTION
 };
 const uint8_t DEMO_MODE_TOGGLE_ACTION_CHAIN_SIZE = sizeof(DEMO_MODE_TOGGLE_ACTION_CHAIN) / sizeof(Action*);
 
-SetLedStripAction *stripLedBigAction = new SetLedStripAction("OOOOO");
-SetLedStripAction *stripLedMediumAction = new SetLedStripAction(" OOO ");
-SetLedStripAction *stripLedSmallAction = turnOnOnlyLed3Action;
-SetLedStripAction *stripLedNoneAction = new SetLedStripAction("     ");
-const Action *MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT = new WaitAction(200);
-
-const Action* MUTE_SOUND_UNTIL_NEXT_CLOSE_ON_ACTION_CHAIN[] = {
-  stripLedBigAction, MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
-  stripLedMediumAction, MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
-  stripLedSmallAction, MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
-  stripLedNoneAction, MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
-  new RunnableAction(&stopRunningComboFeedback)
+const SetLedStripAction stripLedBigAction = SetLedStripAction("OOOOO");
+const SetLedStripAction stripLedMediumAction = SetLedStripAction(" OOO ");
+const SetLedStripAction &stripLedSmallAction = turnOnOnlyLed3Action;
+const SetLedStripAction stripLedNoneAction = SetLedStripAction("     ");
+const WaitAction MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT = WaitAction(200);
+
+const Action *const MUTE_SOUND_UNTIL_NEXT_CLOSE_ON_ACTION_CHAIN[] PROGMEM = {
+  &stripLedBigAction, &MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
+  &stripLedMediumAction, &MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
+  &stripLedSmallAction, &MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
+  &stripLedNoneAction, &MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
+  &STOP_RUNNING_COMBO_FEEDBACK_ACTION
 };
 const uint8_t MUTE_SOUND_UNTIL_NEXT_CLOSE_ON_ACTION_CHAIN_SIZE = sizeof(MUTE_SOUND_UNTIL_NEXT_CLOSE_ON_ACTION_CHAIN) / sizeof(Action*);
 
-const Action* MUTE_SOUND_UNTIL_NEXT_CLOSE_OFF_ACTION_CHAIN[] = {
-  stripLedNoneAction, MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
-  stripLedSmallAction, MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
-  stripLedMediumAction, MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
-  stripLedBigAction, MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
-  new RunnableAction(&stopRunningComboFeedback)
+const Action *const MUTE_SOUND_UNTIL_NEXT_CLOSE_OFF_ACTION_CHAIN[] PROGMEM = {
+  &stripLedNoneAction, &MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
+  &stripLedSmallAction, &MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
+  &stripLedMediumAction, &MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
+  &stripLedBigAction, &MUTE_SOUND_UNTIL_NEXT_CLOSE_WAIT,
+  &STOP_RUNNING_COMBO_FEEDBACK_ACTION
 };
 const uint8_t MUTE_SOUND_UNTIL_NEXT_CLOSE_OFF_ACTION_CHAIN_SIZE = sizeof(MUTE_SOUND_UNTIL_NEXT_CLOSE_OFF_ACTION_CHAIN) / sizeof(Action*);
 
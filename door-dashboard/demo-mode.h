@@ -12,7 +12,7 @@ class DemoModeAwareWaitAction : public WaitAction
     const unsigned long demoWaitDuration;
 
   public:
-    DemoModeAwareWaitAction(
+    constexpr DemoModeAwareWaitAction(
       const unsigned long normalWaitDuration,
       const unsigned long demoWaitDuration
     )
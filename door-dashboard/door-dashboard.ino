@@ -6,44 +6,47 @@
 #include "wireless-messages.h" // Defines messages exchanged by radio
 
 #include "src/libs/constants/duration-units.h"
+#include "src/libs/hardware/idle-sleeper.h"
 #include "src/libs/hardware/remote-buttons-sender.h"
-#include "src/libs/hardware/restarter.h"
 #include "src/libs/hardware/timer.h"
 
+// DISCONNECTION
+SuspendedActionChain actionsBeforeDisconnection;
+void suspendNormalActionDuringDisconnection()
+{
+  actionOrchestrator.suspend(&actionsBeforeDisconnection);
+  changeNormalAction(DISCONNECTED_ACTION_CHAIN, DISCONNECTED_ACTION_CHAIN_SIZE);
+}
+// DISCONNECTION
+
 // COMBOS
 bool muteSoundUntilNextClose = false;
 
-bool isRunningComboFeedback = false;
-const Action **actionsAfterComboFeedback = nullptr;
-uint8_t actionsAfterComboFeedbackSize = 0;
-void startComboAction(const Action **actions, uint8_t size)
+void startComboAction(const Action *const *actions, uint8_t size)
 {
-  isRunningComboFeedback = true;
-  actionOrchestrator.start(actions, size);
+  feedbackActionOrchestrator.start(actions, size);
 }
-void changeNormalAction(const Action **actions, uint8_t size)
+void changeNormalAction(const Action *const *actions, uint8_t size)
 {
-  actionsAfterComboFeedback = actions;
-  actionsAfterComboFeedbackSize = size;
+  const Action *const *oldActions = actionOrchestrator.getCurrentActions();
 
-  if (!isRunningComboFeedback) {
-    const Action **oldActions = actionOrchestrator.getCurrentActions();
-    actionOrchestrator.change(actions, size);
+  if (oldActions == DISCONNECTED_ACTION_CHAIN && actions == actionsBeforeDisconnection.actions) {
+    // Reconnected with the door in the same state: do not replay its melody nor restart its reminders
+    actionOrchestrator.resume(&actionsBeforeDisconnection);
+    return;
+  }
+  actionOrchestrator.change(actions, size);
 
-    // Unmute AFTER orchestrator change, to not play the "Door closed" melody
-    if (muteSoundUntilNextClose && isAnOpenActionChain(oldActions) && actions == CLOSED_ACTION_CHAIN) {
-      actionOrchestrator.loop(); // change(...) is "asynchronous": trigger another loop() to "apply" the change and start the chain, playing a mute melody just before unmuting the buzzer
-      muteSoundUntilNextClose = false;
-      buzzer.unmute();
-    }
+  // Unmute AFTER orchestrator change, to not play the "Door closed" melody
+  if (muteSoundUntilNextClose && isAnOpenActionChain(oldActions) && actions == CLOSED_ACTION_CHAIN) {
+    actionOrchestrator.loop(millis()); // change(...) is "asynchronous": trigger another loop() to "apply" the change and start the chain, playing a mute melody just before unmuting the buzzer
+    muteSoundUntilNextClose = false;
+    buzzer.unmute();
   }
 }
 void stopRunningComboFeedback()
 {
-  isRunningComboFeedback = false;
-  if (actionsAfterComboFeedback != nullptr) {
-    changeNormalAction(actionsAfterComboFeedback, actionsAfterComboFeedbackSize);
-  }
+  feedbackActionOrchestrator.stop(); // Release the feedback LEDs: the current state shows again, as it never stopped running below
 }
 // COMBOS
 
@@ -51,6 +54,7 @@ void setup()
 {
   Serial.begin(115200);
   Serial.println("Door Dashboard");
+  Serial.println(F("Send w to print the wireless link quality, r to reset it"));
 
   disconnectedLed.setup();
   openLed.setup();
@@ -73,64 +77,145 @@ void setup()
   buzzerVolumeManager.setup(DEFAULT_BUZZER_VOLUME_STEP);
 
   wireless.setup(WIRELESS_RADIO_ID, WIRELESS_DESTINATION_RADIO_ID, WIRELESS_CHANNEL);
-  wireless.enableReceptionTimeout(WIRELESS_RECEPTION_TIMEOUT_MS, &onReceptionTimeout);
-
-  // See documentation of the class Restarter for delay recommendations
-  Restarter::setup(
-    /* gracefulRestartDelay = */ 48 * DAYS_AS_MS + 12 * HOURS_AS_MS, // Hopefully, once in 3 months, it will be during night for nobody to notice the restart
-    /* forcedRestartDelay = */ 12 * HOURS_AS_MS,
-    []() {
-      return !wireless.inReceptionTimeout() &&
-        actionOrchestrator.getCurrentActions() == CLOSED_ACTION_CHAIN;
-    });
+#ifdef WIRELESS_AUTHENTICATION_KEY_TO_PROVISION
+  const uint8_t key[SIPHASH_KEY_SIZE] = WIRELESS_AUTHENTICATION_KEY_TO_PROVISION;
+  Wireless::provisionAuthenticationKey(WIRELESS_EEPROM_ADDRESS, key);
+#endif
+  wireless.enableAuthentication(WIRELESS_EEPROM_ADDRESS);
+  wireless.enableAdaptiveReceptionTimeout(WIRELESS_RECEPTION_TIMEOUT_MS, WIRELESS_MIN_RECEPTION_TIMEOUT_MS, WIRELESS_MAX_RECEPTION_TIMEOUT_MS, &onReceptionTimeout);
+  pollRightAway();
 
   changeNormalAction(WAITING_FIRST_SIGNAL_ACTION_CHAIN, WAITING_FIRST_SIGNAL_ACTION_CHAIN_SIZE);
 }
 
 void loop()
 {
-  disconnectedLed.loop();
-  openLed.loop();
-  keptOpenLed.loop();
-  closingLed.loop();
-  autoClosedLed.loop();
+  const Timestamp now = millis();
+
+  disconnectedLed.loop(now);
+  openLed.loop(now);
+  keptOpenLed.loop(now);
+  closingLed.loop(now);
+  autoClosedLed.loop(now);
+
+  InputBank::loop(now);
+  keepOpenButton.loop(now);
+  closeButton.loop(now);
+  acknowledgeAutoClosedButton.loop(now);
+
+  buzzer.loop(now);
+
+  loopWireless(now);
+
+  actionOrchestrator.loop(now);
+  feedbackActionOrchestrator.loop(now);
 
-  keepOpenButton.loop();
-  closeButton.loop();
-  acknowledgeAutoClosedButton.loop();
+  loopSerialCommands();
 
-  buzzer.loop();
+  sleepUntilNextDeadline();
+}
 
-  loopWireless();
+void loopSerialCommands()
+{
+  while (Serial.available() > 0) { // Received bytes wake the microcontroller up
+    const int command = Serial.read();
+    if (command == 'w') {
+      wireless.printLinkQuality();
+    } else if (command == 'r') {
+      wireless.resetLinkQuality();
+      Serial.println(F("Wireless link quality reset"));
+    }
+  }
+}
 
-  actionOrchestrator.loop();
+// ADAPTIVE POLLING
+Timestamp nextSendingTime = 0;
+unsigned long pollDelay = WIRELESS_ACTIVE_POLL_DELAY_MS;
+byte lastStateMessage = 0; // 0 until the first state is received
 
-  Restarter::loop();
+void pollRightAway()
+{
+  nextSendingTime = millis(); // Not 0, which would be in the future when millis() is close to its overflow
 }
 
-unsigned long nextSendingTime = 0;
+void sendButtonPress(byte buttonIndex)
+{
+  RemoteButtonsSender::onButtonPressed(buttonIndex);
+  pollRightAway(); // Without waiting for the next poll
+}
 
-void loopWireless()
+unsigned long nextPollDelay()
 {
-  if (nextSendingTime <= millis()) {
+  if (RemoteButtonsSender::isWaitingForAck()) {
+    return WIRELESS_ACK_POLL_DELAY_MS;
+  }
+
+  if (lastStateMessage != MESSAGE_STATE_CLOSED || wireless.inReceptionTimeout()) {
+    return WIRELESS_ACTIVE_POLL_DELAY_MS;
+  }
+
+  // Back off progressively, so a door opening just after closing is still shown quickly
+  const unsigned long backedOffDelay = max(pollDelay, WIRELESS_ACTIVE_POLL_DELAY_MS) * 2;
+  return min(backedOffDelay, WIRELESS_IDLE_POLL_DELAY_MS);
+}
+
+void scheduleNextPoll()
+{
+  const unsigned long newPollDelay = nextPollDelay();
+  if (newPollDelay != pollDelay) {
+    pollDelay = newPollDelay;
+    wireless.setReceptionTimeout(WIRELESS_RECEPTION_TIMEOUT_MS + pollDelay); // The controller replies at the pace of polls
+  }
+
+  nextSendingTime = millis() + pollDelay;
+}
+// ADAPTIVE POLLING
+
+void sleepUntilNextDeadline()
+{
+  IdleSleeper::wakeUpAt(disconnectedLed.nextDeadline());
+  IdleSleeper::wakeUpAt(openLed.nextDeadline());
+  IdleSleeper::wakeUpAt(keptOpenLed.nextDeadline());
+  IdleSleeper::wakeUpAt(closingLed.nextDeadline());
+  IdleSleeper::wakeUpAt(autoClosedLed.nextDeadline());
+
+  IdleSleeper::wakeUpAt(InputBank::nextDeadline());
+  IdleSleeper::wakeUpAt(keepOpenButton.nextDeadline());
+  IdleSleeper::wakeUpAt(closeButton.nextDeadline());
+  IdleSleeper::wakeUpAt(acknowledgeAutoClosedButton.nextDeadline());
+
+  IdleSleeper::wakeUpAt(buzzer.nextDeadline());
+
+  IdleSleeper::wakeUpAt(deadlineAt(nextSendingTime));
+  IdleSleeper::wakeUpAt(wireless.nextDeadline());
+
+  IdleSleeper::wakeUpAt(actionOrchestrator.nextDeadline());
+  IdleSleeper::wakeUpAt(feedbackActionOrchestrator.nextDeadline());
+
+  IdleSleeper::sleep();
+}
+
+void loopWireless(const Timestamp now)
+{
+  if (!isBefore(now, nextSendingTime)) {
     sendMessage();
   }
   wireless.receive(&handleWirelessDataReceived);
-  wireless.loop();
+  wireless.loop(now);
 }
 
 void onReceptionTimeout(bool timeout)
 {
   if (timeout) {
-    changeNormalAction(DISCONNECTED_ACTION_CHAIN, DISCONNECTED_ACTION_CHAIN_SIZE);
+    suspendNormalActionDuringDisconnection();
   }
 }
 
-void showVolumeStepChangeFeedback(uint8_t step)
+void showVolumeStepChangeFeedback(uint8_t /* step: read by SHOW_VOLUME_STEP_ACTION */)
 {
   startComboAction(
-    getActionChainForVolumeStep(step),
-    getActionChainSizeForVolumeStep(step));
+    VOLUME_FEEDBACK_ACTION_CHAIN,
+    VOLUME_FEEDBACK_ACTION_CHAIN_SIZE);
 }
 
 bool comboStartedForAcknowledgeAutoClosedButton = false;
@@ -141,7 +226,7 @@ void handleKeepOpenButtonPress()
     comboStartedForAcknowledgeAutoClosedButton = true;
     buzzerVolumeManager.decrease();
   } else {
-    RemoteButtonsSender::onButtonPressed(MESSAGE_PRESSED_BUTTON_KEEP_OPEN);
+    sendButtonPress(MESSAGE_PRESSED_BUTTON_KEEP_OPEN);
   }
 }
 
@@ -151,29 +236,38 @@ void handleCloseButtonPress()
     comboStartedForAcknowledgeAutoClosedButton = true;
     buzzerVolumeManager.increase();
   } else {
-    RemoteButtonsSender::onButtonPressed(MESSAGE_PRESSED_BUTTON_CLOSE);
+    sendButtonPress(MESSAGE_PRESSED_BUTTON_CLOSE);
   }
 }
 
 void handleAcknowledgeAutoClosedPress()
 {
   comboStartedForAcknowledgeAutoClosedButton = false;
-  RemoteButtonsSender::onButtonPressed(MESSAGE_PRESSED_BUTTON_ACK_AUTO_CLOSED);
+  sendButtonPress(MESSAGE_PRESSED_BUTTON_ACK_AUTO_CLOSED);
 }
 
 void handleAcknowledgeAutoClosedLongPress(unsigned int repeatNumber)
 {
   if (!comboStartedForAcknowledgeAutoClosedButton) {
     if (repeatNumber == 1) {
-      RemoteButtonsSender::onButtonPressed(MESSAGE_PRESSED_COMBO_TOGGLE_DEMO_MODE);
+      sendButtonPress(MESSAGE_PRESSED_COMBO_TOGGLE_DEMO_MODE);
     } else if (repeatNumber == 2) {
       testLedBrightness();
     }
   }
 }
 
+void loopAcknowledgeAutoClosedButton()
+{
+  const Timestamp now = millis();
+  InputBank::loop(now);
+  acknowledgeAutoClosedButton.loop(now);
+}
+
 void testLedBrightness()
 {
+  OutputLayer selection(OVERLAY_OUTPUT_LAYER);
+
   led1->turnOn();
   led2->turnOn();
   led3->turnOn();
@@ -182,19 +276,19 @@ void testLedBrightness()
 
   // Wait for the combo press to be finished
   while (acknowledgeAutoClosedButton.isPressed()) {
-    acknowledgeAutoClosedButton.loop();
+    loopAcknowledgeAutoClosedButton();
   }
 
   // Wait for a new press to stop the combo
   while (!acknowledgeAutoClosedButton.isPressed()) {
-    acknowledgeAutoClosedButton.loop();
+    loopAcknowledgeAutoClosedButton();
   }
 
-  led1->turnOff();
-  led2->turnOff();
-  led3->turnOff();
-  led4->turnOff();
-  led5->turnOff();
+  led1->release();
+  led2->release();
+  led3->release();
+  led4->release();
+  led5->release();
 
   stopRunningComboFeedback();
 }
@@ -219,46 +313,36 @@ void handleAcknowledgeAutoClosedMultiPress(unsigned int pressCount)
 
 void handleWirelessDataReceived(byte data[], uint8_t size)
 {
-  const byte header = data[0];
-  const byte stateMessage = data[1];
-  const bool autoClosed = data[2];
-  const bool newIsDemoMode = data[3];
-  const byte ackedButtonPressEventId = data[4];
+  const DoorStatusMessage *message = decodeDoorStatusMessage(data, size);
 
-  bool messageIsErroneous = size != 5 || header != MESSAGE_HEADER;
+  bool messageIsErroneous = (message == nullptr);
 
   if (!messageIsErroneous) {
-    messageIsErroneous = handleStateMessageReceived(stateMessage);
+    messageIsErroneous = handleStateMessageReceived(message->state);
   }
 
   if (!messageIsErroneous) {
-    if (!isRunningComboFeedback) {
-      autoClosedLed.set(autoClosed);
-    } // else: no need to save it for after the feedback: we pressed ACK to start a combo, so the LED is OFF
-    if (isDemoMode != newIsDemoMode) {
-      isDemoMode = newIsDemoMode;
+    lastStateMessage = message->state;
+
+    autoClosedLed.set(message->isAutoClosed); // In the base layer: a running combo feedback stays shown over it
+    if (isDemoMode != message->isDemoMode) {
+      isDemoMode = message->isDemoMode;
       startComboAction(
         DEMO_MODE_TOGGLE_ACTION_CHAIN,
         DEMO_MODE_TOGGLE_ACTION_CHAIN_SIZE);
     }
-    if (ackedButtonPressEventId != 0) {
-      RemoteButtonsSender::ackEventId(ackedButtonPressEventId);
-    }
+    RemoteButtonsSender::ackEventId(message->ackedButtonPressEventId); // Even 0: the first one synchronizes the IDs
   }
 
   if (messageIsErroneous) {
     Serial.print("Received erroneous message (size ");
     Serial.print(size);
-    Serial.print("): ");
-    Serial.print(data[0]);
-    Serial.print(" ");
-    Serial.print(data[1]);
-    Serial.print(" ");
-    Serial.print(data[2]);
-    Serial.print(" ");
-    Serial.print(data[3]);
-    Serial.print(" ");
-    Serial.println(data[4]);
+    Serial.print("):");
+    for (uint8_t i = 0; i < size; i++) {
+      Serial.print(" ");
+      Serial.print(data[i]);
+    }
+    Serial.println();
     // Serial.flush();
   }
 }
@@ -304,11 +388,28 @@ bool handleStateMessageReceived(const byte stateMessage)
 
 void sendMessage()
 {
-  nextSendingTime = millis() + WIRELESS_POLL_DELAY_MS;
+  static_assert(RemoteButtonsSender::MAX_PENDING_EVENTS <= MESSAGE_MAX_BUTTON_PRESSES, "The controller cannot handle so many button presses at once");
+
+  const bool replyInAck = wireless.canSendForAckPayload();
+  const uint8_t eventCount = RemoteButtonsSender::getPendingEventCount();
+
+  DashboardMessage message;
+  message.header = MESSAGE_HEADER;
+  message.replyInAck = replyInAck;
+  message.protocolVersion = PROTOCOL_VERSION;
+  message.unused = 0;
+  message.firstEventId = RemoteButtonsSender::getFirstPendingEventId(); // Not sent when polling without button press
+  for (uint8_t i = 0; i < eventCount; i++) {
+    message.buttonIndexes[i] = RemoteButtonsSender::getPendingEventButtonIndex(i);
+  }
 
-  uint8_t eventId = RemoteButtonsSender::getCurrentEventId();
-  uint8_t buttonIndex = RemoteButtonsSender::getCurrentEventButtonIndex();
+  if (replyInAck) {
+    // The controller replies in the ACK: a single radio exchange
+    wireless.sendForAckPayload((byte *) &message, dashboardMessageSize(eventCount), &handleWirelessDataReceived);
+  } else {
+    // The controller replies with a separate message, received by loopWireless()
+    wireless.send((byte *) &message, dashboardMessageSize(eventCount));
+  }
 
-  byte payload[] = { MESSAGE_HEADER, eventId, buttonIndex };
-  wireless.send(payload, sizeof(payload));
+  scheduleNextPoll(); // After a possible reply in the ACK, which can acknowledge the button press or change the state
 }
@@ -49,13 +49,41 @@ BuzzerVolumeManager buzzerVolumeManager = BuzzerVolumeManager(
 
 //////// Wireless radio communications ////////
 
-Wireless wireless = Wireless(/*CE=*/A0, /*CSN=*/A1);
+// Set WIRELESS_IRQ_PIN to a pin if the IRQ pin of the radio is wired, to stop polling the radio at every loop
+// Add /*POWER=*/<pin> as a fourth parameter if the power of the radio is switched by a pin (HIGH powering it), to also power-cycle it when it locks up
+#ifndef WIRELESS_IRQ_PIN // Can be set when building, like the host build does for its simulated radio (see host/Makefile)
+#define WIRELESS_IRQ_PIN Wireless::NO_IRQ_PIN
+#endif
+Wireless wireless = Wireless(/*CE=*/A0, /*CSN=*/A1, /*IRQ=*/WIRELESS_IRQ_PIN);
 
 const static uint8_t WIRELESS_RADIO_ID = 0; // WIRELESS_RADIO_ID and WIRELESS_DESTINATION_RADIO_ID must be inverted in dashboard and controller
 const static uint8_t WIRELESS_DESTINATION_RADIO_ID = 1; // WIRELESS_RADIO_ID and WIRELESS_DESTINATION_RADIO_ID must be inverted in dashboard and controller
 const static uint8_t WIRELESS_CHANNEL = 100; // Sending&receiving channel, can fill 0~128, dashboard and controller must use the same channel
 
-const static unsigned long WIRELESS_POLL_DELAY_MS = 50; // No less than 15ms, so buttons stay responsive and/or messages can be sent without overloading radio too much
-const static unsigned long WIRELESS_RECEPTION_TIMEOUT_MS = 5 * SECONDS_AS_MS; // Needs to be at least longer than a restart (about 3 seconds) because of Restarter
+const static int WIRELESS_EEPROM_ADDRESS = 16; // Authentication key and counters (24 bytes), after the other settings
+// To store a new authentication key, the same 16 random bytes in dashboard and controller: uncomment, upload to both boards,
+// then comment again and upload again to both boards (provisioning at each start would make replays possible, and the key would stay in the firmware)
+// #define WIRELESS_AUTHENTICATION_KEY_TO_PROVISION { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
+
+// Polling delays: no less than 15ms, so buttons stay responsive and/or messages can be sent without overloading radio too much
+// Like the reception timeouts below, they can be set when building, e.g. to compare them in the fleet simulator of the host build (see host/Makefile)
+#ifndef WIRELESS_ACK_POLL_DELAY_MS
+#define WIRELESS_ACK_POLL_DELAY_MS 20UL // While a button press was not acknowledged yet by the controller (a press is sent right away)
+#endif
+#ifndef WIRELESS_ACTIVE_POLL_DELAY_MS
+#define WIRELESS_ACTIVE_POLL_DELAY_MS 50UL // While the door is not closed, or while disconnected
+#endif
+#ifndef WIRELESS_IDLE_POLL_DELAY_MS
+#define WIRELESS_IDLE_POLL_DELAY_MS (1 * SECONDS_AS_MS) // While the door is closed: the delay doubles at each poll up to this one, saving radio traffic and power
+#endif
+#ifndef WIRELESS_MIN_RECEPTION_TIMEOUT_MS
+#define WIRELESS_MIN_RECEPTION_TIMEOUT_MS 300UL // A disconnection is reported after several missed replies of the controller at their recent pace, but not sooner than this
+#endif
+#ifndef WIRELESS_RECEPTION_TIMEOUT_MS
+#define WIRELESS_RECEPTION_TIMEOUT_MS (5 * SECONDS_AS_MS) // Until the pace of replies is known: long enough to not report a disconnection when the other board restarts (about 3 seconds), e.g. after a power cut (the current polling delay is added to it)
+#endif
+#ifndef WIRELESS_MAX_RECEPTION_TIMEOUT_MS
+#define WIRELESS_MAX_RECEPTION_TIMEOUT_MS (30 * SECONDS_AS_MS) // Once the pace is known: a link losing most frames still keeps a timeout long enough to not flap
+#endif
 
 #endif
@@ -1,10 +1,14 @@
 #ifndef ACTION_CHAIN_H
 #define ACTION_CHAIN_H
 
+#include <Arduino.h>
+
 #include "../hardware/buzzer.h"
 #include "../hardware/led.h"
+#include "../hardware/output-layer.h"
 #include "../hardware/relay.h"
 #include "../hardware/timer.h"
+#include "../time/deadline.h"
 
 /**
  * Only for internal usage purpose (to implement loops).
@@ -17,6 +21,8 @@ enum ActionRole {
 
 /**
  * Base class for any action to be executed in a chain by an ActionOrchestrator.
+ * Declare actions as static objects (not with `new`) so they are not allocated on the scarce heap:
+ * actions provided here have constexpr constructors whenever possible, to be initialized at compile time.
  */
 class Action
 {
@@ -47,12 +53,22 @@ class Action
     /**
      * Called when the chain ended.
      * This method must undo any execution started in start(), as if the action never started.
-     * It must e.g. turn off the LEDs lit on by start(), turn off buzzer, delete timers, etc.
+     * It must e.g. release the LEDs lit on by start(), turn off buzzer, delete timers, etc.
      */
     virtual void destroy() const
     {
     }
 
+    /**
+     * Called when a suspended chain resumes, for this action if it already started before the chain got suspended.
+     * This method must re-apply the lasting effects of start() that destroy() undid (e.g. lit LEDs),
+     * but not its one-time effects (e.g. playing a melody or running a function).
+     * Does nothing by default.
+     */
+    virtual void resume() const
+    {
+    }
+
     /**
      * Only for internal usage purpose (to implement loops).
      */
@@ -69,7 +85,7 @@ class Action
 const Action NO_ACTION = Action();
 
 /**
- * Start to blink a given LED following a pattern (turn off at chain's end).
+ * Start to blink a given LED following a pattern (release at chain's end).
  * This action is non-blocking: the next action will run just after this one.
  */
 class StartBlinkingLedAction : public Action
@@ -79,7 +95,7 @@ class StartBlinkingLedAction : public Action
     const LedPattern *pattern;
 
   public:
-    StartBlinkingLedAction(Led *led, const LedPattern *pattern)
+    constexpr StartBlinkingLedAction(Led *led, const LedPattern *pattern)
       : led(led)
       , pattern(pattern)
     {
@@ -90,14 +106,19 @@ class StartBlinkingLedAction : public Action
       led->blink(pattern);
     }
 
+    void resume() const
+    {
+      start();
+    }
+
     void destroy() const
     {
-      led->turnOff();
+      led->release();
     }
 };
 
 /**
- * Start to alternate blinking between two given LEDs (turn off both at chain's end).
+ * Start to alternate blinking between two given LEDs (release both at chain's end).
  * Each LED is lit `period` milliseconds before the next one is.
  * This action is non-blocking: the next action will run just after this one.
  */
@@ -130,15 +151,20 @@ class StartAlternateBlinkingLedsAction : public Action
       led2->blink(&pattern2);
     }
 
+    void resume() const
+    {
+      start();
+    }
+
     void destroy() const
     {
-      led1->turnOff();
-      led2->turnOff();
+      led1->release();
+      led2->release();
     }
 };
 
 /**
- * Turn on a given LED (turn off at chain's end).
+ * Turn on a given LED (release at chain's end).
  * This action is non-blocking: the next action will run just after this one.
  */
 class TurnOnLedAction : public Action
@@ -147,7 +173,7 @@ class TurnOnLedAction : public Action
     Led *led;
 
   public:
-    TurnOnLedAction(Led *led)
+    constexpr TurnOnLedAction(Led *led)
       : led(led)
     {
     }
@@ -157,9 +183,14 @@ class TurnOnLedAction : public Action
       led->turnOn();
     }
 
+    void resume() const
+    {
+      start();
+    }
+
     void destroy() const
     {
-      led->turnOff();
+      led->release();
     }
 };
 
@@ -174,7 +205,7 @@ class TemporarilyPowerOnRelayAction : public Action
     unsigned long powerOnDuration;
 
   public:
-    TemporarilyPowerOnRelayAction(Relay *relay, unsigned long powerOnDuration)
+    constexpr TemporarilyPowerOnRelayAction(Relay *relay, unsigned long powerOnDuration)
       : relay(relay)
       , powerOnDuration(powerOnDuration)
     {
@@ -205,14 +236,14 @@ class StartPlayingMelodyAction : public Action
     static unsigned long lastMainStateTransitionAction;
 
   public:
-    StartPlayingMelodyAction(Buzzer *buzzer, const BuzzerMelody *melody)
+    constexpr StartPlayingMelodyAction(Buzzer *buzzer, const BuzzerMelody *melody)
       : buzzer(buzzer)
       , melody(melody)
       , isMainStateTransition(false)
     {
     }
 
-    StartPlayingMelodyAction(Buzzer *buzzer, const BuzzerMelody *melody, const bool isMainStateTransition)
+    constexpr StartPlayingMelodyAction(Buzzer *buzzer, const BuzzerMelody *melody, const bool isMainStateTransition)
       : buzzer(buzzer)
       , melody(melody)
       , isMainStateTransition(isMainStateTransition)
@@ -226,7 +257,7 @@ class StartPlayingMelodyAction : public Action
         if (lastMainStateTransitionAction != (unsigned long) this) {
           // No sound on startup, when lastMainStateTransitionAction is 0.
           // Because we play sounds only for user-visible transitions:
-          // likely no transition at startup, or worst, after restart by the Restarter class
+          // likely no transition at startup
           if (lastMainStateTransitionAction != 0) {
             buzzer->play(melody);
           }
@@ -255,7 +286,7 @@ class WaitAction : public Action
     const unsigned long waitDuration;
 
   public:
-    WaitAction(const unsigned long waitDuration)
+    constexpr WaitAction(const unsigned long waitDuration)
       : waitDuration(waitDuration)
     {
     }
@@ -275,7 +306,7 @@ class RunnableAction : public Action
     void (*run)();
 
   public:
-    RunnableAction(void (*run)())
+    constexpr RunnableAction(void (*run)())
       : run(run)
     {
     }
@@ -297,12 +328,12 @@ class LoopBeginAction : public Action
     const unsigned int iterations;
 
   public:
-    LoopBeginAction()
+    constexpr LoopBeginAction()
       : iterations(0)
     {
     }
 
-    LoopBeginAction(const unsigned int iterations)
+    constexpr LoopBeginAction(const unsigned int iterations)
       : iterations(iterations)
     {
     }
@@ -324,7 +355,7 @@ class LoopBeginAction : public Action
 /**
  * Marks the begin of an infinite loop, to run the following actions indefinitely.
  * Prefer using this constant for infinite loops.
- * See `new LoopBeginAction(const unsigned int iterations)` to initiate a finite loops.
+ * See `LoopBeginAction(const unsigned int iterations)` to initiate a finite loops.
  */
 const LoopBeginAction LOOP_BEGIN_ACTION = LoopBeginAction();
 
@@ -348,25 +379,96 @@ class LoopEndAction : public Action
  */
 const LoopEndAction LOOP_END_ACTION = LoopEndAction();
 
+/**
+ * The progress of a suspended action chain, to resume it later at the same action, with the same remaining duration.
+ */
+struct SuspendedActionChain
+{
+  const Action *const *actions = nullptr; // nullptr if no chain was running when suspended
+  uint8_t size = 0;
+
+  int currentActionIndex = -1;
+  unsigned long remainingDuration = 0;
+
+  int loopBeginIndex = -1;
+  int loopEndIndex = -1;
+  unsigned int remainingLoopIterations = 0;
+};
+
+/**
+ * How an ActionOrchestrator computes the end of an action.
+ */
+enum ActionScheduling {
+  /**
+   * Each action ends its duration after the time at which loop() actually started it.
+   * The latency of loop() adds up at each action: long-running loops slowly drift.
+   */
+  DRIFTING_SCHEDULING,
+
+  /**
+   * Each action ends its duration after the scheduled end of the previous action, whatever the latency of loop():
+   * an hourly loop keeps triggering at the same minute forever.
+   * If loop() was late by more than a whole action, the chain resynchronizes on the current time instead of catching up.
+   */
+  DRIFT_FREE_SCHEDULING
+};
+
+/**
+ * Lateness statistics of the action switches of the current chain, reset when a new chain starts.
+ * The lateness of a switch is the time elapsed between the deadline of the action and the moment loop() ended it.
+ */
+struct ActionChainTimings
+{
+  unsigned long switchCount = 0;
+  unsigned long minLateness = 0xFFFFFFFF; // 0xFFFFFFFF until the first switch
+  unsigned long maxLateness = 0;
+  unsigned long totalLateness = 0;
+  unsigned long resynchronizationCount = 0; // Only in DRIFT_FREE_SCHEDULING
+
+  /**
+   * The difference between the latest and the earliest switches, or 0 before the second switch.
+   */
+  unsigned long jitter() const
+  {
+    return (switchCount < 2 ? 0 : maxLateness - minLateness);
+  }
+};
+
 /**
  * Orchestrate a chain of actions to run one after the other, in a non-blocking way.
+ * Several orchestrators can run at the same time as independent tracks: each one writes to its own output layer,
+ * so a track with a higher layer (e.g. short feedback animations) shows over a lower one (e.g. the current state)
+ * without interrupting it.
+ * An action chain is an array of pointers to actions, that must be stored in flash memory, to save SRAM:
+ * declare it as `const Action *const MY_ACTION_CHAIN[] PROGMEM = { ... };`.
  */
 class ActionOrchestrator
 {
   private:
-    const Action **nextActions = nullptr;
+    const uint8_t outputLayer;
+    const ActionScheduling scheduling;
+
+    const Action *const *nextActions = nullptr;
     uint8_t nextSize = 0;
+    const SuspendedActionChain *nextResumedChain = nullptr; // Resume nextActions instead of starting them, if not nullptr
 
-    const Action **actions = nullptr;
+    const Action *const *actions = nullptr; // In flash memory (PROGMEM)
     uint8_t size = 0;
 
     int currentActionIndex = -1;
-    unsigned long nextActionSwitchTimestamp = 0; // Irrelevant when currentActionIndex is -1
+    Timestamp currentActionStartTimestamp = 0; // Scheduled start (not actual start) of the current action
+    Timestamp nextActionSwitchTimestamp = 0; // Irrelevant when currentActionIndex is -1
+    ActionChainTimings timings;
 
     int loopBeginIndex = -1;
     int loopEndIndex = -1;
     unsigned int remainingLoopIterations = 0;
 
+    const Action *actionAt(int index) const
+    {
+      return (const Action *) pgm_read_ptr(&actions[index]);
+    }
+
     bool isRunning()
     {
       return currentActionIndex >= 0;
@@ -386,7 +488,7 @@ class ActionOrchestrator
     }
 
     void startCurrentAction() {
-      const Action *action = actions[currentActionIndex];
+      const Action *action = actionAt(currentActionIndex);
 
       if (action->role() == LOOP_BEGIN) {
         const LoopBeginAction *loopBegin = (LoopBeginAction *) action;
@@ -423,33 +525,79 @@ class ActionOrchestrator
       }
 
       action->start();
+      if (!isRunning()) {
+        return; // The action stopped the chain
+      }
 
       unsigned long actionDuration = action->duration();
       if (actionDuration == 0) {
         startNextAction();
       } else {
-        nextActionSwitchTimestamp = millis() + actionDuration;
+        nextActionSwitchTimestamp = currentActionStartTimestamp + actionDuration;
+
+        const Timestamp now = millis();
+        if (isBefore(nextActionSwitchTimestamp, now)) {
+          // loop() was late by more than this whole action: do not rush through the chain to catch up
+          nextActionSwitchTimestamp = now + actionDuration;
+          timings.resynchronizationCount++;
+        }
       }
     }
 
+    void switchActionOnDeadline(const Timestamp now)
+    {
+      const unsigned long lateness = (Timestamp) (now - (nextActionSwitchTimestamp + 1)); // loop() switches strictly after the timestamp
+
+      timings.switchCount++;
+      timings.totalLateness += lateness;
+      if (lateness < timings.minLateness) {
+        timings.minLateness = lateness;
+      }
+      if (lateness > timings.maxLateness) {
+        timings.maxLateness = lateness;
+      }
+
+      currentActionStartTimestamp = (scheduling == DRIFT_FREE_SCHEDULING ? nextActionSwitchTimestamp : now);
+      startNextAction();
+    }
+
     void expireCurrentAction()
     {
-      actions[currentActionIndex]->durationExpired();
+      actionAt(currentActionIndex)->durationExpired();
     }
 
     void destroyAllActions()
     {
       for (int i = 0; i < size; i++) {
-        actions[i]->destroy();
+        actionAt(i)->destroy();
+      }
+    }
+
+    void resumeActions(const SuspendedActionChain *suspended, const Timestamp now)
+    {
+      currentActionIndex = suspended->currentActionIndex;
+
+      loopBeginIndex = suspended->loopBeginIndex;
+      loopEndIndex = suspended->loopEndIndex;
+      remainingLoopIterations = suspended->remainingLoopIterations;
+
+      const int lastStartedIndex = (currentActionIndex < size ? currentActionIndex : size - 1);
+      for (int i = 0; i <= lastStartedIndex; i++) {
+        actionAt(i)->resume();
       }
+
+      currentActionStartTimestamp = now;
+      nextActionSwitchTimestamp = now + suspended->remainingDuration;
     }
 
-    void resetActionsState(const Action **actions, uint8_t size) {
+    void resetActionsState(const Action *const *actions, uint8_t size) {
       this->actions = actions;
       this->size = size;
 
       currentActionIndex = -1;
+      currentActionStartTimestamp = 0;
       nextActionSwitchTimestamp = 0;
+      timings = ActionChainTimings();
 
       loopBeginIndex = -1;
       loopEndIndex = -1;
@@ -457,49 +605,116 @@ class ActionOrchestrator
     }
 
   public:
-    ActionOrchestrator()
+    ActionOrchestrator(const uint8_t outputLayer = BASE_OUTPUT_LAYER, const ActionScheduling scheduling = DRIFT_FREE_SCHEDULING)
+      : outputLayer(outputLayer)
+      , scheduling(scheduling)
     {
     }
 
     /**
      * Ensure to run this function in the Arduino's loop() function, in order to trigger the correct sequence of actions.
      */
-    void loop()
+    void loop(const Timestamp now)
     {
+      OutputLayer selection(outputLayer);
+
       if (nextActions != nullptr) {
         if (isRunning()) {
           stop();
         }
 
         resetActionsState(nextActions, nextSize);
+        currentActionStartTimestamp = now;
 
         nextActions = nullptr;
         nextSize = 0;
 
-        startNextAction();
-      } else if (isRunning() && currentActionIndex < size && millis() > nextActionSwitchTimestamp) {
-        startNextAction();
+        if (nextResumedChain != nullptr) {
+          resumeActions(nextResumedChain, now);
+          nextResumedChain = nullptr;
+        } else {
+          startNextAction();
+        }
+      } else if (isRunning() && currentActionIndex < size && isAfter(now, nextActionSwitchTimestamp)) {
+        switchActionOnDeadline(now);
       }
     }
 
+    /**
+     * Returns the timestamp at which loop() will have to start the next action, or NO_DEADLINE if the chain is waiting for nothing.
+     */
+    Timestamp nextDeadline() const
+    {
+      if (nextActions != nullptr) {
+        return deadlineAt(millis()); // A new chain is waiting to be started
+      }
+
+      if (currentActionIndex >= 0 && currentActionIndex < size) {
+        return deadlineAt(nextActionSwitchTimestamp + 1); // loop() switches strictly after the timestamp
+      }
+
+      return NO_DEADLINE;
+    }
+
     /**
      * Start a new action chain, or restart the current one if passing the current action chain as parameter of this function.
      */
-    void start(const Action **actions, uint8_t size)
+    void start(const Action *const *actions, uint8_t size)
     {
       nextActions = actions;
       nextSize = size;
+      nextResumedChain = nullptr;
     }
 
     /**
      * Start a new action chain if passing an action chain different that the one currently running as parameter of this function.
      */
-    void change(const Action **actions, uint8_t size)
+    void change(const Action *const *actions, uint8_t size)
     {
       if (actions != ActionOrchestrator::actions &&
           actions != ActionOrchestrator::nextActions) {
         nextActions = actions;
         nextSize = size;
+        nextResumedChain = nullptr;
+      }
+    }
+
+    /**
+     * Stop the execution of the current action chain, if any, saving its progress to resume it later with resume().
+     * Time does not elapse for a suspended chain: it will resume with the remaining duration of its current action.
+     */
+    void suspend(SuspendedActionChain *suspended)
+    {
+      *suspended = SuspendedActionChain();
+
+      if (isRunning()) {
+        suspended->actions = actions;
+        suspended->size = size;
+
+        suspended->currentActionIndex = currentActionIndex;
+        if (currentActionIndex < size) {
+          const Timestamp now = millis();
+          suspended->remainingDuration = (isAfter(nextActionSwitchTimestamp, now) ? nextActionSwitchTimestamp - now : 0);
+        }
+
+        suspended->loopBeginIndex = loopBeginIndex;
+        suspended->loopEndIndex = loopEndIndex;
+        suspended->remainingLoopIterations = remainingLoopIterations;
+
+        stop();
+      }
+    }
+
+    /**
+     * Resume an action chain suspended by suspend(), where it left off, without starting again its already started actions.
+     * The suspended progress must stay valid until the next call to loop().
+     */
+    void resume(const SuspendedActionChain *suspended)
+    {
+      if (suspended->actions != nullptr) {
+        nextActions = suspended->actions;
+        nextSize = suspended->size;
+        nextResumedChain = suspended;
       }
     }
 
@@ -508,6 +723,8 @@ class ActionOrchestrator
      */
     void stop()
     {
+      OutputLayer selection(outputLayer);
+
       if (isRunning()) {
         destroyAllActions();
         resetActionsState(nullptr, 0);
@@ -517,7 +734,7 @@ class ActionOrchestrator
     /**
      * Get the currently executed action chain, if any.
      */
-    const Action **getCurrentActions()
+    const Action *const *getCurrentActions()
     {
       return actions;
     }
@@ -529,6 +746,14 @@ class ActionOrchestrator
     {
       return size;
     }
+
+    /**
+     * Get the lateness statistics of the currently executed action chain, if any.
+     */
+    const ActionChainTimings *getTimings() const
+    {
+      return &timings;
+    }
 };
 
 #endif
@@ -0,0 +1,12 @@
+#ifndef CRC8_H
+#define CRC8_H
+
+#include <Arduino.h>
+
+/**
+ * Table-driven CRC-8 (polynomial 0x07, as in CRC-8/SMBUS), detecting all the 1 and 2 bit errors and all the burst errors up to 8 bits in a radio frame.
+ * Pass the CRC of the previous bytes as crc to continue a computation.
+ */
+uint8_t crc8(const byte *data, uint8_t size, uint8_t crc = 0);
+
+#endif
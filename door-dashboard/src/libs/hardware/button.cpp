@@ -2,10 +2,6 @@
 
 #include "button.h"
 
-// During tests, the fastest a button is toggled by a human is 48ms
-// Bouncing happens in 0 to 1 ms...
-// Rare triggers happen in 16ms: human or bouncing?!
-const unsigned long DEBOUNCE_DELAY_MS = 20;
 const unsigned long MULTI_PRESS_MAX_GAP_MS = 600;
 
 Button::Button(uint8_t pin, ButtonResistor resistor)
@@ -19,9 +15,8 @@ void Button::setup()
   pinMode(pin, resistor == INTERNAL_PULL_UP_RESISTOR ? INPUT_PULLUP : INPUT);
 
   // Initialize state, in case it's pressed at startup (but don't emit callbacks)
-  pressed = digitalRead(pin) == pressedState();
-  pressedAtLastRead = pressed;
-  lastDebounceTime = millis();
+  input = InputBank::add(pin);
+  pressed = InputBank::read(input) == pressedState();
 }
 
 void Button::setOnChange(void (*callback)(bool))
@@ -45,39 +40,34 @@ void Button::setOnMultiPress(void (*callback)(unsigned int pressCount))
   onMultiPressCallback = callback;
 }
 
-void Button::loop()
+void Button::loop(const Timestamp now)
 {
-  const bool currentlyPressed = digitalRead(pin) == pressedState();
+  // Already debounced by the InputBank
+  const bool currentlyPressed = InputBank::read(input) == pressedState();
 
-  // check to see if you just pressed the button,
-  // and you've waited long enough
-  // since the last press to ignore any noise:
-
-  // If the switch changed, due to noise or pressing:
-  if (currentlyPressed != pressedAtLastRead) {
-    // reset the debouncing timer
-    lastDebounceTime = millis();
-  }
-
-  // The current reading has been stable for long enough to be considered bouncing-free by now:
-  if ((millis() - lastDebounceTime) > DEBOUNCE_DELAY_MS) {
-    // Update & emit new state if the button state has changed after debouncing
-    if (currentlyPressed != pressed) {
-      pressed = currentlyPressed;
-      handlePressChange();
-    }
+  // Update & emit new state if the button state has changed
+  if (currentlyPressed != pressed) {
+    pressed = currentlyPressed;
+    handlePressChange(now);
   }
 
-  pressedAtLastRead = currentlyPressed;
-
-  if (onLongPressCallback != nullptr && longPressNextTriggerTime > 0 && millis() >= longPressNextTriggerTime) {
+  if (onLongPressCallback != nullptr && longPressTriggerScheduled && !isBefore(now, longPressNextTriggerTime)) {
     longPressNextRepeatNumber++;
-    longPressNextTriggerTime = millis() + longPressPeriod;
+    longPressNextTriggerTime = now + longPressPeriod;
     onLongPressCallback(longPressNextRepeatNumber);
   }
 }
 
-void Button::handlePressChange()
+Timestamp Button::nextDeadline() const
+{
+  if (onLongPressCallback != nullptr && longPressTriggerScheduled) {
+    return deadlineAt(longPressNextTriggerTime);
+  }
+
+  return NO_DEADLINE;
+}
+
+void Button::handlePressChange(const Timestamp now)
 {
   // Change
   if (onChangeCallback != nullptr) {
@@ -91,11 +81,12 @@ void Button::handlePressChange()
 
   // Long press
   longPressNextRepeatNumber = 0;
-  longPressNextTriggerTime = (pressed && longPressPeriod > 0 ? millis() + longPressPeriod : 0);
+  longPressTriggerScheduled = (pressed && longPressPeriod > 0);
+  longPressNextTriggerTime = now + longPressPeriod;
 
   // Multi-press
   if (pressed) {
-    if (millis() < multiPressNextTriggerTime) {
+    if (multiPressCount > 0 && (Timestamp) (now - lastPressTime) < MULTI_PRESS_MAX_GAP_MS) {
       multiPressCount++;
       if (onMultiPressCallback != nullptr) {
         onMultiPressCallback(multiPressCount);
@@ -103,10 +94,15 @@ void Button::handlePressChange()
     } else {
       multiPressCount = 1;
     }
-    multiPressNextTriggerTime = millis() + MULTI_PRESS_MAX_GAP_MS;
+    lastPressTime = now;
   }
 }
 
+uint8_t Button::getPin() const
+{
+  return pin;
+}
+
 bool Button::isPressed() const
 {
   return pressed;
@@ -3,6 +3,9 @@
 
 #include <Arduino.h>
 
+#include "input-bank.h"
+#include "../time/deadline.h"
+
 enum ButtonResistor {
   /**
    * Use the internal pull-up resistor built into the Atmega chip.
@@ -27,7 +30,7 @@ enum ButtonResistor {
 class Button {
   private:
     /**
-     * The input pin to read during setup and loop.
+     * The input pin to configure and register in the InputBank during setup.
      */
     const uint8_t pin;
 
@@ -37,19 +40,14 @@ class Button {
     const ButtonResistor resistor;
 
     /**
-     * The current known stable (validated after a debouncing duration) reading from the input pin.
-     */
-    bool pressed = false;
-
-    /**
-     * The very last reading from the input pin (during debouncing).
+     * The input pin, as registered in the InputBank that reads and debounces it.
      */
-    bool pressedAtLastRead = false;
+    BankedInput input;
 
     /**
-     * The last time the input pin was toggled (it resets the debouncing duration).
+     * The current known stable (debounced by the InputBank) reading from the input pin.
      */
-    unsigned long lastDebounceTime = 0;
+    bool pressed = false;
 
     /**
      * The state read from digitalRead() when the button is pressed:
@@ -64,12 +62,13 @@ class Button {
 
     unsigned long longPressPeriod = 0;
     unsigned long longPressNextRepeatNumber = 0;
-    unsigned long longPressNextTriggerTime = 0;
+    bool longPressTriggerScheduled = false;
+    Timestamp longPressNextTriggerTime = 0; // Irrelevant when longPressTriggerScheduled is false
 
     unsigned long multiPressCount = 0;
-    unsigned long multiPressNextTriggerTime = 0;
+    Timestamp lastPressTime = 0; // Irrelevant when multiPressCount is 0
 
-    void handlePressChange();
+    void handlePressChange(const Timestamp now);
 
   public:
     /**
@@ -119,9 +118,20 @@ class Button {
     void setOnMultiPress(void (*callback)(unsigned int pressCount));
 
     /**
-     * Ensure to run this function in the Arduino's loop() function, in order to correctly react to the button.
+     * Ensure to run this function in the Arduino's loop() function (after InputBank::loop()), in order to correctly react to the button.
+     */
+    void loop(const Timestamp now);
+
+    /**
+     * Returns the timestamp at which loop() will have something to do (next long-press repeat),
+     * or NO_DEADLINE if only a change of the input pin can give it some work (see InputBank::nextDeadline() for the debouncing).
+     */
+    Timestamp nextDeadline() const;
+
+    /**
+     * Returns the input pin of the button.
      */
-    void loop();
+    uint8_t getPin() const;
 
     /**
      * Returns true if the button is currently pressed.
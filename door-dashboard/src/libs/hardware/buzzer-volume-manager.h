@@ -70,6 +70,11 @@ class BuzzerVolumeManager
     {
       changeToStep((step == 0 ? stepCount : step) - 1);
     }
+
+    uint8_t getStep() const
+    {
+      return step;
+    }
 };
 
 const int BuzzerVolumeManager::EEPROM_ADDRESS = 1;
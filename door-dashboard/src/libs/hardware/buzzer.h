@@ -6,6 +6,8 @@
 #define USE_TONE_AC
 
 #include "buzzer-melody.h"
+#include "output-layer.h"
+#include "../time/deadline.h"
 
 #ifdef USE_TONE_AC
 enum BuzzerVolume {
@@ -39,11 +41,22 @@ class Buzzer {
 
     bool muted;
 
-    const BuzzerMelody *melody;
-    uint8_t currentNoteIndex; // Irrelevant when melody is nullptr
-    unsigned long nextNoteChangeTimestamp; // Irrelevant when melody is nullptr
+    struct Layer {
+      const BuzzerMelody *melody; // nullptr when the layer plays nothing
+      uint8_t currentNoteIndex; // Irrelevant when melody is nullptr
+      Timestamp nextNoteChangeTimestamp; // Irrelevant when melody is nullptr
+    };
 
-    void playCurrentNote();
+    /**
+     * Like the layers of Led: a melody of a lower layer keeps its pace, silently, while a higher layer plays,
+     * and is heard again from its current note when the higher one ends.
+     */
+    Layer layers[OUTPUT_LAYER_COUNT];
+
+    Layer *currentLayer();
+    const Layer *renderedLayer() const; // nullptr when no layer plays
+    void startMelody(Layer *layer, const BuzzerMelody *melody);
+    void render();
 
     void playNote(const unsigned int frequency);
     void playNothing();
@@ -59,7 +72,8 @@ class Buzzer {
     Buzzer(uint8_t pin);
 #endif
     void setup();
-    void loop();
+    void loop(const Timestamp now);
+    Timestamp nextDeadline() const;
     void play(const BuzzerMelody *melody);
     void playSynchronously(const BuzzerMelody *melody);
     void stop();
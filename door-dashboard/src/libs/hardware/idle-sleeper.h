@@ -0,0 +1,62 @@
+#ifndef IDLE_SLEEPER_H
+#define IDLE_SLEEPER_H
+
+#include <Arduino.h>
+
+#ifdef __AVR__
+#include <avr/sleep.h>
+#endif
+
+#include "input-bank.h"
+#include "../time/deadline.h"
+
+// Instead of busy-spinning loop() millions of times per hour while nothing is due for minutes,
+// put the microcontroller in idle sleep until the earliest deadline of all components, until an input pin changes, or until a byte is received on the serial port.
+// In idle sleep mode, timers keep running (millis(), toneAC() PWM...) and any interrupt wakes the CPU up:
+// the Timer0 tick (every millisecond), the serial port, or a pin change on an input registered in the InputBank.
+// Most of them only put the CPU back to sleep: sleep() returns only for the deadline, a captured edge, or a received byte.
+class IdleSleeper {
+  private:
+    static Timestamp wakeUpTimestamp;
+
+  public:
+    /**
+     * Register the deadline of a component (as returned by its nextDeadline() function) for the next call to sleep().
+     */
+    static void wakeUpAt(const Timestamp deadline)
+    {
+      wakeUpTimestamp = earliestDeadline(wakeUpTimestamp, deadline);
+    }
+
+    /**
+     * Sleep until the earliest deadline registered by wakeUpAt() since the last call, until an input pin of the InputBank changes,
+     * or until a byte is received on the serial port.
+     * Return immediately if the deadline is already reached, if the InputBank captured a change to handle right away, or if received bytes wait to be read.
+     */
+    static void sleep()
+    {
+#ifdef __AVR__
+      set_sleep_mode(SLEEP_MODE_IDLE);
+      while (wakeUpTimestamp == NO_DEADLINE || isBefore(millis(), wakeUpTimestamp)) {
+        noInterrupts();
+        if (InputBank::hasCapturedEdgesDue() || Serial.available() > 0) {
+          interrupts();
+          break;
+        }
+        sleep_enable();
+        interrupts(); // The instruction following sei is always executed before any interrupt: no wake-up can be missed
+        sleep_cpu();
+        sleep_disable();
+      }
+#elif defined(ARDUINO_ARCH_HOST)
+      // Simulated boards do not sleep: the simulation skips the time until the deadline (see host/shim/Arduino.h)
+      hostSleepUntil(InputBank::hasCapturedEdgesDue() || Serial.available() > 0 ? millis() : wakeUpTimestamp);
+#endif
+
+      wakeUpTimestamp = NO_DEADLINE;
+    }
+};
+
+Timestamp IdleSleeper::wakeUpTimestamp = NO_DEADLINE;
+
+#endif
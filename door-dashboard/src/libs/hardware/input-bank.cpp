@@ -0,0 +1,241 @@
+#include <Arduino.h>
+
+#include "input-bank.h"
+
+// During tests, the fastest a button is toggled by a human is 48ms
+// Bouncing happens in 0 to 1 ms...
+// Rare triggers happen in 16ms: human or bouncing?!
+// 4 samples 5ms apart: a new level is validated when stable for 15ms
+const unsigned long SAMPLE_PERIOD_MS = 5;
+
+// Each port with registered pins has its pin change interrupt (see the ISRs at the end):
+// the ports table must have room for all of them, so add() cannot run out of ports on the board
+#ifdef __AVR__
+#if defined(PCINT3_vect) || !defined(PCINT2_vect)
+#error "InputBank handles the 3 pin change interrupts of an ATmega328P: adapt INPUT_BANK_PORT_COUNT and the ISRs"
+#endif
+static_assert(INPUT_BANK_PORT_COUNT >= 3, "One port per pin change interrupt");
+#endif
+
+InputBank::Port InputBank::ports[INPUT_BANK_PORT_COUNT];
+uint8_t InputBank::portCount = 0;
+
+volatile InputBank::CapturedEdge InputBank::capturedEdges[CAPTURED_EDGE_BUFFER_SIZE];
+volatile uint8_t InputBank::capturedEdgesHead = 0;
+volatile uint8_t InputBank::capturedEdgesTail = 0;
+volatile unsigned int InputBank::droppedEdgeCount = 0;
+unsigned int InputBank::handledDroppedEdgeCount = 0;
+
+Timestamp InputBank::lastSampleTimestamp = 0;
+
+BankedInput InputBank::add(const uint8_t pin)
+{
+  volatile uint8_t *inputRegister = portInputRegister(digitalPinToPort(pin));
+  const uint8_t bitMask = digitalPinToBitMask(pin);
+
+  uint8_t portIndex = 0;
+  while (portIndex < portCount && ports[portIndex].inputRegister != inputRegister) {
+    portIndex++;
+  }
+
+  if (portIndex == INPUT_BANK_PORT_COUNT) {
+    Serial.println(F("Too many input ports")); // Checked at compile time on the board: only on another platform (e.g. the host)
+    return BankedInput { 0, 0 };
+  }
+
+  noInterrupts();
+
+  Port *port = &ports[portIndex];
+  if (portIndex == portCount) {
+    port->inputRegister = inputRegister;
+    portCount++;
+  }
+
+  const uint8_t level = *inputRegister & bitMask;
+  port->mask |= bitMask;
+  port->capturedLevels = (port->capturedLevels & ~bitMask) | level;
+  port->rawLevels = (port->rawLevels & ~bitMask) | level;
+  port->levels = (port->levels & ~bitMask) | level;
+
+#ifdef __AVR__
+  *digitalPinToPCMSK(pin) |= bit(digitalPinToPCMSKbit(pin));
+  PCIFR |= bit(digitalPinToPCICRbit(pin)); // Clear any pending interrupt
+  PCICR |= bit(digitalPinToPCICRbit(pin));
+#endif
+
+  interrupts();
+
+  return BankedInput { portIndex, bitMask };
+}
+
+void InputBank::captureEdges()
+{
+  const Timestamp now = millis();
+
+  for (uint8_t i = 0; i < portCount; i++) {
+    Port *port = &ports[i];
+
+    const uint8_t levels = *port->inputRegister & port->mask;
+    if (levels == port->capturedLevels) {
+      continue; // Another port changed, or a pin not registered in the bank
+    }
+
+    const uint8_t nextHead = (capturedEdgesHead + 1) & (CAPTURED_EDGE_BUFFER_SIZE - 1);
+    if (nextHead == capturedEdgesTail) {
+      droppedEdgeCount++;
+      port->capturedLevels = levels; // Lost, but seen: the next change (e.g. back to the previous levels) is still captured
+      continue;
+    }
+
+    volatile CapturedEdge *edge = &capturedEdges[capturedEdgesHead];
+    edge->timestamp = now;
+    edge->portIndex = i;
+    edge->levels = levels;
+    capturedEdgesHead = nextHead; // Publish the edge only once completely written
+    port->capturedLevels = levels;
+  }
+}
+
+bool InputBank::sample()
+{
+  bool toggled = false;
+
+  for (uint8_t i = 0; i < portCount; i++) {
+    Port *port = &ports[i];
+
+    // Count consecutive samples differing from the debounced level (from 0 to 3, then back to 0 when reaching 4),
+    // and reset the counters of the pins reading their debounced level again
+    const uint8_t changes = port->rawLevels ^ port->levels;
+    port->counterHighBits = (port->counterHighBits ^ port->counterLowBits) & changes;
+    port->counterLowBits = ~port->counterLowBits & changes;
+
+    // Counters back to 0 while their pin still differs: the new level was read 4 times in a row
+    const uint8_t toggles = changes & ~(port->counterLowBits | port->counterHighBits);
+    port->levels ^= toggles;
+    toggled |= (toggles != 0);
+  }
+
+  return toggled;
+}
+
+bool InputBank::isStable()
+{
+  for (uint8_t i = 0; i < portCount; i++) {
+    const Port *port = &ports[i];
+    if (((port->rawLevels ^ port->levels) | port->counterLowBits | port->counterHighBits) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void InputBank::loop(const Timestamp now)
+{
+  if (!hasCapturedEdges() && isStable()) {
+    lastSampleTimestamp = now - SAMPLE_PERIOD_MS; // Sample the next captured change right when it happened
+    return;
+  }
+
+  // Replay the samples that should have happened since the last call, with the levels captured at their time
+  while (!isBefore(now, lastSampleTimestamp + SAMPLE_PERIOD_MS)) {
+    const Timestamp sampleTimestamp = lastSampleTimestamp + SAMPLE_PERIOD_MS;
+
+    while (hasCapturedEdges() && !isAfter(capturedEdges[capturedEdgesTail].timestamp, sampleTimestamp)) {
+      const volatile CapturedEdge *edge = &capturedEdges[capturedEdgesTail];
+      ports[edge->portIndex].rawLevels = edge->levels;
+      capturedEdgesTail = (capturedEdgesTail + 1) & (CAPTURED_EDGE_BUFFER_SIZE - 1); // Free the slot only once completely read
+    }
+
+    if (!hasCapturedEdges()) {
+      const unsigned int dropped = getDroppedEdgeCount();
+      if (dropped != handledDroppedEdgeCount) {
+        // Some changes were lost: start again from the current levels
+        handledDroppedEdgeCount = dropped;
+        for (uint8_t i = 0; i < portCount; i++) {
+          ports[i].rawLevels = *ports[i].inputRegister & ports[i].mask;
+        }
+      }
+    }
+
+    const bool toggled = sample();
+    lastSampleTimestamp = sampleTimestamp;
+
+    if (toggled) {
+      return; // Let the buttons handle this change before replaying the next ones
+    }
+
+    if (isStable()) {
+      if (!hasCapturedEdges() || isAfter(capturedEdges[capturedEdgesTail].timestamp, now)) {
+        lastSampleTimestamp = now - SAMPLE_PERIOD_MS;
+        return;
+      }
+
+      // Nothing to debounce until the next captured change: skip the samples in between
+      lastSampleTimestamp = capturedEdges[capturedEdgesTail].timestamp - SAMPLE_PERIOD_MS;
+    }
+  }
+}
+
+Timestamp InputBank::nextDeadline()
+{
+  if (!isStable()) {
+    return deadlineAt(lastSampleTimestamp + SAMPLE_PERIOD_MS); // Also replaying the changes captured until then
+  }
+
+  if (hasCapturedEdges()) {
+    return deadlineAt(millis());
+  }
+
+  return NO_DEADLINE;
+}
+
+uint8_t InputBank::read(const BankedInput input)
+{
+  return (ports[input.portIndex].levels & input.bitMask) ? HIGH : LOW;
+}
+
+uint8_t InputBank::readNow(const BankedInput input)
+{
+  return (*ports[input.portIndex].inputRegister & input.bitMask) ? HIGH : LOW;
+}
+
+bool InputBank::hasCapturedEdges()
+{
+  return capturedEdgesTail != capturedEdgesHead;
+}
+
+bool InputBank::hasCapturedEdgesDue()
+{
+  return hasCapturedEdges() && isStable();
+}
+
+unsigned int InputBank::getDroppedEdgeCount()
+{
+  noInterrupts();
+  const unsigned int dropped = droppedEdgeCount;
+  interrupts();
+  return dropped;
+}
+
+#ifdef __AVR__
+#ifdef PCINT0_vect
+ISR(PCINT0_vect)
+{
+  InputBank::captureEdges();
+}
+#endif
+
+#ifdef PCINT1_vect
+ISR(PCINT1_vect)
+{
+  InputBank::captureEdges();
+}
+#endif
+
+#ifdef PCINT2_vect
+ISR(PCINT2_vect)
+{
+  InputBank::captureEdges();
+}
+#endif
+#endif
@@ -0,0 +1,128 @@
+#ifndef INPUT_BANK_H
+#define INPUT_BANK_H
+
+#include <Arduino.h>
+
+#include "../time/deadline.h"
+
+/**
+ * The maximum number of input ports with registered pins: an ATmega328P has 3 of them (B, C and D).
+ */
+const uint8_t INPUT_BANK_PORT_COUNT = 3;
+
+/**
+ * The number of input changes the pin change interrupts can capture before the next call to InputBank::loop().
+ * Must be a power of 2.
+ */
+const uint8_t CAPTURED_EDGE_BUFFER_SIZE = 16;
+
+/**
+ * A pin registered in the InputBank, to read its debounced level.
+ */
+struct BankedInput
+{
+  uint8_t portIndex;
+  uint8_t bitMask; // 0 if the pin could not be registered
+};
+
+/**
+ * Read and debounce all registered input pins (buttons, sensors...) at once.
+ *
+ * Pin change interrupts capture each change of the registered pins as it happens, with its timestamp,
+ * into a lock-free ring buffer (written by the interrupts only, read by loop() only).
+ * A long iteration of the Arduino's loop() function (e.g. a blocking melody) thus neither misses nor delays changes:
+ * loop() replays them at the time they happened, and a change is validated 15 ms after it happened, whatever the load.
+ *
+ * Instead of one digitalRead() per pin (with its pin-to-port lookup tables),
+ * interrupts read the whole input register (PINx) of each used port once,
+ * and vertical counters debounce the 8 pins of a port in parallel with a few bitwise operations:
+ * each pin has a 2-bit counter, bit-sliced across two bytes (the low bits of the 8 counters in one byte, the high bits in another).
+ * Levels are sampled every 5 ms: a pin changes its debounced level after 4 consecutive samples read the new level.
+ */
+class InputBank {
+  private:
+    struct Port {
+      volatile uint8_t *inputRegister;
+      uint8_t mask; // The registered pins of the port
+      uint8_t capturedLevels; // The last levels captured by the interrupts
+      uint8_t rawLevels; // The levels at the time of the last sample, bouncing included
+      uint8_t levels; // The debounced levels
+      uint8_t counterLowBits;
+      uint8_t counterHighBits;
+    };
+
+    struct CapturedEdge {
+      Timestamp timestamp;
+      uint8_t portIndex;
+      uint8_t levels;
+    };
+
+    static Port ports[INPUT_BANK_PORT_COUNT];
+    static uint8_t portCount;
+
+    static volatile CapturedEdge capturedEdges[CAPTURED_EDGE_BUFFER_SIZE];
+    static volatile uint8_t capturedEdgesHead; // Only written by the interrupts
+    static volatile uint8_t capturedEdgesTail; // Only written by loop()
+    static volatile unsigned int droppedEdgeCount;
+    static unsigned int handledDroppedEdgeCount;
+
+    static Timestamp lastSampleTimestamp;
+
+    static bool sample();
+    static bool isStable();
+
+  public:
+    /**
+     * Register an input pin (already configured with pinMode()) to debounce it from now on,
+     * and enable its pin change interrupt (that also wakes up the microcontroller from sleep).
+     * Its debounced level starts with its current level.
+     */
+    static BankedInput add(const uint8_t pin);
+
+    /**
+     * Ensure to run this function in the Arduino's loop() function, before the loop() functions of the buttons.
+     * It stops after each change of a debounced level, for the buttons to see all of them, even when replaying late changes.
+     */
+    static void loop(const Timestamp now);
+
+    /**
+     * Returns the timestamp of the next sample while an input is debouncing,
+     * or NO_DEADLINE if only a change of an input pin can give it some work.
+     */
+    static Timestamp nextDeadline();
+
+    /**
+     * Returns the debounced level of the input: HIGH or LOW, like digitalRead() would do without the bouncing.
+     */
+    static uint8_t read(const BankedInput input);
+
+    /**
+     * Returns the current level of the input, without debouncing (e.g. for the interrupt line of a chip): HIGH or LOW.
+     * Faster than digitalRead(): a single register read.
+     */
+    static uint8_t readNow(const BankedInput input);
+
+    /**
+     * True if input changes were captured since the last call to loop(): call it with interrupts disabled before going to sleep.
+     */
+    static bool hasCapturedEdges();
+
+    /**
+     * True if input changes were captured that loop() handles right away: while an input is debouncing,
+     * they are replayed by its next sample, at nextDeadline(). Call it with interrupts disabled before going to sleep.
+     */
+    static bool hasCapturedEdgesDue();
+
+    /**
+     * The number of input changes lost because the ring buffer was full (loop() did not run for too long).
+     * The debounced levels recover from the current levels of the pins when it happens.
+     */
+    static unsigned int getDroppedEdgeCount();
+
+    /**
+     * Only for internal usage purpose (called by pin change interrupts).
+     */
+    static void captureEdges();
+};
+
+#endif
@@ -10,31 +10,52 @@ Led::Led(uint8_t pin)
 void Led::setup()
 {
   pinMode(pin, OUTPUT);
-  digitalWrite(pin, lit ? HIGH : LOW);
+  render();
 }
 
-void Led::loop()
+void Led::loop(const Timestamp now)
 {
-  if (this->pattern == nullptr) {
-    return;
+  bool toggled = false;
+
+  for (uint8_t i = 0; i < OUTPUT_LAYER_COUNT; i++) {
+    Layer *layer = &layers[i];
+    if (layer->pattern == nullptr || !isAfter(now, layer->nextPatternToggleTimestamp)) {
+      continue;
+    }
+
+    layer->currentPatternIndex = (layer->currentPatternIndex + 1) % layer->pattern->count;
+    layer->nextPatternToggleTimestamp = now + layer->pattern->durations[layer->currentPatternIndex];
+
+    layer->lit = layer->currentPatternIndex % 2 == 0;
+    toggled = true;
   }
 
-  const unsigned long now = millis();
-  if (now > this->nextPatternToggleTimestamp) {
-    this->currentPatternIndex = (this->currentPatternIndex + 1) % this->pattern->count;
-    this->nextPatternToggleTimestamp = now + this->pattern->durations[this->currentPatternIndex];
+  if (toggled) {
+    render();
+  }
+}
+
+Timestamp Led::nextDeadline() const
+{
+  Timestamp deadline = NO_DEADLINE;
 
-    this->lit = this->currentPatternIndex % 2 == 0;
-    digitalWrite(pin, this->lit ? HIGH : LOW);
+  for (uint8_t i = 0; i < OUTPUT_LAYER_COUNT; i++) {
+    if (layers[i].pattern != nullptr) {
+      deadline = earliestDeadline(deadline, deadlineAt(layers[i].nextPatternToggleTimestamp + 1)); // loop() toggles strictly after the timestamp
+    }
   }
+
+  return deadline;
 }
 
 void Led::set(bool lit)
 {
-  this->pattern = nullptr;
+  Layer *layer = currentLayer();
+  layer->active = true;
+  layer->pattern = nullptr;
+  layer->lit = lit;
 
-  this->lit = lit;
-  digitalWrite(pin, lit ? HIGH : LOW);
+  render();
 }
 
 void Led::turnOn()
@@ -49,24 +70,62 @@ void Led::turnOff()
 
 void Led::blink(const LedPattern *pattern)
 {
-  if (this->pattern == pattern) {
+  Layer *layer = currentLayer();
+  if (layer->active && layer->pattern == pattern) {
     return;
   }
 
-  this->pattern = pattern;
+  layer->active = true;
+  layer->pattern = pattern;
 
   if (pattern->durations[0] == 0 && pattern->count > 1) {
-    this->currentPatternIndex = 1;
-    this->nextPatternToggleTimestamp = millis() + pattern->durations[1];
-    digitalWrite(pin, LOW);
+    layer->currentPatternIndex = 1;
+    layer->nextPatternToggleTimestamp = millis() + pattern->durations[1];
+    layer->lit = false;
   } else {
-    this->currentPatternIndex = 0;
-    this->nextPatternToggleTimestamp = millis() + pattern->durations[0];
-    digitalWrite(pin, HIGH);
+    layer->currentPatternIndex = 0;
+    layer->nextPatternToggleTimestamp = millis() + pattern->durations[0];
+    layer->lit = true;
   }
+
+  render();
+}
+
+void Led::release()
+{
+  if (OutputLayer::getCurrent() == BASE_OUTPUT_LAYER) {
+    turnOff();
+    return;
+  }
+
+  Layer *layer = currentLayer();
+  layer->active = false;
+  layer->pattern = nullptr;
+
+  render();
 }
 
 bool Led::isLit()
 {
-  return lit;
+  return renderedLayer()->lit;
+}
+
+Led::Layer *Led::currentLayer()
+{
+  return &layers[OutputLayer::getCurrent()];
+}
+
+const Led::Layer *Led::renderedLayer() const
+{
+  for (uint8_t i = OUTPUT_LAYER_COUNT - 1; i > BASE_OUTPUT_LAYER; i--) {
+    if (layers[i].active) {
+      return &layers[i];
+    }
+  }
+  return &layers[BASE_OUTPUT_LAYER];
+}
+
+void Led::render()
+{
+  digitalWrite(pin, renderedLayer()->lit ? HIGH : LOW);
 }
@@ -0,0 +1,49 @@
+#ifndef OUTPUT_LAYER_H
+#define OUTPUT_LAYER_H
+
+#include <Arduino.h>
+
+/**
+ * Outputs shared by several action tracks (LEDs, buzzer) keep one state per layer: the highest active layer is rendered,
+ * while lower layers keep running behind it (e.g. a blinking pattern keeps its pace) and reappear when it is released.
+ */
+const uint8_t OUTPUT_LAYER_COUNT = 2;
+
+/**
+ * The layer written by default, e.g. by the action chain reflecting the current state.
+ */
+const uint8_t BASE_OUTPUT_LAYER = 0;
+
+/**
+ * A layer with a higher priority, e.g. for short feedback animations displayed over the current state.
+ */
+const uint8_t OVERLAY_OUTPUT_LAYER = 1;
+
+/**
+ * Select the layer that outputs write to, until this object goes out of scope (then, the previous layer is selected again).
+ */
+class OutputLayer {
+  private:
+    static uint8_t current;
+
+    const uint8_t previous;
+
+  public:
+    OutputLayer(const uint8_t layer)
+      : previous(current)
+    {
+      current = layer;
+    }
+
+    ~OutputLayer()
+    {
+      current = previous;
+    }
+
+    static uint8_t getCurrent()
+    {
+      return current;
+    }
+};
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef RELAY_H
 #define RELAY_H
 
+#include "../time/deadline.h"
+
 class Relay {
   private:
     /**
@@ -8,7 +10,8 @@ class Relay {
      */
     const uint8_t pin;
 
-    unsigned long nextPowerOffTimestamp; // 0 if no power-off to do
+    bool powerOffScheduled = false;
+    Timestamp nextPowerOffTimestamp; // Irrelevant when powerOffScheduled is false
 
   public:
     Relay(uint8_t pin)
@@ -22,27 +25,37 @@ class Relay {
       powerOff();
     }
 
-    void loop()
+    void loop(const Timestamp now)
     {
-      if (nextPowerOffTimestamp != 0 && millis() > nextPowerOffTimestamp) {
+      if (powerOffScheduled && isAfter(now, nextPowerOffTimestamp)) {
         powerOff();
       }
     }
 
+    Timestamp nextDeadline() const
+    {
+      if (!powerOffScheduled) {
+        return NO_DEADLINE;
+      }
+
+      return deadlineAt(nextPowerOffTimestamp + 1); // loop() powers off strictly after the timestamp
+    }
+
     void powerOnDuring(unsigned long duration)
     {
       powerOn();
+      powerOffScheduled = true;
       nextPowerOffTimestamp = millis() + duration;
     }
 
     void powerOn() {
       digitalWrite(pin, HIGH);
-      nextPowerOffTimestamp = 0;
+      powerOffScheduled = false;
     }
 
     void powerOff() {
       digitalWrite(pin, LOW);
-      nextPowerOffTimestamp = 0;
+      powerOffScheduled = false;
     }
 };
 
@@ -5,45 +5,119 @@ const uint8_t KEEP_OPEN_BUTTON_ID = 1;
 const uint8_t OPEN_BUTTON_ID = 2;
 const uint8_t ACK_SUCCESSFUL_CLOSE_BUTTON_ID = 3;
 
+/**
+ * Queue of button presses waiting to be acknowledged by the other board.
+ * Pending presses are all sent together, and have consecutive event IDs (skipping 0),
+ * so the other board acknowledges them cumulatively, with the ID of the last press it handled.
+ * After a restart, presses are only sent once the first acknowledgement told which IDs the other board already handled:
+ * otherwise, they could reuse recent IDs, and be ignored as already handled.
+ */
 class RemoteButtonsSender {
   public:
+    static const uint8_t MAX_PENDING_EVENTS = 4;
+
     static void onButtonPressed(uint8_t buttonIndex)
     {
-      isSending = true;
-
-      currentEventId++;
-      if (currentEventId == 0) { // It did overflow
-        currentEventId++; // Never send eventId=0, because when receiving an ACK, 0 means no eventId to acknowledge
+      if (pendingEventCount == MAX_PENDING_EVENTS) {
+        dropFirstPendingEvents(1); // Disconnected for too long: keep the latest presses
       }
 
-      currentEventButtonIndex = buttonIndex;
+      lastEventId = nextEventId(lastEventId);
+
+      pendingButtonIndexes[(firstPendingIndex + pendingEventCount) % MAX_PENDING_EVENTS] = buttonIndex;
+      pendingEventCount++;
     }
 
+    /**
+     * Acknowledges the pending presses up to eventId included.
+     */
     static void ackEventId(uint8_t eventId)
     {
-      if (isSending && currentEventId == eventId) {
-        isSending = false;
+      if (!isSynchronized) {
+        // Number the presses made since the start after the last ID handled by the other board
+        lastEventId = eventId;
+        for (uint8_t i = 0; i < pendingEventCount; i++) {
+          lastEventId = nextEventId(lastEventId);
+        }
+        isSynchronized = true;
+        return;
+      }
+
+      uint8_t pendingEventId = getFirstPendingEventId();
+      for (uint8_t i = 0; i < pendingEventCount; i++) {
+        if (pendingEventId == eventId) {
+          dropFirstPendingEvents(i + 1);
+          return;
+        }
+        pendingEventId = nextEventId(pendingEventId);
+      }
+
+      if (pendingEventCount == 0) {
+        lastEventId = eventId; // Continue after the IDs known by the other board, even if this board restarted since then
       }
     }
 
-     static uint8_t getCurrentEventId()
-     {
-       return isSending ? currentEventId : 0;
-     }
+    static bool isWaitingForAck()
+    {
+      return pendingEventCount > 0;
+    }
 
-     static uint8_t getCurrentEventButtonIndex()
-     {
-       return isSending ? currentEventButtonIndex : 0;
-     }
+    /**
+     * The presses to send: none before the first acknowledgement since the start (only polls, to receive it).
+     */
+    static uint8_t getPendingEventCount()
+    {
+      return isSynchronized ? pendingEventCount : 0;
+    }
+
+    /**
+     * The next pending presses have the next IDs (see nextEventId()). 0 if no press is pending.
+     */
+    static uint8_t getFirstPendingEventId()
+    {
+      uint8_t eventId = lastEventId;
+      for (uint8_t i = 1; i < pendingEventCount; i++) {
+        eventId = previousEventId(eventId);
+      }
+      return pendingEventCount > 0 ? eventId : 0;
+    }
+
+    static uint8_t getPendingEventButtonIndex(uint8_t index)
+    {
+      return pendingButtonIndexes[(firstPendingIndex + index) % MAX_PENDING_EVENTS];
+    }
+
+    /**
+     * Never 0: when receiving an ACK, 0 means no eventId to acknowledge.
+     */
+    static uint8_t nextEventId(uint8_t eventId)
+    {
+      return eventId == 255 ? 1 : eventId + 1;
+    }
 
   private:
-    static bool isSending;
-    static uint8_t currentEventId;
-    static uint8_t currentEventButtonIndex;
+    static bool isSynchronized; // The IDs follow the ones known by the other board
+    static uint8_t lastEventId;
+    static uint8_t pendingButtonIndexes[MAX_PENDING_EVENTS]; // Circular buffer
+    static uint8_t firstPendingIndex;
+    static uint8_t pendingEventCount;
+
+    static uint8_t previousEventId(uint8_t eventId)
+    {
+      return eventId <= 1 ? 255 : eventId - 1;
+    }
+
+    static void dropFirstPendingEvents(uint8_t count)
+    {
+      firstPendingIndex = (firstPendingIndex + count) % MAX_PENDING_EVENTS;
+      pendingEventCount -= count;
+    }
 };
 
-bool RemoteButtonsSender::isSending = false;
-uint8_t RemoteButtonsSender::currentEventId = 0;
-uint8_t RemoteButtonsSender::currentEventButtonIndex = 0;
+bool RemoteButtonsSender::isSynchronized = false;
+uint8_t RemoteButtonsSender::lastEventId = 0;
+uint8_t RemoteButtonsSender::pendingButtonIndexes[MAX_PENDING_EVENTS];
+uint8_t RemoteButtonsSender::firstPendingIndex = 0;
+uint8_t RemoteButtonsSender::pendingEventCount = 0;
 
 #endif
@@ -1,6 +1,8 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include "../time/deadline.h"
+
 class Timer {
   private:
     const unsigned long duration;
@@ -8,13 +10,14 @@ class Timer {
 
     bool started;
     bool infinite;
-    unsigned long runAtTimestamp; // Irrelevant when started is false
+    Timestamp runAtTimestamp; // Irrelevant when started is false
 
     void start(bool infinite);
 
   public:
     Timer(unsigned long duration, void (*runTask)());
-    void loop();
+    void loop(const Timestamp now);
+    Timestamp nextDeadline() const;
     void startOnce();
     void startInfinite();
     void stop();
@@ -1,8 +1,60 @@
+#include <EEPROM.h>
+#include <stddef.h>
+
 #include "wireless.h"
 
-Wireless::Wireless(uint8_t cePin, uint8_t csnPin)
+#include "../checksum/crc8.h"
+
+// Without an IRQ line from the radio, its RX FIFO must be polled: do it often enough for replies to stay snappy
+const unsigned long RECEPTION_POLL_PERIOD_MS = 5;
+
+// Fall back to separate requests and replies after this many exchanges in a row without ACK payload, and try again later
+const uint8_t ACK_PAYLOAD_MAX_CONSECUTIVE_MISSES = 5;
+const unsigned long ACK_PAYLOAD_RETRY_DELAY_MS = 30000;
+
+// Authentication counters are saved to EEPROM once per block (EEPROM cells endure about 100,000 writes):
+// at worst every 22 minutes at 50 frames per second, and each restart skips up to a block of counters, out of 4 billions
+const uint32_t AUTHENTICATION_COUNTER_BLOCK = 65536;
+const uint32_t BLANK_EEPROM_COUNTER = 0xFFFFFFFF;
+
+// Time out after this many times the slowest recent gap without reception: enough for the other board to double its delay
+// (when the polling of the dashboard backs off), and for a few frames to be lost in a row on top
+const uint8_t ADAPTIVE_RECEPTION_TIMEOUT_MISSED_FRAMES = 8;
+// The slowest recent gap follows a longer gap right away, but a shorter one only over about this many receptions:
+// the bursts of losses of a bad link keep the timeout long, instead of letting it flap between two bursts
+const uint8_t ADAPTIVE_RECEPTION_TIMEOUT_DECAY_RECEPTIONS = 64;
+// Receptions before the pace is known, and the adaptive reception timeout applies
+const uint8_t ADAPTIVE_RECEPTION_TIMEOUT_MIN_GAPS = 8;
+
+// The radio can lock up, e.g. when relays switch nearby, until it is re-initialized or even power-cycled (see loop()):
+// check it regularly, on top of the checks at each send and reception
+const unsigned long RADIO_CHECK_PERIOD_MS = 1000;
+const uint8_t RADIO_MAX_CONSECUTIVE_SEND_FAILURES = 3; // Without ACK, a send only fails when the radio did not transmit
+const unsigned long RADIO_MAX_SILENCE_MS = 10000; // Longer than any polling delay of the dashboard: either the other board is off, or this radio stopped receiving
+// The delay before each initialization doubles while they do not bring receptions back, e.g. while the other board is off
+const unsigned long RADIO_RECOVERY_MIN_DELAY_MS = 100;
+const unsigned long RADIO_RECOVERY_MAX_DELAY_MS = 60000;
+// With a power pin: long enough for the decoupling capacitor of the module to discharge, then the power on reset of the NRF24L01+ (100 ms in its datasheet)
+const unsigned long RADIO_POWER_OFF_DURATION_MS = 50;
+const unsigned long RADIO_POWER_ON_RESET_MS = 100;
+
+// NRF24L01+ registers and SPI commands, to read back the configuration of the radio and manage its TX FIFO (with the same SPI settings as NRFLite)
+const uint32_t NRF24_SPI_CLOCK = 4000000;
+const uint8_t NRF24_R_REGISTER = 0x00;
+const uint8_t NRF24_FLUSH_TX = 0xE1;
+const uint8_t NRF24_NOP = 0xFF;
+const uint8_t NRF24_RF_CH = 0x05;
+const uint8_t NRF24_FIFO_STATUS = 0x17;
+const uint8_t NRF24_FIFO_STATUS_TX_EMPTY = 0x10;
+
+// Around the polling delays of the dashboard
+const uint16_t LINK_GAP_HISTOGRAM_UPPER_BOUNDS_MS[LINK_GAP_HISTOGRAM_SIZE - 1] PROGMEM = { 25, 50, 100, 200, 500, 1000, 2000 };
+
+Wireless::Wireless(uint8_t cePin, uint8_t csnPin, uint8_t irqPin, uint8_t powerPin)
   : cePin(cePin)
   , csnPin(csnPin)
+  , irqPin(irqPin)
+  , powerPin(powerPin)
 {
 }
 
@@ -13,26 +65,74 @@ void Wireless::setup(
   const uint8_t channel // Sending&receiving channel, can fill 0~128, send and receive must be consistent
 )
 {
+  const Timestamp now = millis();
+
+  _radioId = radioId;
   _destinationRadioId = destinationRadioId;
+  _channel = channel;
+  linkQuality.lastReceptionTimestamp = now;
 
-  // About 5ms to send a message (more if there are retries, but we disabled them)
-  // 250KBPS is twice slower than both 1MBPS and 2MBPS, and we do not need the more power-hungry 2MBPS
-  if (!_radio.init(radioId, cePin, csnPin, NRFLite::BITRATE1MBPS, channel)) {
-    Serial.println("Cannot communicate with radio");
-    while (1);
+  if (hasPowerPin()) {
+    pinMode(powerPin, OUTPUT);
+    digitalWrite(powerPin, HIGH);
+  }
+
+  radioRecoveryDelay = RADIO_RECOVERY_MIN_DELAY_MS;
+  if (!initRadio(now)) {
+    Serial.println(F("Cannot communicate with radio: retrying in the background"));
+    startRadioRecovery(now);
+  }
+
+  if (hasIrqPin()) {
+    pinMode(irqPin, INPUT); // Driven by the radio: active low
+    irqInput = InputBank::add(irqPin); // Its changes wake up the microcontroller
   }
 }
 
-void Wireless::loop()
+void Wireless::loop(const Timestamp now)
 {
+  if (hasReceptionGrace && isAfter(now, receptionGraceEndTimestamp)) {
+    hasReceptionGrace = false; // Not compared anymore, as it would look in the future again after 24.8 days
+  }
+
   if (!isInReceptionTimeout &&
-      receptionTimeoutCallback != nullptr &&
-      receptionTimeout != 0 &&
-      millis() > nextReceptionTimeoutTimestamp
+      isReceptionTimeoutEnabled() &&
+      isAfter(now, receptionTimeoutTimestamp())
   ) {
     isInReceptionTimeout = true;
     receptionTimeoutCallback(isInReceptionTimeout);
   }
+
+  if (isInRadioRecovery) {
+    loopRadioRecovery(now);
+  } else if (!isBefore(now, nextRadioCheckTimestamp)) {
+    nextRadioCheckTimestamp = now + RADIO_CHECK_PERIOD_MS;
+    if (isRadioLockedUp(now)) {
+      counters.radioLockupCount++;
+      startRadioRecovery(now);
+    }
+  }
+}
+
+Timestamp Wireless::nextDeadline() const
+{
+  Timestamp deadline = NO_DEADLINE;
+  if (isInRadioRecovery) {
+    deadline = deadlineAt(radioRecoveryStepTimestamp); // Nothing to poll until the radio is back
+  } else {
+    deadline = deadlineAt(nextRadioCheckTimestamp);
+    if (!hasIrqPin()) {
+      deadline = earliestDeadline(deadline, deadlineAt(millis() + RECEPTION_POLL_PERIOD_MS));
+    } else if (isIrqAsserted()) {
+      deadline = deadlineAt(millis()); // Received data is waiting to be read
+    }
+  }
+
+  if (!isInReceptionTimeout && isReceptionTimeoutEnabled()) {
+    deadline = earliestDeadline(deadline, deadlineAt(receptionTimeoutTimestamp() + 1)); // loop() times out strictly after the timestamp
+  }
+
+  return deadline;
 }
 
 bool Wireless::send(byte *payload, uint8_t size)
@@ -42,27 +142,550 @@ bool Wireless::send(byte *payload, uint8_t size)
   // See https://arduino.stackexchange.com/questions/55042/how-to-automatically-reset-the-nrf24l01-with-code
   const NRFLite::SendType noAck = NRFLite::NO_ACK;
 
-  return _radio.send(_destinationRadioId, payload, size, noAck);
+  if (isInRadioRecovery) {
+    return false;
+  }
+
+  byte frame[32];
+  const uint8_t frameSize = makeFrame(frame, payload, size);
+
+  const bool sent = _radio.send(_destinationRadioId, frame, frameSize, noAck);
+  if (sent) {
+    consecutiveSendFailures = 0;
+  } else if (consecutiveSendFailures < RADIO_MAX_CONSECUTIVE_SEND_FAILURES) {
+    consecutiveSendFailures++; // Checked by loop()
+  }
+  return sent;
 }
 
 bool Wireless::receive(void (*receiveCallback)(byte *payload, uint8_t size))
 {
+    if (isInRadioRecovery) {
+      return false;
+    }
+
+    if (hasIrqPin()) {
+      if (!isIrqAsserted()) {
+        return false; // Nothing received: no need to ask the radio over SPI
+      }
+      counters.irqCount++;
+    }
+
     bool received = false;
     uint8_t size;
 
     while ((size = _radio.hasData())) {
         byte bytes[32];
         _radio.readData(bytes);
+        counters.readCount++;
+
+        const uint8_t payloadSize = acceptFrame(bytes, size);
+        if (payloadSize > 0) {
+          receiveCallback(bytes, payloadSize);
+
+          resetReceptionTimeout();
+          received = true;
+        }
+    }
 
-        receiveCallback(bytes, size);
+    if (!received) {
+      counters.emptyPollCount++;
 
-        resetReceptionTimeout();
-        received = true;
+      if (hasIrqPin()) {
+        // The IRQ line was asserted for another reason (e.g. end of a transmission): clear all the radio flags to release it
+        uint8_t txOk, txFail, rxReady;
+        _radio.whatHappened(txOk, txFail, rxReady);
+      }
     }
 
     return received;
 }
 
+bool Wireless::sendForAckPayload(byte *payload, uint8_t size, void (*ackPayloadCallback)(byte *payload, uint8_t size))
+{
+  if (isInRadioRecovery) {
+    return false;
+  }
+
+  // NRFLite flushes the payload if it was not acknowledged after the automatic retries
+  byte frame[32];
+  const uint8_t frameSize = makeFrame(frame, payload, size);
+  const bool acknowledged = _radio.send(_destinationRadioId, frame, frameSize, NRFLite::REQUIRE_ACK);
+
+  bool received = false;
+  uint8_t ackPayloadSize;
+
+  while (acknowledged && (ackPayloadSize = _radio.hasAckData())) {
+    byte bytes[32];
+    _radio.readData(bytes);
+
+    const uint8_t payloadSize = acceptFrame(bytes, ackPayloadSize);
+    if (payloadSize > 0) {
+      counters.ackPayloadCount++;
+      ackPayloadCallback(bytes, payloadSize);
+
+      resetReceptionTimeout();
+      received = true;
+    }
+  }
+
+  if (received) {
+    consecutiveAckPayloadMisses = 0;
+  } else {
+    counters.ackPayloadMissCount++;
+    if (consecutiveAckPayloadMisses < ACK_PAYLOAD_MAX_CONSECUTIVE_MISSES) {
+      consecutiveAckPayloadMisses++;
+    }
+    if (consecutiveAckPayloadMisses == ACK_PAYLOAD_MAX_CONSECUTIVE_MISSES) {
+      ackPayloadFallbackTimestamp = millis();
+    }
+  }
+
+  return received;
+}
+
+bool Wireless::canSendForAckPayload()
+{
+  if (consecutiveAckPayloadMisses < ACK_PAYLOAD_MAX_CONSECUTIVE_MISSES) {
+    return true;
+  }
+
+  if (elapsedSince(ackPayloadFallbackTimestamp) >= ACK_PAYLOAD_RETRY_DELAY_MS) {
+    consecutiveAckPayloadMisses = ACK_PAYLOAD_MAX_CONSECUTIVE_MISSES - 1; // One more miss to fall back again
+    return true;
+  }
+
+  return false;
+}
+
+void Wireless::setAckPayload(byte *payload, uint8_t size)
+{
+  // Only one reply at a time in the TX FIFO: if the previous one was not sent yet, it is outdated
+  const uint8_t removeExistingAcks = 1;
+  if (isInRadioRecovery) {
+    return; // Lost with the re-initialization anyway: the other board gets the next reply
+  }
+
+  byte frame[32];
+  const uint8_t frameSize = makeFrame(frame, payload, size);
+  _radio.addAckData(frame, frameSize, removeExistingAcks);
+  hasPendingAckPayload = true;
+}
+
+uint8_t Wireless::makeFrame(byte *frame, const byte *payload, uint8_t size)
+{
+  if (size > MAX_PAYLOAD_SIZE) {
+    size = MAX_PAYLOAD_SIZE; // Truncated: the receiver will reject it as a payload of an unexpected size
+  }
+
+  reclaimUnsentAckPayload(); // Replaced by this frame, or sent after it
+
+  memcpy(frame, payload, size);
+  if (isAuthenticated) {
+    size = authenticate(frame, size);
+  }
+  frame[size] = nextSentSequence++;
+  frame[size + 1] = crc8(frame, size + 1);
+  linkQuality.sentFrameCount++;
+
+  return size + FRAME_OVERHEAD;
+}
+
+/**
+ * If the ACK payload preloaded by setAckPayload() is still in the TX FIFO, no frame received since took it:
+ * remove it, and give its sequence number and counter back to the next frame.
+ * Otherwise the other radio would count its sequence number as a lost frame, or receive it later than newer frames,
+ * out of order (and rejected as replayed when authenticated).
+ */
+void Wireless::reclaimUnsentAckPayload()
+{
+  if (!hasPendingAckPayload) {
+    return;
+  }
+  hasPendingAckPayload = false;
+
+  if (readRadioRegister(NRF24_FIFO_STATUS) & NRF24_FIFO_STATUS_TX_EMPTY) {
+    return; // Sent in the ACK of a received frame
+  }
+  // A frame received between the read and the flush (a few microseconds) would still take it:
+  // the next frame would then be rejected as a duplicate, and the one after gets through
+  sendRadioCommand(NRF24_FLUSH_TX);
+
+  nextSentSequence--;
+  if (isAuthenticated) {
+    lastSentCounter--;
+  }
+  linkQuality.sentFrameCount--;
+}
+
+uint8_t Wireless::acceptFrame(const byte *frame, uint8_t frameSize)
+{
+  const uint8_t overhead = FRAME_OVERHEAD + (isAuthenticated ? AUTHENTICATION_OVERHEAD : 0);
+  if (frameSize <= overhead || crc8(frame, frameSize - 1) != frame[frameSize - 1]) {
+    counters.rejectedFrameCount++;
+    return 0;
+  }
+  const uint8_t payloadSize = frameSize - overhead;
+
+  if (isAuthenticated && !isAuthentic(frame, payloadSize)) {
+    counters.unauthenticatedFrameCount++;
+    return 0;
+  }
+
+  const uint8_t sequence = frame[frameSize - 2];
+  if (hasReceivedSequence) {
+    const int8_t sequenceDelta = (int8_t) (sequence - lastReceivedSequence); // Wraps around like timestamps
+    if (sequenceDelta == 0) {
+      counters.duplicateFrameCount++;
+      return 0;
+    }
+    if (sequenceDelta < 0) {
+      counters.outOfOrderFrameCount++; // Still accepted: most likely, the other board restarted and its sequence with it
+    }
+  }
+
+  if (isAuthenticated && isReplayed(frame, payloadSize)) {
+    counters.replayedFrameCount++;
+    return 0;
+  }
+
+  recordReception(sequence);
+  lastReceivedSequence = sequence;
+  hasReceivedSequence = true;
+  if (isAuthenticated) {
+    acceptCounter(frame, payloadSize);
+  }
+  return payloadSize;
+}
+
+void Wireless::enableAuthentication(const int eepromAddress)
+{
+  WirelessAuthenticationEeprom eeprom;
+  EEPROM.get(eepromAddress, eeprom);
+
+  if (eeprom.sentCounterReservation == BLANK_EEPROM_COUNTER) {
+    Serial.println(F("No wireless authentication key in EEPROM: anybody can send commands"));
+    return;
+  }
+
+  isAuthenticated = true;
+  authenticationEepromAddress = eepromAddress;
+  memcpy(authenticationKey, eeprom.key, SIPHASH_KEY_SIZE);
+
+  // Counters up to the reservation may have been sent before the restart
+  lastSentCounter = eeprom.sentCounterReservation;
+  sentCounterReservation = eeprom.sentCounterReservation + AUTHENTICATION_COUNTER_BLOCK;
+  EEPROM.put(eepromAddress + offsetof(WirelessAuthenticationEeprom, sentCounterReservation), sentCounterReservation);
+
+  lastReceivedCounter = eeprom.receivedCounterFloor;
+  receivedCounterFloor = eeprom.receivedCounterFloor;
+}
+
+void Wireless::provisionAuthenticationKey(const int eepromAddress, const uint8_t key[SIPHASH_KEY_SIZE])
+{
+  WirelessAuthenticationEeprom eeprom;
+  memcpy(eeprom.key, key, SIPHASH_KEY_SIZE);
+  eeprom.sentCounterReservation = 0;
+  eeprom.receivedCounterFloor = 0;
+  EEPROM.put(eepromAddress, eeprom);
+}
+
+// Counters and tags are copied as is: both boards are little-endian
+uint8_t Wireless::authenticate(byte *frame, uint8_t payloadSize)
+{
+  lastSentCounter++;
+  if (lastSentCounter > sentCounterReservation) {
+    sentCounterReservation += AUTHENTICATION_COUNTER_BLOCK;
+    EEPROM.put(authenticationEepromAddress + offsetof(WirelessAuthenticationEeprom, sentCounterReservation), sentCounterReservation);
+  }
+  memcpy(&frame[payloadSize], &lastSentCounter, sizeof(lastSentCounter));
+  frame[payloadSize + sizeof(lastSentCounter)] = _radioId; // Authenticated, then replaced by the tag
+
+  const uint32_t tag = siphash24(authenticationKey, frame, payloadSize + sizeof(lastSentCounter) + 1); // Truncated to 32 bits
+  memcpy(&frame[payloadSize + sizeof(lastSentCounter)], &tag, sizeof(tag));
+
+  return payloadSize + AUTHENTICATION_OVERHEAD;
+}
+
+bool Wireless::isAuthentic(const byte *frame, uint8_t payloadSize)
+{
+  // Sent by the destination radio: authenticated with its ID, like by authenticate() on its side
+  byte authenticated[MAX_PAYLOAD_SIZE + sizeof(uint32_t) + 1];
+  memcpy(authenticated, frame, payloadSize + sizeof(uint32_t));
+  authenticated[payloadSize + sizeof(uint32_t)] = _destinationRadioId;
+  const uint32_t expectedTag = siphash24(authenticationKey, authenticated, payloadSize + sizeof(uint32_t) + 1);
+
+  uint32_t tag;
+  memcpy(&tag, &frame[payloadSize + sizeof(uint32_t)], sizeof(tag));
+
+  return tag == expectedTag;
+}
+
+bool Wireless::isReplayed(const byte *frame, uint8_t payloadSize)
+{
+  uint32_t counter;
+  memcpy(&counter, &frame[payloadSize], sizeof(counter));
+
+  return counter <= lastReceivedCounter;
+}
+
+void Wireless::acceptCounter(const byte *frame, uint8_t payloadSize)
+{
+  memcpy(&lastReceivedCounter, &frame[payloadSize], sizeof(lastReceivedCounter));
+
+  // After a restart, only the counters received since the last save could be replayed
+  if (lastReceivedCounter - receivedCounterFloor >= AUTHENTICATION_COUNTER_BLOCK) {
+    receivedCounterFloor = lastReceivedCounter;
+    EEPROM.put(authenticationEepromAddress + offsetof(WirelessAuthenticationEeprom, receivedCounterFloor), receivedCounterFloor);
+  }
+}
+
+const WirelessCounters *Wireless::getCounters() const
+{
+  return &counters;
+}
+
+void Wireless::recordReception(const uint8_t sequence)
+{
+  const Timestamp now = millis();
+
+  if (linkQuality.receivedFrameCount > 0) {
+    const unsigned long gap = now - linkQuality.lastReceptionTimestamp;
+    if (gap > linkQuality.maxGapMs) {
+      linkQuality.maxGapMs = gap;
+    }
+
+    uint8_t bucket = 0;
+    while (bucket < LINK_GAP_HISTOGRAM_SIZE - 1 && gap >= pgm_read_word(&LINK_GAP_HISTOGRAM_UPPER_BOUNDS_MS[bucket])) {
+      bucket++;
+    }
+    linkQuality.gapHistogram[bucket]++;
+  }
+  linkQuality.receivedFrameCount++;
+  linkQuality.lastReceptionTimestamp = now;
+
+  if (hasReceivedSequence && !isInReceptionTimeout && !hasReceptionGrace) { // A silence reported or expected is not the pace of the other board
+    const uint16_t gap = min(now - lastReceptionTimestamp, 0xFFFFUL);
+    if (gap >= slowestRecentGapMs) {
+      slowestRecentGapMs = gap;
+    } else {
+      slowestRecentGapMs -= (slowestRecentGapMs - gap + ADAPTIVE_RECEPTION_TIMEOUT_DECAY_RECEPTIONS - 1) / ADAPTIVE_RECEPTION_TIMEOUT_DECAY_RECEPTIONS;
+    }
+    if (recentGapCount < ADAPTIVE_RECEPTION_TIMEOUT_MIN_GAPS) {
+      recentGapCount++;
+    }
+  }
+
+  int8_t sequenceDelta = hasReceivedSequence ? (int8_t) (sequence - lastReceivedSequence) : 1;
+  if (sequenceDelta <= 0) {
+    // The other board restarted: the frames before are not comparable
+    linkQuality.receptionWindow = 0;
+    linkQuality.receptionWindowSize = 0;
+    sequenceDelta = 1;
+  }
+  linkQuality.lostFrameCount += sequenceDelta - 1;
+
+  linkQuality.receptionWindow = (sequenceDelta >= LINK_LOSS_WINDOW_SIZE ? 0 : linkQuality.receptionWindow << sequenceDelta) | 1;
+  linkQuality.receptionWindowSize = min(linkQuality.receptionWindowSize + sequenceDelta, LINK_LOSS_WINDOW_SIZE);
+}
+
+const WirelessLinkQuality *Wireless::getLinkQuality() const
+{
+  return &linkQuality;
+}
+
+uint8_t Wireless::getLossRatePercent() const
+{
+  if (linkQuality.receptionWindowSize == 0) {
+    return 0;
+  }
+
+  const uint8_t receivedInWindow = __builtin_popcountl(linkQuality.receptionWindow);
+  return 100 * (linkQuality.receptionWindowSize - receivedInWindow) / linkQuality.receptionWindowSize;
+}
+
+unsigned long Wireless::timeSinceLastReception() const
+{
+  return elapsedSince(linkQuality.lastReceptionTimestamp);
+}
+
+void Wireless::resetLinkQuality()
+{
+  linkQuality = WirelessLinkQuality();
+  linkQuality.lastReceptionTimestamp = millis();
+}
+
+void Wireless::printLinkQuality() const
+{
+  Serial.println(F("Wireless link quality:"));
+
+  Serial.print(F("  sent frames: "));
+  Serial.print(linkQuality.sentFrameCount);
+  Serial.print(F(", received frames: "));
+  Serial.print(linkQuality.receivedFrameCount);
+  Serial.print(F(", lost frames: "));
+  Serial.println(linkQuality.lostFrameCount);
+
+  Serial.print(F("  loss rate: "));
+  Serial.print(getLossRatePercent());
+  Serial.print(F("% of the last "));
+  Serial.print(linkQuality.receptionWindowSize);
+  Serial.println(F(" frames"));
+
+  Serial.print(F("  last reception: "));
+  Serial.print(timeSinceLastReception());
+  Serial.print(F(" ms ago, max gap: "));
+  Serial.print(linkQuality.maxGapMs);
+  Serial.println(F(" ms"));
+
+  Serial.print(F("  gaps:"));
+  for (uint8_t bucket = 0; bucket < LINK_GAP_HISTOGRAM_SIZE; bucket++) {
+    Serial.print(bucket < LINK_GAP_HISTOGRAM_SIZE - 1 ? F(" <") : F(" >="));
+    Serial.print(pgm_read_word(&LINK_GAP_HISTOGRAM_UPPER_BOUNDS_MS[bucket < LINK_GAP_HISTOGRAM_SIZE - 1 ? bucket : bucket - 1]));
+    Serial.print(F("ms: "));
+    Serial.print(linkQuality.gapHistogram[bucket]);
+  }
+  Serial.println();
+
+  Serial.print(F("  counters: IRQs "));
+  Serial.print(counters.irqCount);
+  Serial.print(F(", reads "));
+  Serial.print(counters.readCount);
+  Serial.print(F(", empty polls "));
+  Serial.print(counters.emptyPollCount);
+  Serial.print(F(", ACK payloads "));
+  Serial.print(counters.ackPayloadCount);
+  Serial.print(F(", ACK payload misses "));
+  Serial.println(counters.ackPayloadMissCount);
+
+  Serial.print(F("  rejected frames: invalid "));
+  Serial.print(counters.rejectedFrameCount);
+  Serial.print(F(", duplicate "));
+  Serial.print(counters.duplicateFrameCount);
+  Serial.print(F(", out-of-order "));
+  Serial.print(counters.outOfOrderFrameCount);
+  Serial.print(F(", unauthenticated "));
+  Serial.print(counters.unauthenticatedFrameCount);
+  Serial.print(F(", replayed "));
+  Serial.println(counters.replayedFrameCount);
+
+  Serial.print(F("  radio lockups: "));
+  Serial.print(counters.radioLockupCount);
+  Serial.print(F(", failed initializations: "));
+  Serial.print(counters.radioInitFailureCount);
+  Serial.println(isInRadioRecovery ? F(" (recovering now)") : F(""));
+}
+
+bool Wireless::initRadio(const Timestamp now)
+{
+  lastRadioInitTimestamp = now;
+  nextRadioCheckTimestamp = now + RADIO_CHECK_PERIOD_MS;
+  consecutiveSendFailures = 0;
+  hasPendingAckPayload = false; // Flushed by the initialization: counted as lost if it was not sent, rather than reused if it was
+
+  // About 5ms to send a message (more if there are retries, but we disabled them)
+  // 250KBPS is twice slower than both 1MBPS and 2MBPS, and we do not need the more power-hungry 2MBPS
+  if (!_radio.init(_radioId, cePin, csnPin, NRFLite::BITRATE1MBPS, _channel)) {
+    counters.radioInitFailureCount++;
+    return false;
+  }
+  return true;
+}
+
+void Wireless::loopRadioRecovery(const Timestamp now)
+{
+  if (isBefore(now, radioRecoveryStepTimestamp)) {
+    return;
+  }
+
+  if (isRadioPoweredOff) {
+    digitalWrite(powerPin, HIGH);
+    isRadioPoweredOff = false;
+    radioRecoveryStepTimestamp = now + RADIO_POWER_ON_RESET_MS;
+    return;
+  }
+
+  if (!initRadio(now)) {
+    startRadioRecovery(now); // Retry later, power-cycling again
+    return;
+  }
+
+  isInRadioRecovery = false;
+  graceReceptionTimeout(getReceptionTimeout()); // Give the other board a full timeout to be heard again
+}
+
+bool Wireless::isRadioLockedUp(const Timestamp now)
+{
+  // A locked-up radio answers with all bits at 0 or 1, and a power glitch resets its configuration
+  if (readRadioRegister(NRF24_RF_CH) != _channel) {
+    return true;
+  }
+
+  if (consecutiveSendFailures >= RADIO_MAX_CONSECUTIVE_SEND_FAILURES) {
+    return true;
+  }
+
+  // Not counted from the last reception only: the silence must outlast the recovery delay since the last initialization too
+  return isInReceptionTimeout &&
+    elapsedSince(lastReceptionTimestamp) >= RADIO_MAX_SILENCE_MS &&
+    now - lastRadioInitTimestamp >= max(RADIO_MAX_SILENCE_MS, radioRecoveryDelay);
+}
+
+/**
+ * Initialize the radio again after the recovery delay, power-cycling it first if possible.
+ * The delay doubles at each recovery, until a reception shows that the radio works again (see resetReceptionTimeout()).
+ */
+void Wireless::startRadioRecovery(const Timestamp now)
+{
+  isInRadioRecovery = true;
+
+  Timestamp stepTimestamp = lastRadioInitTimestamp + radioRecoveryDelay;
+  if (isBefore(stepTimestamp, now)) {
+    stepTimestamp = now;
+  }
+  radioRecoveryDelay = min(2 * radioRecoveryDelay, RADIO_RECOVERY_MAX_DELAY_MS);
+
+  if (hasPowerPin()) {
+    if (isBefore(stepTimestamp, now + RADIO_POWER_OFF_DURATION_MS)) {
+      stepTimestamp = now + RADIO_POWER_OFF_DURATION_MS;
+    }
+    // Left high, CE and CSN would keep powering the radio through its protection diodes
+    digitalWrite(cePin, LOW);
+    digitalWrite(csnPin, LOW);
+    digitalWrite(powerPin, LOW);
+    isRadioPoweredOff = true;
+  }
+  radioRecoveryStepTimestamp = stepTimestamp;
+
+  graceReceptionTimeout(stepTimestamp - now + (hasPowerPin() ? RADIO_POWER_ON_RESET_MS : 0));
+}
+
+uint8_t Wireless::readRadioRegister(const uint8_t reg)
+{
+  SPI.beginTransaction(SPISettings(NRF24_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+  digitalWrite(csnPin, LOW);
+  SPI.transfer(NRF24_R_REGISTER | reg);
+  const uint8_t value = SPI.transfer(NRF24_NOP);
+  digitalWrite(csnPin, HIGH);
+  SPI.endTransaction();
+
+  return value;
+}
+
+void Wireless::sendRadioCommand(const uint8_t command)
+{
+  SPI.beginTransaction(SPISettings(NRF24_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+  digitalWrite(csnPin, LOW);
+  SPI.transfer(command);
+  digitalWrite(csnPin, HIGH);
+  SPI.endTransaction();
+}
+
+bool Wireless::inRadioRecovery() const
+{
+  return isInRadioRecovery;
+}
+
 void Wireless::enableReceptionTimeout(unsigned long receptionTimeout, void (*receptionTimeoutCallback)(bool))
 {
   this->receptionTimeout = receptionTimeout;
@@ -70,20 +693,79 @@ void Wireless::enableReceptionTimeout(unsigned long receptionTimeout, void (*rec
   resetReceptionTimeout();
 }
 
+void Wireless::enableAdaptiveReceptionTimeout(unsigned long receptionTimeout, unsigned long minReceptionTimeout, unsigned long maxReceptionTimeout, void (*receptionTimeoutCallback)(bool))
+{
+  this->minReceptionTimeout = minReceptionTimeout;
+  this->maxReceptionTimeout = maxReceptionTimeout;
+  enableReceptionTimeout(receptionTimeout, receptionTimeoutCallback);
+}
+
+void Wireless::setReceptionTimeout(unsigned long receptionTimeout)
+{
+  this->receptionTimeout = receptionTimeout;
+}
+
+unsigned long Wireless::getReceptionTimeout() const
+{
+  if (minReceptionTimeout == 0 || recentGapCount < ADAPTIVE_RECEPTION_TIMEOUT_MIN_GAPS) {
+    return receptionTimeout;
+  }
+
+  return constrain(ADAPTIVE_RECEPTION_TIMEOUT_MISSED_FRAMES * (unsigned long) slowestRecentGapMs, minReceptionTimeout, maxReceptionTimeout);
+}
+
+void Wireless::graceReceptionTimeout(unsigned long duration)
+{
+  const Timestamp graceEndTimestamp = millis() + duration;
+  if (!hasReceptionGrace || isAfter(graceEndTimestamp, receptionGraceEndTimestamp)) {
+    receptionGraceEndTimestamp = graceEndTimestamp;
+  }
+  hasReceptionGrace = true;
+}
+
 void Wireless::resetReceptionTimeout()
 {
-  if (isInReceptionTimeout &&
-      receptionTimeoutCallback != nullptr &&
-      receptionTimeout != 0
-  ) {
+  if (isInReceptionTimeout && isReceptionTimeoutEnabled()) {
     isInReceptionTimeout = false;
     receptionTimeoutCallback(isInReceptionTimeout);
   }
 
-  nextReceptionTimeoutTimestamp = millis() + receptionTimeout;
+  lastReceptionTimestamp = millis();
+  hasReceptionGrace = false; // Receptions are back
+  radioRecoveryDelay = RADIO_RECOVERY_MIN_DELAY_MS; // And so does the radio
+}
+
+bool Wireless::isReceptionTimeoutEnabled() const
+{
+  return receptionTimeoutCallback != nullptr && receptionTimeout != 0;
+}
+
+Timestamp Wireless::receptionTimeoutTimestamp() const
+{
+  const Timestamp timeoutTimestamp = lastReceptionTimestamp + getReceptionTimeout();
+
+  if (hasReceptionGrace && isAfter(receptionGraceEndTimestamp, timeoutTimestamp)) {
+    return receptionGraceEndTimestamp;
+  }
+  return timeoutTimestamp;
 }
 
 bool Wireless::inReceptionTimeout()
 {
   return isInReceptionTimeout;
 }
+
+bool Wireless::hasIrqPin() const
+{
+  return irqPin != NO_IRQ_PIN;
+}
+
+bool Wireless::hasPowerPin() const
+{
+  return powerPin != NO_POWER_PIN;
+}
+
+bool Wireless::isIrqAsserted() const
+{
+  return InputBank::readNow(irqInput) == LOW;
+}
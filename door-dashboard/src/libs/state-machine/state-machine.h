@@ -1,36 +1,51 @@
 #ifndef STATE_MACHINE_H
 #define STATE_MACHINE_H
 
-class State {
-  private:
-    State()
-    {
-    }
+#include <Arduino.h>
 
+/**
+ * States and events carry small integer IDs (0, 1, 2... in declaration order, usually from an enum),
+ * so that the new state for any (state, event) pair is a single load from a table computed at compile time.
+ */
+class State {
   public:
-    static const State ANY;
+    /**
+     * Use as the `from` ID of a transition to make it apply from any state.
+     */
+    static const uint8_t ANY_ID = 0xFE;
+
+    /**
+     * Only for internal usage purpose: marks the absence of a transition in a TransitionTable.
+     */
+    static const uint8_t NONE_ID = 0xFF;
 
+    const uint8_t id;
     void (*enter)();
 
-    State(void (*enter)())
-      : enter(enter)
+    State(const uint8_t id, void (*enter)())
+      : id(id)
+      , enter(enter)
     {
     }
 };
 
-const State State::ANY = State();
-
 struct Event
 {
+  const uint8_t id;
+
+  constexpr Event(const uint8_t id)
+    : id(id)
+  {
+  }
 };
 
 class Transition {
   public:
-    const State *from;
-    const Event *event;
-    const State *to;
+    const uint8_t from;
+    const uint8_t event;
+    const uint8_t to;
 
-    Transition(const State *from, const Event *event, const State *to)
+    constexpr Transition(const uint8_t from, const uint8_t event, const uint8_t to)
       : from(from)
       , event(event)
       , to(to)
@@ -38,32 +53,94 @@ class Transition {
     }
 };
 
-struct Transitions {
-  const unsigned int length;
-  const Transition **values;
+/**
+ * Dense lookup table of the new state ID for each (state ID, event ID) pair, or State::NONE_ID if there is no transition.
+ * An extra row, after the last state, is used while the machine is not started yet: only ANY transitions apply there.
+ * Build it at compile time with makeTransitionTable().
+ */
+template <uint8_t STATE_COUNT, uint8_t EVENT_COUNT>
+struct TransitionTable {
+  const uint8_t newStateIds[(STATE_COUNT + 1) * EVENT_COUNT];
 };
 
+// Compile-time helpers (C++11 constexpr functions are single expressions: loops are written as recursions)
+
+template <unsigned... INDEXES>
+struct IndexSequence {
+};
+
+template <unsigned COUNT, unsigned... INDEXES>
+struct MakeIndexSequence : MakeIndexSequence<COUNT - 1, COUNT - 1, INDEXES...> {
+};
+
+template <unsigned... INDEXES>
+struct MakeIndexSequence<0, INDEXES...> {
+  typedef IndexSequence<INDEXES...> type;
+};
+
+constexpr uint8_t findNewStateId(const Transition *transitions, unsigned length, uint8_t from, uint8_t event, unsigned i = 0)
+{
+  return i == length ? State::NONE_ID
+    : (transitions[i].event == event && (transitions[i].from == from || transitions[i].from == State::ANY_ID)) ? transitions[i].to
+    : findNewStateId(transitions, length, from, event, i + 1);
+}
+
+constexpr bool areConflicting(const Transition &transition1, const Transition &transition2)
+{
+  return transition1.event == transition2.event &&
+    (transition1.from == transition2.from || transition1.from == State::ANY_ID || transition2.from == State::ANY_ID);
+}
+
+constexpr bool hasConflictingTransitions(const Transition *transitions, unsigned length, unsigned i, unsigned j)
+{
+  return i == length ? false
+    : j == length ? hasConflictingTransitions(transitions, length, i + 1, i + 2)
+    : areConflicting(transitions[i], transitions[j]) || hasConflictingTransitions(transitions, length, i, j + 1);
+}
+
+/**
+ * True if two transitions start from the same state (or ANY state) on the same event: only one of them could ever run.
+ * Use it in a static_assert next to the transitions declaration.
+ */
+template <unsigned LENGTH>
+constexpr bool hasConflictingTransitions(const Transition (&transitions)[LENGTH])
+{
+  return hasConflictingTransitions(transitions, LENGTH, 0, 1);
+}
+
+template <uint8_t STATE_COUNT, uint8_t EVENT_COUNT, unsigned... INDEXES>
+constexpr TransitionTable<STATE_COUNT, EVENT_COUNT> makeTransitionTable(const Transition *transitions, unsigned length, IndexSequence<INDEXES...>)
+{
+  return TransitionTable<STATE_COUNT, EVENT_COUNT>{ {
+    findNewStateId(transitions, length, INDEXES / EVENT_COUNT, INDEXES % EVENT_COUNT)...
+  } };
+}
+
+/**
+ * Fold a list of transitions (including ANY transitions) into a dense TransitionTable, at compile time.
+ */
+template <uint8_t STATE_COUNT, uint8_t EVENT_COUNT, unsigned LENGTH>
+constexpr TransitionTable<STATE_COUNT, EVENT_COUNT> makeTransitionTable(const Transition (&transitions)[LENGTH])
+{
+  return makeTransitionTable<STATE_COUNT, EVENT_COUNT>(
+    transitions,
+    LENGTH,
+    typename MakeIndexSequence<(STATE_COUNT + 1) * EVENT_COUNT>::type());
+}
+
 class StateMachine {
   private:
-    const Transitions *transitions;
+    const State *const *states;
+    const uint8_t stateCount;
+
+    const uint8_t *newStateIds;
+    const uint8_t eventCount;
 
     const State *currentState = nullptr;
 
     const State *beforeLastState = nullptr;
     const State *lastState = nullptr;
 
-    const State *getNewStateFor(const Event *event)
-    {
-      for (unsigned int i = 0; i < transitions->length; i++) {
-        const Transition *transition = transitions->values[i];
-        if ((transition->from == currentState || transition->from == &State::ANY) && transition->event == event) {
-          return transition->to;
-        }
-      }
-
-      return nullptr;
-    }
-
     void enter(const State *state)
     {
       beforeLastState = lastState;
@@ -74,8 +151,17 @@ class StateMachine {
     }
 
   public:
-    StateMachine(const Transitions *transitions)
-      : transitions(transitions)
+    /**
+     * The states array must be ordered by state ID: state i is looked up at states[i].
+     * Its size must be the state count of the transitions table, or it does not compile.
+     * The order itself cannot be checked at compile time: the states are not constexpr (their enter functions are lambdas).
+     */
+    template <uint8_t STATE_COUNT, uint8_t EVENT_COUNT>
+    StateMachine(const State *const (&states)[STATE_COUNT], const TransitionTable<STATE_COUNT, EVENT_COUNT> *transitions)
+      : states(states)
+      , stateCount(STATE_COUNT)
+      , newStateIds(transitions->newStateIds)
+      , eventCount(EVENT_COUNT)
     {
     }
 
@@ -88,9 +174,10 @@ class StateMachine {
 
     void handleEvent(const Event *event)
     {
-      const State *newState = getNewStateFor(event);
-      if (newState != nullptr && newState != currentState) {
-        enter(newState);
+      const uint8_t row = (currentState == nullptr ? stateCount : currentState->id);
+      const uint8_t newStateId = newStateIds[row * eventCount + event->id];
+      if (newStateId != State::NONE_ID && states[newStateId] != currentState) {
+        enter(states[newStateId]);
       }
     }
 
@@ -0,0 +1,44 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <Arduino.h>
+
+/**
+ * A point in time, in milliseconds since startup, as returned by millis().
+ * See https://www.arduino.cc/reference/en/language/functions/time/millis/
+ * millis() "will overflow (go back to zero), after approximately" 49.71 days: never compare two timestamps with < or >,
+ * but with the functions below, that stay correct across the overflow as long as the two timestamps are less than 24.85 days apart.
+ * Adding a duration to a timestamp is fine: the sum overflows the same way as millis() does.
+ */
+typedef uint32_t Timestamp;
+
+// Components have a loop(now) function to run in the Arduino's loop() function:
+// sample millis() once at the beginning of each iteration and pass the same value to all of them,
+// so they all agree on the same instant, and millis() (that disables interrupts on AVR) is called only once.
+
+/**
+ * True if timestamp1 is strictly before timestamp2.
+ */
+inline bool isBefore(const Timestamp timestamp1, const Timestamp timestamp2)
+{
+  return (int32_t) (timestamp1 - timestamp2) < 0;
+}
+
+/**
+ * True if timestamp1 is strictly after timestamp2.
+ */
+inline bool isAfter(const Timestamp timestamp1, const Timestamp timestamp2)
+{
+  return (int32_t) (timestamp1 - timestamp2) > 0;
+}
+
+/**
+ * The duration elapsed since the given timestamp, that must be in the past.
+ * Unlike isBefore() and isAfter(), it stays correct for timestamps up to 49.71 days in the past.
+ */
+inline unsigned long elapsedSince(const Timestamp timestamp)
+{
+  return (Timestamp) ((Timestamp) millis() - timestamp);
+}
+
+#endif
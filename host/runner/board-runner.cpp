@@ -0,0 +1,174 @@
+// Runs sketches together on a computer, in virtual time, with their radios linked: to try them out, and to see what they print.
+// With --socket, runs them in real time, with their radios also linked to the ones of another board-runner
+// (e.g. the controller in one process, and the dashboard in another one).
+// usage: board-runner [--duration <ms>] [--eeprom-dir <dir>] [--trace-pins] [--link <from-id>:<to-id>:<conditions>]... [--seed <n>]
+//                     [--realtime] [--socket <local-path> <peer-path>] <sketch.so>...
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "host-board.h"
+#include "host-clock.h"
+#include "host-ether.h"
+#include "sketch-pins.h"
+
+const uint8_t MAX_BOARD_COUNT = 8;
+
+void printPinChange(HostBoard *board, uint8_t pin, uint8_t level, void *context)
+{
+  printf("[%10llu ms] %s: pin %u %s\n", (unsigned long long) HostClock::now(), board->getName(), pin, level ? "HIGH" : "LOW");
+}
+
+std::string boardName(const char *sketchLibraryPath)
+{
+  std::string name = sketchLibraryPath;
+  const size_t slash = name.rfind('/');
+  if (slash != std::string::npos) {
+    name = name.substr(slash + 1);
+  }
+  const size_t extension = name.rfind(".so");
+  return extension == std::string::npos ? name : name.substr(0, extension);
+}
+
+/**
+ * Parse "<from-id>:<to-id>:<conditions>", where an ID can be "*" for any radio.
+ */
+bool parseLink(const char *text, uint8_t *fromRadioId, uint8_t *toRadioId, HostLinkConditions *conditions)
+{
+  uint8_t *radioIds[] = { fromRadioId, toRadioId };
+  for (uint8_t *radioId : radioIds) {
+    char *end;
+    if (text[0] == '*') {
+      *radioId = HOST_ETHER_ANY_RADIO;
+      end = (char *) text + 1;
+    } else {
+      const unsigned long id = strtoul(text, &end, 10);
+      if (end == text || id >= HOST_ETHER_ANY_RADIO) {
+        return false;
+      }
+      *radioId = id;
+    }
+    if (*end != ':') {
+      return false;
+    }
+    text = end + 1;
+  }
+  return HostEther::parseLinkConditions(text, conditions);
+}
+
+/**
+ * Wait until the wall clock reaches the given time, receiving the frames of the peer meanwhile.
+ */
+void waitUntil(uint64_t wallTime)
+{
+  for (uint64_t now = HostClock::wallNow(); now < wallTime; now = HostClock::wallNow()) {
+    pollfd socketPoll = { HostEther::getSocket(), POLLIN, 0 };
+    if (poll(&socketPoll, socketPoll.fd < 0 ? 0 : 1, wallTime - now) > 0) {
+      HostEther::receiveFromPeer();
+    }
+  }
+}
+
+int usage(const char *program)
+{
+  fprintf(stderr, "usage: %s [--duration <ms>] [--eeprom-dir <dir>] [--trace-pins] [--link <from-id>:<to-id>:<conditions>]... [--seed <n>]\n"
+    "       [--realtime] [--socket <local-path> <peer-path>] <sketch.so>...\n"
+    "Link conditions are like latency=5ms,jitter=2ms,loss=0.1,duplication=0.01,corruption=0.001, and \"*\" is any radio ID.\n", program);
+  return 2;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long long duration = 10000;
+  const char *eepromDirectory = nullptr;
+  bool tracePins = false;
+  bool isRealTime = false;
+  const char *localSocketPath = nullptr;
+  const char *peerSocketPath = nullptr;
+  std::vector<const char *> sketchLibraryPaths;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+      duration = strtoull(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--eeprom-dir") == 0 && i + 1 < argc) {
+      eepromDirectory = argv[++i];
+    } else if (strcmp(argv[i], "--trace-pins") == 0) {
+      tracePins = true;
+    } else if (strcmp(argv[i], "--link") == 0 && i + 1 < argc) {
+      uint8_t fromRadioId, toRadioId;
+      HostLinkConditions conditions;
+      if (!parseLink(argv[++i], &fromRadioId, &toRadioId, &conditions)) {
+        fprintf(stderr, "Invalid link %s\n", argv[i]);
+        return usage(argv[0]);
+      }
+      HostEther::setLinkConditions(fromRadioId, toRadioId, conditions);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      HostEther::setRandomSeed(strtoull(argv[++i], nullptr, 10));
+    } else if (strcmp(argv[i], "--realtime") == 0) {
+      isRealTime = true;
+    } else if (strcmp(argv[i], "--socket") == 0 && i + 2 < argc) {
+      localSocketPath = argv[++i];
+      peerSocketPath = argv[++i];
+      isRealTime = true; // The peer runs in real time too
+    } else if (argv[i][0] == '-') {
+      return usage(argv[0]);
+    } else {
+      sketchLibraryPaths.push_back(argv[i]);
+    }
+  }
+  if (sketchLibraryPaths.empty() || sketchLibraryPaths.size() > MAX_BOARD_COUNT) {
+    return usage(argv[0]);
+  }
+
+  std::vector<HostBoard *> boards;
+  for (const char *path : sketchLibraryPaths) {
+    HostBoard *board = new HostBoard(boardName(path).c_str());
+    boards.push_back(board);
+
+    if (!board->load(path)) {
+      return 1;
+    }
+    if (eepromDirectory != nullptr && !board->setEepromFile((std::string(eepromDirectory) + "/" + board->getName() + ".eeprom").c_str())) {
+      return 1;
+    }
+    if (tracePins) {
+      board->setPinListener(&printPinChange, nullptr);
+    }
+
+    const SketchPins *sketchPins = findSketchPins(board->getName());
+    if (sketchPins != nullptr && sketchPins->radioIrqPin != NO_SKETCH_PIN) {
+      board->getRadio()->setIrqPin(sketchPins->radioIrqPin);
+    }
+  }
+
+  if (localSocketPath != nullptr && !HostEther::connect(localSocketPath, peerSocketPath)) {
+    return 1;
+  }
+
+  for (HostBoard *board : boards) {
+    board->setup();
+  }
+
+  // Without sleeping: each board runs its loop() once per millisecond (of the wall clock in real time)
+  const uint64_t startWallTime = HostClock::wallNow();
+  while (HostClock::now() < duration) {
+    for (HostBoard *board : boards) {
+      board->loop();
+    }
+    HostClock::advance(1);
+    if (isRealTime) {
+      waitUntil(startWallTime + HostClock::now());
+    }
+    HostEther::deliver();
+  }
+
+  for (HostBoard *board : boards) {
+    delete board;
+  }
+  HostEther::disconnect();
+  return 0;
+}
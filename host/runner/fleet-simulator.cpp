@@ -0,0 +1,707 @@
+// Runs a fleet of doors (a controller and a dashboard each) for each parameter set, in parallel on all cores, under randomized
+// door usage and radio conditions, and compares the distributions of what their users notice: latencies, false disconnections,
+// failed closings and false door sensor anomalies. Each parameter set is a directory with both sketches built with its timings
+// (see FLEET_PARAMETER_SETS in the Makefile); the doors of a pair number get the same random conditions in all sets.
+// usage: fleet-simulator [--pairs <n>] [--duration <time>] [--threads <n>] [--seed <n>] <parameter-set-dir>...
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "host-clock.h"
+#include "host-ether.h"
+#include "scenario.h"
+#include "simulation.h"
+#include "sketch-pins.h"
+
+const char *CONTROLLER_SKETCH = "door-controller.so";
+const char *DASHBOARD_SKETCH = "door-dashboard.so";
+const int CONTROLLER = 0; // Index of the boards in their Simulation
+const int DASHBOARD = 1;
+const uint8_t LOW = 0; // Pin levels
+const uint8_t HIGH = 1;
+
+// Door usage
+const double MEAN_CLOSED_DURATION_MS = 45 * 60000.0; // Between closing and the next opening
+const uint64_t MIN_CLOSED_DURATION_MS = 30000;
+const double CLOSED_BY_HAND_RATE = 0.45; // Of the openings: the others are closed from the dashboard (PRESSED_RATE), or left to close automatically
+const double PRESSED_RATE = 0.35;
+const uint64_t MIN_HOLD_DURATION_MS = 5000; // Before closing by hand or from the dashboard
+const uint64_t MAX_HOLD_DURATION_MS = 8 * 60000; // Less than the time the controller waits to close it (it would close it first)
+const uint64_t PRESS_DURATION_MS = 200;
+const uint64_t MAX_PRESS_TO_RELAY_MS = 10000; // Beyond, the press was not answered (e.g. ignored during a door sensor anomaly)
+const uint64_t MIN_AFTER_FAILURE_MS = 60000; // Until someone closes by hand the door the controller failed to close,
+                                             // or acknowledges a door sensor anomaly on the dashboard
+const uint64_t MAX_AFTER_FAILURE_MS = 10 * 60000;
+
+// The door and its sensors
+const uint64_t MIN_TRAVEL_MS = 14000; // Of a door: the closing was timed at 20 seconds
+const uint64_t MAX_TRAVEL_MS = 22000;
+const double SLOW_DOOR_RATE = 0.1; // Of the doors: up to MAX_SLOW_TRAVEL_MS
+const uint64_t MAX_SLOW_TRAVEL_MS = 30000;
+const uint64_t TRAVEL_JITTER_MS = 1000; // From a movement to another
+const double OBSTRUCTION_RATE = 0.02; // Of the closings: the door reverses halfway
+const uint64_t MAX_SENSOR_SKEW_MS = 300; // Between the switching of both sensors
+const double LATE_SENSOR_RATE = 0.1; // Of the switchings: up to MAX_LATE_SENSOR_SKEW_MS
+const uint64_t MAX_LATE_SENSOR_SKEW_MS = 1500;
+
+// Radio
+const double MAX_LOSS_RATE = 0.3; // Most links are good: the loss rate is MAX_LOSS_RATE * u² for u uniform in 0~1
+const double MEAN_DROP_INTERVAL_MS = 12 * 3600000.0; // Radio drops (e.g. interferences), from 5 seconds to 5 minutes
+const uint64_t MIN_DROP_DURATION_MS = 5000;
+const uint64_t MAX_DROP_DURATION_MS = 5 * 60000;
+const uint64_t DROP_GRACE_MS = 10000; // After the end of a drop, a disconnection is still expected
+const uint64_t STARTUP_MS = 30000; // Disconnections before are not counted: the boards did not hear from each other yet
+const uint64_t DISCONNECTED_LED_OFF_MS = 1000; // Longer than the pauses of its blinking: it turning on again is a new disconnection
+
+std::string directoryOf(const char *path)
+{
+  const char *slash = strrchr(path, '/');
+  return slash == nullptr ? "." : std::string(path, slash - path);
+}
+
+std::string baseName(const std::string &path)
+{
+  const size_t slash = path.find_last_of('/', path.size() > 1 ? path.size() - 2 : 0);
+  std::string name = (slash == std::string::npos ? path : path.substr(slash + 1));
+  if (!name.empty() && name.back() == '/') {
+    name.pop_back();
+  }
+  return name;
+}
+
+/**
+ * What happened to one door during its simulation.
+ */
+struct PairResult
+{
+  bool isRun = false;
+  std::vector<uint32_t> pressToRelayLatencies; // From pressing close on the dashboard to the controller powering the door
+  unsigned int unansweredPressCount = 0;
+  std::vector<uint32_t> doorToDashboardLatencies; // From the door opening to the dashboard showing it
+  unsigned int falseDisconnectionCount = 0; // Shown by either board, outside radio drops
+  unsigned int closingCount = 0;
+  unsigned int failedClosingCount = 0;
+  unsigned int falseAnomalyCount = 0; // The sensors always work: any anomaly is false
+  unsigned long dashboardSentCount = 0;
+};
+
+/**
+ * The door of a pair and the people using it, acting on the boards of a Simulation as it runs, at random.
+ * The door opener toggles at each pulse of the first relay (the second one is powered along): a moving door stops,
+ * and a stopped one moves in the opposite direction of its last movement.
+ */
+class FleetDoor {
+  public:
+    FleetDoor(Simulation *simulation, uint64_t seed, uint64_t duration, PairResult *result);
+
+    void start(); // Before running the simulation
+
+  private:
+    enum Action : uint8_t {
+      OPEN,
+      CLOSE_BY_HAND,
+      PRESS_CLOSE,
+      PRESS_ACK,
+      RELEASE_BUTTON,
+      SET_SENSOR,
+      MOTOR_REVERSE,
+      MOTOR_STOP,
+      DROP_START,
+      DROP_END
+    };
+
+    enum DoorState : uint8_t {
+      CLOSED,
+      STOPPED_OPEN,
+      CLOSING,
+      OPENING
+    };
+
+    struct Timer
+    {
+      FleetDoor *door;
+      Action action;
+      unsigned long tag; // The opening or the motor run it belongs to: ignored if another one started since
+      uint8_t pin;
+      uint8_t level;
+    };
+
+    struct Drop
+    {
+      uint64_t start;
+      uint64_t end;
+    };
+
+    Simulation *simulation;
+    std::mt19937_64 random;
+    uint64_t duration;
+    PairResult *result;
+    std::deque<Timer> timers; // Stable addresses, for the callbacks
+
+    DoorState state = CLOSED;
+    bool wasClosing = false; // Its last movement
+    uint64_t travel; // Of this door
+    unsigned long openingCount = 0;
+    unsigned long motorRunCount = 0;
+    std::vector<Drop> drops;
+
+    uint8_t sensorPins[2];
+    uint8_t relayPin;
+    uint8_t closeButtonPin;
+    uint8_t ackButtonPin;
+    uint8_t openLedPin;
+    uint8_t disconnectedLedPins[2]; // Of each board
+
+    uint64_t pressTime = UINT64_MAX; // Waiting for the relay
+    uint64_t openTime = UINT64_MAX; // Waiting for the dashboard
+    uint64_t disconnectedLedOffTimes[2] = { 0, 0 };
+    bool isDisconnectedLedOn[2] = { false, false };
+
+    uint64_t uniform(uint64_t min, uint64_t max);
+    bool draw(double rate);
+    uint64_t drawTravel();
+    uint64_t drawSkew();
+
+    void schedule(uint64_t delay, Action action, unsigned long tag = 0, uint8_t pin = 0, uint8_t level = 0);
+    void handle(const Timer &timer);
+    void setSensors(bool isOpen);
+    void scheduleNextOpening();
+    void pulseMotor();
+    bool overlapsDrop(uint64_t start, uint64_t end) const;
+
+    void onPinChange(int board, uint8_t pin, uint8_t level);
+    void onLine(int board, const char *line);
+
+    static void onTimer(void *context);
+    static void onPinChangeProxy(int board, uint8_t pin, uint8_t level, void *context);
+    static void onLineProxy(int board, const char *line, void *context);
+};
+
+FleetDoor::FleetDoor(Simulation *simulation, uint64_t seed, uint64_t duration, PairResult *result)
+  : simulation(simulation)
+  , random(seed)
+  , duration(duration)
+  , result(result)
+{
+  const SketchPins *controllerPins = findSketchPins("door-controller");
+  const SketchPins *dashboardPins = findSketchPins("door-dashboard");
+  sensorPins[0] = findSketchPin(controllerPins, "door-sensor-1");
+  sensorPins[1] = findSketchPin(controllerPins, "door-sensor-2");
+  relayPin = findSketchPin(controllerPins, "relay-1");
+  closeButtonPin = findSketchPin(dashboardPins, "close");
+  ackButtonPin = findSketchPin(dashboardPins, "ack");
+  openLedPin = findSketchPin(dashboardPins, "open-led");
+  disconnectedLedPins[CONTROLLER] = findSketchPin(controllerPins, "disconnected-led");
+  disconnectedLedPins[DASHBOARD] = findSketchPin(dashboardPins, "disconnected-led");
+}
+
+void FleetDoor::start()
+{
+  HostClock::reset(); // Like run() will: the timers are scheduled from the start
+
+  travel = draw(SLOW_DOOR_RATE) ? uniform(MAX_TRAVEL_MS, MAX_SLOW_TRAVEL_MS) : uniform(MIN_TRAVEL_MS, MAX_TRAVEL_MS);
+
+  HostLinkConditions conditions;
+  const double u = std::uniform_real_distribution<double>(0, 1)(random);
+  conditions.lossRate = MAX_LOSS_RATE * u * u;
+  conditions.latencyMs = uniform(1, 4);
+  conditions.jitterMs = 2;
+  conditions.duplicationRate = 0.01;
+  conditions.corruptionRate = 0.001;
+  HostEther::setLinkConditions(HOST_ETHER_ANY_RADIO, HOST_ETHER_ANY_RADIO, conditions);
+  HostEther::setRandomSeed(random());
+
+  std::exponential_distribution<double> dropInterval(1 / MEAN_DROP_INTERVAL_MS);
+  for (uint64_t time = dropInterval(random); time < duration; time += dropInterval(random)) {
+    // Log-uniform: mostly short drops
+    const double logDuration = std::uniform_real_distribution<double>(log(MIN_DROP_DURATION_MS), log(MAX_DROP_DURATION_MS))(random);
+    const Drop drop = { time, time + (uint64_t) exp(logDuration) };
+    drops.push_back(drop);
+    schedule(drop.start, DROP_START);
+    schedule(drop.end, DROP_END);
+    time = drop.end;
+  }
+
+  simulation->setPinListener(&onPinChangeProxy, this);
+  simulation->setLineListener(&onLineProxy, this);
+  scheduleNextOpening();
+}
+
+uint64_t FleetDoor::uniform(uint64_t min, uint64_t max)
+{
+  return std::uniform_int_distribution<uint64_t>(min, max)(random);
+}
+
+bool FleetDoor::draw(double rate)
+{
+  return std::uniform_real_distribution<double>(0, 1)(random) < rate;
+}
+
+uint64_t FleetDoor::drawTravel()
+{
+  return travel - TRAVEL_JITTER_MS / 2 + uniform(0, TRAVEL_JITTER_MS);
+}
+
+uint64_t FleetDoor::drawSkew()
+{
+  return draw(LATE_SENSOR_RATE) ? uniform(MAX_SENSOR_SKEW_MS, MAX_LATE_SENSOR_SKEW_MS) : uniform(0, MAX_SENSOR_SKEW_MS);
+}
+
+void FleetDoor::schedule(uint64_t delay, Action action, unsigned long tag, uint8_t pin, uint8_t level)
+{
+  timers.push_back({ this, action, tag, pin, level });
+  simulation->schedule(HostClock::now() + delay, &onTimer, &timers.back());
+}
+
+void FleetDoor::setSensors(bool isOpen)
+{
+  // Sensors are LOW when the door is open, one of them a bit later than the other
+  const uint8_t first = random() % 2;
+  schedule(0, SET_SENSOR, 0, sensorPins[first], isOpen ? LOW : HIGH);
+  schedule(drawSkew(), SET_SENSOR, 0, sensorPins[1 - first], isOpen ? LOW : HIGH);
+}
+
+void FleetDoor::scheduleNextOpening()
+{
+  const uint64_t closedDuration = std::exponential_distribution<double>(1 / MEAN_CLOSED_DURATION_MS)(random);
+  schedule(std::max(closedDuration, MIN_CLOSED_DURATION_MS), OPEN, openingCount);
+}
+
+void FleetDoor::pulseMotor()
+{
+  motorRunCount++;
+  switch (state) {
+    case CLOSED:
+      state = OPENING;
+      wasClosing = false;
+      setSensors(true);
+      schedule(drawTravel(), MOTOR_STOP, motorRunCount);
+      break;
+
+    case STOPPED_OPEN:
+      if (wasClosing) {
+        state = OPENING; // All the way: it is not known how far it is
+        wasClosing = false;
+        schedule(drawTravel(), MOTOR_STOP, motorRunCount);
+      } else if (draw(OBSTRUCTION_RATE)) {
+        state = CLOSING;
+        wasClosing = true;
+        schedule(drawTravel() / 2, MOTOR_REVERSE, motorRunCount);
+      } else {
+        state = CLOSING;
+        wasClosing = true;
+        schedule(drawTravel(), MOTOR_STOP, motorRunCount);
+      }
+      break;
+
+    case CLOSING:
+    case OPENING:
+      state = STOPPED_OPEN;
+      break;
+  }
+}
+
+void FleetDoor::handle(const Timer &timer)
+{
+  switch (timer.action) {
+    case OPEN:
+      if (state != CLOSED || timer.tag != openingCount) {
+        return;
+      }
+      openingCount++;
+      state = STOPPED_OPEN;
+      wasClosing = false;
+      if (pressTime != UINT64_MAX) {
+        result->unansweredPressCount++;
+        pressTime = UINT64_MAX;
+      }
+      setSensors(true);
+      openTime = HostClock::now();
+      if (draw(CLOSED_BY_HAND_RATE)) {
+        schedule(uniform(MIN_HOLD_DURATION_MS, MAX_HOLD_DURATION_MS), CLOSE_BY_HAND, openingCount);
+      } else if (draw(PRESSED_RATE / (1 - CLOSED_BY_HAND_RATE))) {
+        schedule(uniform(MIN_HOLD_DURATION_MS, MAX_HOLD_DURATION_MS), PRESS_CLOSE, openingCount);
+      }
+      break;
+
+    case CLOSE_BY_HAND:
+      if (state == CLOSED || timer.tag != openingCount) {
+        return;
+      }
+      motorRunCount++; // Whatever the motor was doing
+      state = CLOSED;
+      setSensors(false);
+      scheduleNextOpening();
+      break;
+
+    case PRESS_CLOSE:
+      if (state != STOPPED_OPEN || timer.tag != openingCount) {
+        return;
+      }
+      simulation->getBoard(DASHBOARD)->setInput(closeButtonPin, LOW);
+      schedule(PRESS_DURATION_MS, RELEASE_BUTTON, 0, closeButtonPin);
+      pressTime = HostClock::now();
+      break;
+
+    case PRESS_ACK:
+      simulation->getBoard(DASHBOARD)->setInput(ackButtonPin, LOW);
+      schedule(PRESS_DURATION_MS, RELEASE_BUTTON, 0, ackButtonPin);
+      break;
+
+    case RELEASE_BUTTON:
+      simulation->getBoard(DASHBOARD)->setInput(timer.pin, HIGH);
+      break;
+
+    case SET_SENSOR:
+      simulation->getBoard(CONTROLLER)->setInput(timer.pin, timer.level);
+      break;
+
+    case MOTOR_REVERSE:
+      if (timer.tag == motorRunCount && state == CLOSING) {
+        state = OPENING;
+        wasClosing = false;
+        schedule(drawTravel() / 2, MOTOR_STOP, motorRunCount);
+      }
+      break;
+
+    case MOTOR_STOP:
+      if (timer.tag != motorRunCount) {
+        return;
+      }
+      if (state == CLOSING) {
+        state = CLOSED;
+        setSensors(false);
+        scheduleNextOpening();
+      } else if (state == OPENING) {
+        state = STOPPED_OPEN;
+      }
+      break;
+
+    case DROP_START:
+    case DROP_END:
+      simulation->getBoard(CONTROLLER)->getRadio()->setIsolated(timer.action == DROP_START);
+      simulation->getBoard(DASHBOARD)->getRadio()->setIsolated(timer.action == DROP_START);
+      break;
+  }
+}
+
+bool FleetDoor::overlapsDrop(uint64_t start, uint64_t end) const
+{
+  for (const Drop &drop : drops) {
+    if (start <= drop.end + DROP_GRACE_MS && drop.start <= end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FleetDoor::onPinChange(int board, uint8_t pin, uint8_t level)
+{
+  const uint64_t now = HostClock::now();
+
+  if (board == CONTROLLER && pin == relayPin && level == HIGH) {
+    if (pressTime != UINT64_MAX && !overlapsDrop(pressTime, now)) {
+      if (now - pressTime <= MAX_PRESS_TO_RELAY_MS) {
+        result->pressToRelayLatencies.push_back(now - pressTime);
+      } else {
+        result->unansweredPressCount++;
+      }
+    }
+    pressTime = UINT64_MAX;
+    pulseMotor();
+
+  } else if (board == DASHBOARD && pin == openLedPin && level == HIGH) {
+    if (openTime != UINT64_MAX && !overlapsDrop(openTime, now)) {
+      result->doorToDashboardLatencies.push_back(now - openTime);
+    }
+    openTime = UINT64_MAX;
+
+  } else if (pin == disconnectedLedPins[board]) {
+    if (level == HIGH && !isDisconnectedLedOn[board] && now >= disconnectedLedOffTimes[board] + DISCONNECTED_LED_OFF_MS
+      && now >= STARTUP_MS && !overlapsDrop(now, now)) {
+      result->falseDisconnectionCount++;
+    }
+    if (level == LOW) {
+      disconnectedLedOffTimes[board] = now;
+    }
+    isDisconnectedLedOn[board] = (level == HIGH);
+  }
+}
+
+void FleetDoor::onLine(int board, const char *line)
+{
+  if (board != CONTROLLER) {
+    return;
+  }
+  if (strstr(line, "In CLOSING_STATE") != nullptr) {
+    result->closingCount++;
+  } else if (strstr(line, "In CLOSING_FAILED_STATE") != nullptr) {
+    result->failedClosingCount++;
+    schedule(uniform(MIN_AFTER_FAILURE_MS, MAX_AFTER_FAILURE_MS), CLOSE_BY_HAND, openingCount);
+  } else if (strstr(line, "In DOOR_SENSOR_ANOMALY_STATE") != nullptr) {
+    result->falseAnomalyCount++;
+    schedule(uniform(MIN_AFTER_FAILURE_MS, MAX_AFTER_FAILURE_MS), PRESS_ACK);
+  }
+}
+
+void FleetDoor::onTimer(void *context)
+{
+  const Timer *timer = (const Timer *) context;
+  timer->door->handle(*timer);
+}
+
+void FleetDoor::onPinChangeProxy(int board, uint8_t pin, uint8_t level, void *context)
+{
+  ((FleetDoor *) context)->onPinChange(board, pin, level);
+}
+
+void FleetDoor::onLineProxy(int board, const char *line, void *context)
+{
+  ((FleetDoor *) context)->onLine(board, line);
+}
+
+/**
+ * A queue of jobs per worker thread: each worker takes its own jobs, newest first, then steals the oldest jobs of the others,
+ * so that the workers given the slowest simulations (e.g. the lossiest links) do not finish long after the others.
+ */
+class JobQueues {
+  public:
+    JobQueues(unsigned int workerCount)
+    {
+      for (unsigned int i = 0; i < workerCount; i++) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+      }
+    }
+
+    void push(unsigned int worker, size_t job)
+    {
+      std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+      queues[worker]->jobs.push_back(job);
+    }
+
+    bool pop(unsigned int worker, size_t *job) // False when there is no job left
+    {
+      for (size_t i = 0; i < queues.size(); i++) {
+        Queue *queue = queues[(worker + i) % queues.size()].get();
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty()) {
+          if (i == 0) {
+            *job = queue->jobs.back();
+            queue->jobs.pop_back();
+          } else {
+            *job = queue->jobs.front();
+            queue->jobs.pop_front();
+          }
+          return true;
+        }
+      }
+      return false;
+    }
+
+  private:
+    struct Queue
+    {
+      std::mutex mutex;
+      std::deque<size_t> jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+};
+
+struct ParameterSet
+{
+  std::string name;
+  std::string directory;
+};
+
+struct Fleet
+{
+  std::vector<ParameterSet> parameterSets;
+  unsigned int pairCount;
+  uint64_t duration;
+  uint64_t seed;
+  std::vector<PairResult> results; // Of job j: parameter set j % parameterSets.size(), pair j / parameterSets.size()
+  std::atomic<size_t> doneCount;
+  std::atomic<bool> hasFailed;
+};
+
+void runPair(Fleet *fleet, size_t job)
+{
+  const ParameterSet &parameterSet = fleet->parameterSets[job % fleet->parameterSets.size()];
+  const size_t pair = job / fleet->parameterSets.size();
+  PairResult *result = &fleet->results[job];
+
+  Simulation simulation;
+  if (!simulation.addBoard((parameterSet.directory + "/" + CONTROLLER_SKETCH).c_str())
+    || !simulation.addBoard((parameterSet.directory + "/" + DASHBOARD_SKETCH).c_str())) {
+    fleet->hasFailed = true;
+    return;
+  }
+
+  Scenario scenario(simulation.getBoardNames());
+  scenario.setDuration(fleet->duration);
+
+  FleetDoor door(&simulation, fleet->seed * 1000003 + pair, fleet->duration, result);
+  door.start();
+  simulation.run(&scenario);
+
+  result->dashboardSentCount = simulation.getBoard(DASHBOARD)->getRadio()->getCounters()->sentCount;
+  result->isRun = true;
+}
+
+void work(Fleet *fleet, JobQueues *queues, unsigned int worker)
+{
+  size_t job;
+  while (!fleet->hasFailed && queues->pop(worker, &job)) {
+    runPair(fleet, job);
+    fleet->doneCount++;
+  }
+}
+
+/**
+ * Print the percentiles of the values, with their unit.
+ */
+void printDistribution(const char *name, std::vector<double> values, const char *unit)
+{
+  std::sort(values.begin(), values.end());
+  printf("  %-28s", name);
+  if (values.empty()) {
+    printf(" no measure\n");
+    return;
+  }
+  const double percentiles[] = { 0.5, 0.9, 0.99 };
+  const char *percentileNames[] = { "p50", "p90", "p99" };
+  for (int i = 0; i < 3; i++) {
+    printf(" %s %8.1f%s", percentileNames[i], values[(size_t) (percentiles[i] * (values.size() - 1))], unit);
+  }
+  printf("   max %8.1f%s   (%zu)\n", values.back(), unit, values.size());
+}
+
+void printResults(const Fleet &fleet, size_t parameterSetIndex)
+{
+  std::vector<double> pressToRelayLatencies;
+  std::vector<double> doorToDashboardLatencies;
+  std::vector<double> falseDisconnectionsPerDay;
+  std::vector<double> sentFramesPerHour;
+  unsigned long falseDisconnectionCount = 0;
+  unsigned long closingCount = 0;
+  unsigned long failedClosingCount = 0;
+  unsigned int pairsWithFailedClosings = 0;
+  unsigned long unansweredPressCount = 0;
+  unsigned long falseAnomalyCount = 0;
+  unsigned int pairsWithFalseAnomalies = 0;
+  const double days = fleet.duration / 86400000.0;
+
+  for (size_t job = parameterSetIndex; job < fleet.results.size(); job += fleet.parameterSets.size()) {
+    const PairResult &result = fleet.results[job];
+    if (!result.isRun) {
+      continue;
+    }
+    pressToRelayLatencies.insert(pressToRelayLatencies.end(), result.pressToRelayLatencies.begin(), result.pressToRelayLatencies.end());
+    doorToDashboardLatencies.insert(doorToDashboardLatencies.end(), result.doorToDashboardLatencies.begin(), result.doorToDashboardLatencies.end());
+    falseDisconnectionsPerDay.push_back(result.falseDisconnectionCount / days);
+    sentFramesPerHour.push_back(result.dashboardSentCount / (days * 24));
+    unansweredPressCount += result.unansweredPressCount;
+    falseDisconnectionCount += result.falseDisconnectionCount;
+    closingCount += result.closingCount;
+    failedClosingCount += result.failedClosingCount;
+    pairsWithFailedClosings += (result.failedClosingCount > 0);
+    falseAnomalyCount += result.falseAnomalyCount;
+    pairsWithFalseAnomalies += (result.falseAnomalyCount > 0);
+  }
+
+  printf("%s\n", fleet.parameterSets[parameterSetIndex].name.c_str());
+  printDistribution("press to relay", pressToRelayLatencies, " ms");
+  printDistribution("door to dashboard", doorToDashboardLatencies, " ms");
+  printf("  %-28s %lu\n", "unanswered close presses", unansweredPressCount);
+  printDistribution("false disconnections/day", falseDisconnectionsPerDay, "");
+  printDistribution("dashboard frames/hour", sentFramesPerHour, "");
+  printf("  %-28s %lu in total\n", "false disconnections", falseDisconnectionCount);
+  printf("  %-28s %lu of %lu closings (%.2f%%), at %u doors\n", "failed closings", failedClosingCount, closingCount,
+    closingCount == 0 ? 0.0 : 100.0 * failedClosingCount / closingCount, pairsWithFailedClosings);
+  printf("  %-28s %lu, at %u doors\n", "false sensor anomalies", falseAnomalyCount, pairsWithFalseAnomalies);
+}
+
+int usage(const char *program)
+{
+  fprintf(stderr, "usage: %s [--pairs <n>] [--duration <time>] [--threads <n>] [--seed <n>] <parameter-set-dir>...\n", program);
+  fprintf(stderr, "Each directory has both sketches (%s and %s): by default, the ones next to %s\n", CONTROLLER_SKETCH, DASHBOARD_SKETCH, program);
+  fprintf(stderr, "Times are like in scenarios, e.g. 1d or 12h (1d by default)\n");
+  return 2;
+}
+
+int main(int argc, char **argv)
+{
+  Fleet fleet;
+  fleet.pairCount = 1000;
+  fleet.duration = 86400000;
+  fleet.seed = 1;
+  fleet.doneCount = 0;
+  fleet.hasFailed = false;
+  unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--pairs") == 0 && i + 1 < argc) {
+      fleet.pairCount = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+      if (!Scenario::parseTime(argv[++i], &fleet.duration)) {
+        return usage(argv[0]);
+      }
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threadCount = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      fleet.seed = strtoull(argv[++i], nullptr, 10);
+    } else if (argv[i][0] == '-') {
+      return usage(argv[0]);
+    } else {
+      fleet.parameterSets.push_back({ baseName(argv[i]), argv[i] });
+    }
+  }
+  if (fleet.pairCount == 0 || fleet.duration == 0 || threadCount == 0) {
+    return usage(argv[0]);
+  }
+  if (fleet.parameterSets.empty()) {
+    fleet.parameterSets.push_back({ "default", directoryOf(argv[0]) });
+  }
+
+  // Each worker starts with a contiguous share of the jobs, interleaving the parameter sets
+  const size_t jobCount = fleet.pairCount * fleet.parameterSets.size();
+  fleet.results.resize(jobCount);
+  JobQueues queues(threadCount);
+  for (size_t job = 0; job < jobCount; job++) {
+    queues.push(job * threadCount / jobCount, job);
+  }
+
+  printf("%u doors for %.1f days per parameter set, on %u threads\n", fleet.pairCount, fleet.duration / 86400000.0, threadCount);
+  fflush(stdout);
+  const uint64_t startTime = HostClock::wallNow();
+  std::vector<std::thread> threads;
+  for (unsigned int worker = 0; worker < threadCount; worker++) {
+    threads.push_back(std::thread(&work, &fleet, &queues, worker));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  if (fleet.hasFailed) {
+    return 1;
+  }
+
+  const double elapsedTime = (HostClock::wallNow() - startTime) / 1000.0;
+  printf("%zu simulations in %.1f s: %.0f door-days per second\n\n", jobCount, elapsedTime,
+    jobCount * (fleet.duration / 86400000.0) / (elapsedTime > 0 ? elapsedTime : 1e-3));
+  for (size_t i = 0; i < fleet.parameterSets.size(); i++) {
+    printResults(fleet, i);
+  }
+  return 0;
+}
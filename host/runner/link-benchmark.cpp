@@ -0,0 +1,239 @@
+// Measures, without hardware, how fast the dashboard and the controller get through to each other over links of various qualities:
+// the latency from pressing the close button of the dashboard to the controller powering its relay, and the time to recover
+// from a radio drop (the dashboard showing the door opened meanwhile, and both boards no longer showing the disconnection).
+// Each trial is a simulation with its own seed (see Simulation and HostEther::setRandomSeed()).
+// usage: link-benchmark [--trials <n>] [--link <conditions>]... [--sketch <sketch.so>]...
+
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "host-clock.h"
+#include "host-ether.h"
+#include "scenario.h"
+#include "simulation.h"
+#include "sketch-pins.h"
+
+const char *DEFAULT_SKETCHES[] = { "door-controller.so", "door-dashboard.so" };
+
+// See HostEther::parseLinkConditions(): the same in both directions
+const char *DEFAULT_LINKS[] = {
+  "latency=0ms",
+  "latency=5ms,jitter=5ms",
+  "latency=20ms,jitter=20ms",
+  "loss=0.1",
+  "loss=0.3",
+  "loss=0.3,duplication=0.1",
+  "latency=10ms,jitter=10ms,loss=0.2,duplication=0.05,corruption=0.02"
+};
+
+const uint64_t PRESS_TIME = 30000; // Plus up to a second, at random, not to always press at the same time of the polling cycles
+const uint64_t DROP_START_TIME = 20000;
+const uint64_t DROP_END_TIME = 50000;
+const uint64_t DROP_DOOR_OPEN_TIME = 30000;
+const uint64_t TRIAL_DURATION = 120000;
+const uint64_t SETTLED_DURATION = 10000; // Without any change of the disconnected LEDs at the end, their last change ended the disconnection
+
+const uint64_t NOT_MEASURED = UINT64_MAX;
+
+std::string directoryOf(const char *path)
+{
+  const char *slash = strrchr(path, '/');
+  return slash == nullptr ? "." : std::string(path, slash - path);
+}
+
+struct PinWatch
+{
+  int board;
+  uint8_t pin;
+  uint64_t fromTime; // Ignore the changes before
+  uint64_t firstHighTime = NOT_MEASURED; // From fromTime
+  uint64_t lastChangeTime = NOT_MEASURED;
+  uint8_t level = 0;
+
+  PinWatch(int board, uint8_t pin, uint64_t fromTime) : board(board), pin(pin), fromTime(fromTime) {}
+};
+
+void watchPin(int board, uint8_t pin, uint8_t level, void *context)
+{
+  std::vector<PinWatch> *watches = (std::vector<PinWatch> *) context;
+  for (PinWatch &watch : *watches) {
+    if (watch.board != board || watch.pin != pin || HostClock::now() < watch.fromTime) {
+      continue;
+    }
+    if (level && watch.firstHighTime == NOT_MEASURED) {
+      watch.firstHighTime = HostClock::now();
+    }
+    watch.lastChangeTime = HostClock::now();
+    watch.level = level;
+  }
+}
+
+/**
+ * Run one trial: false if the simulation cannot be set up (the reason is printed).
+ */
+bool runTrial(const std::vector<std::string> &sketchLibraryPaths, const char *link, const std::vector<std::string> &statements,
+  uint64_t seed, std::vector<PinWatch> *watches)
+{
+  Simulation simulation;
+  for (const std::string &path : sketchLibraryPaths) {
+    if (!simulation.addBoard(path.c_str())) {
+      return false;
+    }
+  }
+
+  Scenario scenario(simulation.getBoardNames());
+  scenario.setDuration(TRIAL_DURATION);
+  std::vector<std::string> allStatements = {
+    std::string("at 0 link controller dashboard ") + link,
+    std::string("at 0 link dashboard controller ") + link
+  };
+  allStatements.insert(allStatements.end(), statements.begin(), statements.end());
+  for (const std::string &statement : allStatements) {
+    if (!scenario.parseStatement(statement, 0)) {
+      return false;
+    }
+  }
+
+  simulation.setPinListener(&watchPin, watches);
+  HostEther::setRandomSeed(seed);
+  simulation.run(&scenario);
+  return true;
+}
+
+/**
+ * Print the percentiles of the measures (in ms), and how many trials did not get a measure.
+ */
+void printDistribution(const char *name, std::vector<uint64_t> measures, unsigned int trialCount)
+{
+  std::sort(measures.begin(), measures.end());
+  printf("  %-26s", name);
+  if (measures.empty()) {
+    printf(" never");
+  } else {
+    const double percentiles[] = { 0.5, 0.9, 0.99 };
+    const char *percentileNames[] = { "p50", "p90", "p99" };
+    for (int i = 0; i < 3; i++) {
+      printf(" %s %6llu ms", percentileNames[i], (unsigned long long) measures[(size_t) (percentiles[i] * (measures.size() - 1))]);
+    }
+    printf("   max %6llu ms", (unsigned long long) measures.back());
+  }
+  if (measures.size() < trialCount) {
+    printf("   (%zu of %u trials never)", trialCount - measures.size(), trialCount);
+  }
+  printf("\n");
+}
+
+int usage(const char *program)
+{
+  fprintf(stderr, "usage: %s [--trials <n>] [--link <conditions>]... [--sketch <sketch.so>]...\n", program);
+  fprintf(stderr, "Link conditions are like latency=5ms,jitter=2ms,loss=0.1,duplication=0.01,corruption=0.001 (the same both ways)\n");
+  return 2;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned int trialCount = 100;
+  std::vector<const char *> links;
+  std::vector<std::string> sketchLibraryPaths;
+
+  for (int i = 1; i < argc; i++) {
+    HostLinkConditions conditions;
+    if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc) {
+      trialCount = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--link") == 0 && i + 1 < argc && HostEther::parseLinkConditions(argv[i + 1], &conditions)) {
+      links.push_back(argv[++i]);
+    } else if (strcmp(argv[i], "--sketch") == 0 && i + 1 < argc) {
+      sketchLibraryPaths.push_back(argv[++i]);
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (trialCount == 0) {
+    return usage(argv[0]);
+  }
+  if (links.empty()) {
+    links.assign(DEFAULT_LINKS, DEFAULT_LINKS + sizeof(DEFAULT_LINKS) / sizeof(DEFAULT_LINKS[0]));
+  }
+  if (sketchLibraryPaths.empty()) {
+    for (const char *sketch : DEFAULT_SKETCHES) {
+      sketchLibraryPaths.push_back(directoryOf(argv[0]) + "/" + sketch);
+    }
+  }
+
+  const SketchPins *controllerPins = findSketchPins("door-controller");
+  const SketchPins *dashboardPins = findSketchPins("door-dashboard");
+  const uint8_t relayPins[] = { findSketchPin(controllerPins, "relay-1"), findSketchPin(controllerPins, "relay-2") };
+  const uint8_t openLedPin = findSketchPin(dashboardPins, "open-led");
+  const uint8_t controllerDisconnectedLedPin = findSketchPin(controllerPins, "disconnected-led");
+  const uint8_t dashboardDisconnectedLedPin = findSketchPin(dashboardPins, "disconnected-led");
+  const int CONTROLLER = 0;
+  const int DASHBOARD = 1;
+
+  for (const char *link : links) {
+    std::vector<uint64_t> pressToRelayLatencies;
+    std::vector<uint64_t> stateRecoveryTimes;
+    std::vector<uint64_t> connectionRecoveryTimes;
+
+    for (unsigned int trial = 0; trial < trialCount; trial++) {
+      std::mt19937_64 random(trial);
+
+      // Press to relay: the door is open, and someone asks the dashboard to close it
+      const uint64_t pressTime = PRESS_TIME + random() % 1000;
+      std::vector<PinWatch> watches;
+      for (uint8_t relayPin : relayPins) {
+        watches.push_back(PinWatch(CONTROLLER, relayPin, pressTime));
+      }
+      if (!runTrial(sketchLibraryPaths, link, {
+        "at 10s door open",
+        "at " + std::to_string(pressTime) + "ms press dashboard close"
+      }, random(), &watches)) {
+        return 1;
+      }
+      const uint64_t relayTime = std::min(watches[0].firstHighTime, watches[1].firstHighTime);
+      if (relayTime != NOT_MEASURED) {
+        pressToRelayLatencies.push_back(relayTime - pressTime);
+      }
+
+      // Recovery: the door opens while no frame goes through
+      watches = {
+        PinWatch(DASHBOARD, openLedPin, DROP_END_TIME),
+        PinWatch(CONTROLLER, controllerDisconnectedLedPin, DROP_END_TIME),
+        PinWatch(DASHBOARD, dashboardDisconnectedLedPin, DROP_END_TIME)
+      };
+      if (!runTrial(sketchLibraryPaths, link, {
+        "from " + std::to_string(DROP_START_TIME) + "ms to " + std::to_string(DROP_END_TIME) + "ms radio-drop",
+        "at " + std::to_string(DROP_DOOR_OPEN_TIME) + "ms door open"
+      }, random(), &watches)) {
+        return 1;
+      }
+      if (watches[0].firstHighTime != NOT_MEASURED) {
+        stateRecoveryTimes.push_back(watches[0].firstHighTime - DROP_END_TIME);
+      }
+      uint64_t connectionRecoveryTime = DROP_END_TIME;
+      for (size_t i = 1; i < watches.size() && connectionRecoveryTime != NOT_MEASURED; i++) {
+        if (watches[i].lastChangeTime == NOT_MEASURED) {
+          continue; // Already reconnected (it was not blinking when the drop ended)
+        }
+        if (watches[i].level != 0 || watches[i].lastChangeTime + SETTLED_DURATION > TRIAL_DURATION) {
+          connectionRecoveryTime = NOT_MEASURED;
+        } else {
+          connectionRecoveryTime = std::max(connectionRecoveryTime, watches[i].lastChangeTime);
+        }
+      }
+      if (connectionRecoveryTime != NOT_MEASURED) {
+        connectionRecoveryTimes.push_back(connectionRecoveryTime - DROP_END_TIME);
+      }
+    }
+
+    printf("%s (%u trials)\n", link, trialCount);
+    printDistribution("press to relay", pressToRelayLatencies, trialCount);
+    printDistribution("door state after a drop", stateRecoveryTimes, trialCount);
+    printDistribution("reconnection after a drop", connectionRecoveryTimes, trialCount);
+  }
+  return 0;
+}
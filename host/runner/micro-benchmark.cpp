@@ -0,0 +1,758 @@
+// Measures the hot paths of the libraries of the controller on a computer, to compare their cost between commits:
+// each benchmark repeats one operation (e.g. a call to Button::loop()) in a steady state, in virtual time, and the results are printed as JSON
+// (compare two of them with tools/compare-benchmarks.py).
+// The Arduino functions go through the stand-ins of shim/ (e.g. digitalWrite() records the pin of a HostBoard): compare the results
+// with each other, not with the cost on a board (see benchmarks/mac-benchmark for the cycles spent on the boards).
+// usage: micro-benchmark [--samples <n>] [--min-sample-time <ms>] [--filter <text>] [--label <text>] [--sketch <door-controller.so>]
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER 1
+#endif
+
+#include "host-board.h"
+#include "host-clock.h"
+
+#include "src/libs/action-chain/action-chain.h"
+#include "src/libs/constants/duration-units.h"
+#include "src/libs/crypto/siphash.h"
+#include "src/libs/hardware/button.h"
+#include "src/libs/hardware/buzzer.h"
+#include "src/libs/hardware/input-bank.h"
+#include "src/libs/hardware/led.h"
+#include "src/libs/hardware/redundant-sensor.h"
+#include "src/libs/state-machine/state-machine.h"
+#include "wireless-messages.h"
+
+const char *DEFAULT_SKETCH = "door-controller.so";
+
+// Exported by the controller (see tools/sketch.map): the callback of Wireless::receive()
+const char *HANDLE_WIRELESS_DATA_RECEIVED_SYMBOL = "_Z26handleWirelessDataReceivedPhh";
+
+const unsigned long WARM_UP_ITERATIONS = 1000;
+const unsigned long DEBOUNCING_DURATION_MS = 30; // The InputBank validates a change after 4 samples, 5 ms apart: with some margin
+const unsigned long INPUT_SAMPLE_PERIOD_MS = 5;
+
+/**
+ * Runs the library code: the Arduino functions act on its pins and serial port.
+ */
+HostBoard benchmarkBoard("benchmark");
+
+/**
+ * Runs the controller sketch, to call its handleWirelessDataReceived() (nullptr while not loaded).
+ */
+HostBoard *controllerBoard = nullptr;
+void (*handleWirelessDataReceived)(byte data[], uint8_t size) = nullptr;
+
+/**
+ * Makes the compiler assume memory changed, so that it repeats each operation instead of hoisting it out of the loop.
+ */
+inline void clobberMemory()
+{
+  asm volatile("" : : : "memory");
+}
+
+/**
+ * Moves the virtual time (millis() included) to the deadline returned by a nextDeadline() function, as the sketches sleep until it.
+ */
+Timestamp advanceToDeadline(const Timestamp deadline)
+{
+  HostClock::advance((Timestamp) (deadline - millis()));
+  return deadline;
+}
+
+/**
+ * Drives an input pin of the benchmark board, and runs InputBank::loop() and the given loop() until the change is debounced.
+ */
+void changeInput(uint8_t pin, uint8_t level, void (*loopInputs)(const Timestamp now))
+{
+  benchmarkBoard.setInput(pin, level);
+  InputBank::captureEdges(); // Like the pin change interrupt: the benchmark board has no sketch to do it
+
+  for (unsigned long elapsed = 0; elapsed < DEBOUNCING_DURATION_MS; elapsed += INPUT_SAMPLE_PERIOD_MS) {
+    HostClock::advance(INPUT_SAMPLE_PERIOD_MS);
+    const Timestamp now = millis();
+    InputBank::loop(now);
+    loopInputs(now);
+  }
+}
+
+//////// State machine ////////
+
+// As large as the state machine of the controller, with enter() functions doing nothing: only handleEvent() is measured
+
+const uint8_t MACHINE_STATE_COUNT = 7;
+const uint8_t MACHINE_EVENT_COUNT = 8;
+
+const uint8_t NEXT_STATE_EVENT_ID = 0; // From each state to the next one
+const uint8_t IGNORED_EVENT_ID = 1; // Without transition
+const uint8_t RESET_EVENT_ID = 2; // From any state to the first one
+
+unsigned long enteredStateCount = 0;
+
+void enterMachineState()
+{
+  enteredStateCount++;
+}
+
+const State MACHINE_STATE_VALUES[MACHINE_STATE_COUNT] = {
+  State(0, &enterMachineState),
+  State(1, &enterMachineState),
+  State(2, &enterMachineState),
+  State(3, &enterMachineState),
+  State(4, &enterMachineState),
+  State(5, &enterMachineState),
+  State(6, &enterMachineState)
+};
+
+const State *const MACHINE_STATES[MACHINE_STATE_COUNT] = {
+  &MACHINE_STATE_VALUES[0],
+  &MACHINE_STATE_VALUES[1],
+  &MACHINE_STATE_VALUES[2],
+  &MACHINE_STATE_VALUES[3],
+  &MACHINE_STATE_VALUES[4],
+  &MACHINE_STATE_VALUES[5],
+  &MACHINE_STATE_VALUES[6]
+};
+
+constexpr Transition MACHINE_TRANSITION_VALUES[] = {
+  Transition(State::ANY_ID, RESET_EVENT_ID, 0),
+  Transition(0, NEXT_STATE_EVENT_ID, 1),
+  Transition(1, NEXT_STATE_EVENT_ID, 2),
+  Transition(2, NEXT_STATE_EVENT_ID, 3),
+  Transition(3, NEXT_STATE_EVENT_ID, 4),
+  Transition(4, NEXT_STATE_EVENT_ID, 5),
+  Transition(5, NEXT_STATE_EVENT_ID, 6),
+  Transition(6, NEXT_STATE_EVENT_ID, 0)
+};
+
+constexpr TransitionTable<MACHINE_STATE_COUNT, MACHINE_EVENT_COUNT> MACHINE_TRANSITIONS =
+  makeTransitionTable<MACHINE_STATE_COUNT, MACHINE_EVENT_COUNT>(MACHINE_TRANSITION_VALUES);
+
+const Event NEXT_STATE_EVENT = Event(NEXT_STATE_EVENT_ID);
+const Event IGNORED_EVENT = Event(IGNORED_EVENT_ID);
+
+StateMachine stateMachine = StateMachine(MACHINE_STATES, &MACHINE_TRANSITIONS);
+
+void runStateMachineTransition(unsigned long iterations)
+{
+  for (unsigned long i = 0; i < iterations; i++) {
+    stateMachine.handleEvent(&NEXT_STATE_EVENT);
+    clobberMemory();
+  }
+}
+
+void runStateMachineNoTransition(unsigned long iterations)
+{
+  for (unsigned long i = 0; i < iterations; i++) {
+    stateMachine.handleEvent(&IGNORED_EVENT);
+    clobberMemory();
+  }
+}
+
+//////// Action orchestrator ////////
+
+Led chainLed1(10);
+Led chainLed2(11);
+
+const LedPattern CHAIN_LED_PATTERN = INIT_LED_PATTERN(500, 500);
+
+const TurnOnLedAction TURN_ON_CHAIN_LED_1_ACTION = TurnOnLedAction(&chainLed1);
+const StartBlinkingLedAction BLINK_CHAIN_LED_2_ACTION = StartBlinkingLedAction(&chainLed2, &CHAIN_LED_PATTERN);
+const WaitAction WAIT_1_MS_ACTION = WaitAction(1);
+const WaitAction WAIT_1_DAY_ACTION = WaitAction(DAYS_AS_MS);
+
+const Action *const WAITING_ACTION_CHAIN[] PROGMEM = {
+  &TURN_ON_CHAIN_LED_1_ACTION,
+  &WAIT_1_DAY_ACTION
+};
+const uint8_t WAITING_ACTION_CHAIN_SIZE = sizeof(WAITING_ACTION_CHAIN) / sizeof(Action*);
+
+const Action *const OTHER_WAITING_ACTION_CHAIN[] PROGMEM = {
+  &BLINK_CHAIN_LED_2_ACTION,
+  &WAIT_1_DAY_ACTION
+};
+const uint8_t OTHER_WAITING_ACTION_CHAIN_SIZE = sizeof(OTHER_WAITING_ACTION_CHAIN) / sizeof(Action*);
+
+// Switches action at each millisecond: loop begin, LED, wait, loop end (and back to the LED)
+const Action *const SWITCHING_ACTION_CHAIN[] PROGMEM = {
+  &LOOP_BEGIN_ACTION,
+  &TURN_ON_CHAIN_LED_1_ACTION,
+  &WAIT_1_MS_ACTION,
+  &LOOP_END_ACTION
+};
+const uint8_t SWITCHING_ACTION_CHAIN_SIZE = sizeof(SWITCHING_ACTION_CHAIN) / sizeof(Action*);
+
+ActionOrchestrator idleOrchestrator = ActionOrchestrator();
+ActionOrchestrator waitingOrchestrator = ActionOrchestrator();
+ActionOrchestrator switchingOrchestrator = ActionOrchestrator();
+ActionOrchestrator changingOrchestrator = ActionOrchestrator();
+
+void runOrchestratorIdle(unsigned long iterations)
+{
+  const Timestamp now = millis();
+  for (unsigned long i = 0; i < iterations; i++) {
+    idleOrchestrator.loop(now);
+    clobberMemory();
+  }
+}
+
+void setUpOrchestratorWaiting()
+{
+  waitingOrchestrator.start(WAITING_ACTION_CHAIN, WAITING_ACTION_CHAIN_SIZE);
+  waitingOrchestrator.loop(millis());
+}
+
+void runOrchestratorWaiting(unsigned long iterations)
+{
+  const Timestamp now = millis();
+  for (unsigned long i = 0; i < iterations; i++) {
+    waitingOrchestrator.loop(now);
+    clobberMemory();
+  }
+}
+
+void setUpOrchestratorSwitching()
+{
+  switchingOrchestrator.start(SWITCHING_ACTION_CHAIN, SWITCHING_ACTION_CHAIN_SIZE);
+  switchingOrchestrator.loop(millis());
+}
+
+void runOrchestratorSwitching(unsigned long iterations)
+{
+  for (unsigned long i = 0; i < iterations; i++) {
+    switchingOrchestrator.loop(advanceToDeadline(switchingOrchestrator.nextDeadline()));
+  }
+}
+
+void runOrchestratorChanging(unsigned long iterations)
+{
+  const Timestamp now = millis();
+  for (unsigned long i = 0; i < iterations; i++) {
+    if (i % 2 == 0) {
+      changingOrchestrator.change(WAITING_ACTION_CHAIN, WAITING_ACTION_CHAIN_SIZE);
+    } else {
+      changingOrchestrator.change(OTHER_WAITING_ACTION_CHAIN, OTHER_WAITING_ACTION_CHAIN_SIZE);
+    }
+    changingOrchestrator.loop(now);
+  }
+}
+
+//////// Buttons ////////
+
+Button plainButton(3, INTERNAL_PULL_UP_RESISTOR); // With an onPress callback only
+Button callbackButton(4, INTERNAL_PULL_UP_RESISTOR); // With onPress, onLongPress and onMultiPress callbacks
+
+unsigned long buttonCallbackCount = 0;
+
+void onButtonPress()
+{
+  buttonCallbackCount++;
+}
+
+void onButtonLongPress(unsigned int repeatNumber)
+{
+  buttonCallbackCount++;
+}
+
+void onButtonMultiPress(unsigned int pressCount)
+{
+  buttonCallbackCount++;
+}
+
+void loopButtons(const Timestamp now)
+{
+  plainButton.loop(now);
+  callbackButton.loop(now);
+}
+
+void runButtonLoop(Button *button, unsigned long iterations)
+{
+  const Timestamp now = millis();
+  for (unsigned long i = 0; i < iterations; i++) {
+    button->loop(now);
+    clobberMemory();
+  }
+}
+
+void runPlainButtonIdle(unsigned long iterations)
+{
+  runButtonLoop(&plainButton, iterations);
+}
+
+void runCallbackButtonIdle(unsigned long iterations)
+{
+  runButtonLoop(&callbackButton, iterations);
+}
+
+void setUpCallbackButtonHeld()
+{
+  changeInput(callbackButton.getPin(), LOW, &loopButtons);
+}
+
+void runCallbackButtonHeld(unsigned long iterations)
+{
+  // One call per millisecond, the long press repeating each second
+  for (unsigned long i = 0; i < iterations; i++) {
+    HostClock::advance(1);
+    callbackButton.loop(millis());
+  }
+}
+
+void setUpButtonsReleased()
+{
+  changeInput(plainButton.getPin(), HIGH, &loopButtons);
+  changeInput(callbackButton.getPin(), HIGH, &loopButtons);
+}
+
+void runPressAndRelease(Button *button, unsigned long iterations)
+{
+  // Pressed twice in less than MULTI_PRESS_MAX_GAP_MS: a multi-press each time
+  for (unsigned long i = 0; i < iterations; i++) {
+    changeInput(button->getPin(), LOW, &loopButtons);
+    changeInput(button->getPin(), HIGH, &loopButtons);
+  }
+}
+
+void runPlainButtonPressAndRelease(unsigned long iterations)
+{
+  runPressAndRelease(&plainButton, iterations);
+}
+
+void runCallbackButtonPressAndRelease(unsigned long iterations)
+{
+  runPressAndRelease(&callbackButton, iterations);
+}
+
+//////// Redundant sensor ////////
+
+const uint8_t SENSOR_PIN_1 = 5;
+const uint8_t SENSOR_PIN_2 = 6;
+
+// The sensors never disagree long enough for an anomaly: only the checks of loop() are measured
+RedundantSensor redundantSensor(SENSOR_PIN_1, SENSOR_PIN_2, INTERNAL_PULL_UP_RESISTOR, DAYS_AS_MS);
+
+unsigned long sensorChangeCount = 0;
+
+void onRedundantSensorChange(RedundantSensor::State state)
+{
+  sensorChangeCount++;
+}
+
+void loopRedundantSensor(const Timestamp now)
+{
+  redundantSensor.loop(now);
+}
+
+void setUpRedundantSensorAgreeing()
+{
+  changeInput(SENSOR_PIN_1, HIGH, &loopRedundantSensor);
+}
+
+void runRedundantSensor(unsigned long iterations)
+{
+  const Timestamp now = millis();
+  for (unsigned long i = 0; i < iterations; i++) {
+    redundantSensor.loop(now);
+    clobberMemory();
+  }
+}
+
+void setUpRedundantSensorDisagreeing()
+{
+  changeInput(SENSOR_PIN_1, LOW, &loopRedundantSensor);
+}
+
+//////// LED ////////
+
+Led led(9);
+
+const LedPattern SLOW_LED_PATTERN = INIT_LED_PATTERN(1000, 1000);
+const LedPattern FAST_LED_PATTERN = INIT_LED_PATTERN(1, 1);
+
+void setUpLedSteady()
+{
+  led.turnOn();
+}
+
+void setUpLedBlinkingSlowly()
+{
+  led.blink(&SLOW_LED_PATTERN);
+}
+
+void setUpLedBlinkingFast()
+{
+  led.blink(&FAST_LED_PATTERN);
+}
+
+void runLed(unsigned long iterations)
+{
+  const Timestamp now = millis();
+  for (unsigned long i = 0; i < iterations; i++) {
+    led.loop(now);
+    clobberMemory();
+  }
+}
+
+void runLedToggling(unsigned long iterations)
+{
+  for (unsigned long i = 0; i < iterations; i++) {
+    led.loop(advanceToDeadline(led.nextDeadline()));
+  }
+}
+
+//////// Buzzer ////////
+
+Buzzer buzzer;
+
+const BuzzerMelody LONG_NOTE_MELODY = INIT_BUZZER_MELODY(440, 60000);
+
+// Notes of 1 ms, played again when over: loop() changes note at each call
+const BuzzerMelody SHORT_NOTES_MELODY = INIT_BUZZER_MELODY(440, 1, 494, 1, 523, 1, 587, 1, 659, 1, 698, 1, 784, 1, 880, 1);
+
+void setUpBuzzerSilent()
+{
+  buzzer.stop();
+}
+
+void setUpBuzzerPlayingLongNote()
+{
+  buzzer.stop();
+  buzzer.play(&LONG_NOTE_MELODY);
+}
+
+void setUpBuzzerPlayingShortNotes()
+{
+  buzzer.stop();
+  buzzer.play(&SHORT_NOTES_MELODY);
+}
+
+void runBuzzer(unsigned long iterations)
+{
+  const Timestamp now = millis();
+  for (unsigned long i = 0; i < iterations; i++) {
+    buzzer.loop(now);
+    clobberMemory();
+  }
+}
+
+void runBuzzerChangingNotes(unsigned long iterations)
+{
+  for (unsigned long i = 0; i < iterations; i++) {
+    const Timestamp deadline = buzzer.nextDeadline();
+    if (deadline == NO_DEADLINE) {
+      buzzer.play(&SHORT_NOTES_MELODY); // Once every 9 calls, after its 8 notes
+    } else {
+      buzzer.loop(advanceToDeadline(deadline));
+    }
+  }
+}
+
+//////// Wireless ////////
+
+// Received by the controller: a poll, the same 4 button presses sent again until acknowledged, and noise
+DashboardMessage pollMessage;
+DashboardMessage resentPressesMessage;
+DashboardMessage erroneousMessage;
+
+void makeDashboardMessages()
+{
+  pollMessage.header = MESSAGE_HEADER;
+  pollMessage.replyInAck = 1;
+  pollMessage.protocolVersion = PROTOCOL_VERSION;
+  pollMessage.unused = 0;
+
+  resentPressesMessage = pollMessage;
+  resentPressesMessage.firstEventId = 1;
+  for (uint8_t i = 0; i < MESSAGE_MAX_BUTTON_PRESSES; i++) {
+    resentPressesMessage.buttonIndexes[i] = MESSAGE_PRESSED_BUTTON_ACK_AUTO_CLOSED;
+  }
+
+  erroneousMessage = resentPressesMessage;
+  erroneousMessage.header = (byte) ~MESSAGE_HEADER;
+}
+
+void runHandleWirelessData(DashboardMessage *message, uint8_t size, unsigned long iterations)
+{
+  HostBoard::Activation activation(controllerBoard);
+  for (unsigned long i = 0; i < iterations; i++) {
+    handleWirelessDataReceived((byte *) message, size);
+  }
+}
+
+void runHandlePollMessage(unsigned long iterations)
+{
+  runHandleWirelessData(&pollMessage, dashboardMessageSize(0), iterations);
+}
+
+void setUpResentPressesMessage()
+{
+  runHandleWirelessData(&resentPressesMessage, dashboardMessageSize(MESSAGE_MAX_BUTTON_PRESSES), 1); // Handled the first time only
+}
+
+void runHandleResentPressesMessage(unsigned long iterations)
+{
+  runHandleWirelessData(&resentPressesMessage, dashboardMessageSize(MESSAGE_MAX_BUTTON_PRESSES), iterations);
+}
+
+void runHandleErroneousMessage(unsigned long iterations)
+{
+  runHandleWirelessData(&erroneousMessage, dashboardMessageSize(MESSAGE_MAX_BUTTON_PRESSES), iterations);
+}
+
+// The authenticated bytes of the frames of these messages (plus their 4-byte counter and the radio ID of the sender): see Wireless::authenticate()
+uint8_t authenticationKey[SIPHASH_KEY_SIZE];
+uint8_t authenticatedFrame[Wireless::MAX_PAYLOAD_SIZE + sizeof(uint32_t) + 1];
+volatile uint64_t authenticationTag; // Volatile for the computation to not be optimized away
+
+void runSipHash(uint8_t size, unsigned long iterations)
+{
+  for (unsigned long i = 0; i < iterations; i++) {
+    authenticationTag = siphash24(authenticationKey, authenticatedFrame, size);
+  }
+}
+
+void runSipHashPollMessage(unsigned long iterations)
+{
+  runSipHash(dashboardMessageSize(0) + sizeof(uint32_t) + 1, iterations);
+}
+
+void runSipHashPressesMessage(unsigned long iterations)
+{
+  runSipHash(dashboardMessageSize(MESSAGE_MAX_BUTTON_PRESSES) + sizeof(uint32_t) + 1, iterations);
+}
+
+//////// Benchmarks ////////
+
+/**
+ * Like the setup() of a sketch: each benchmark then brings them to the state it measures.
+ */
+void setUpLibraries()
+{
+  stateMachine.start(MACHINE_STATES[0]);
+
+  chainLed1.setup();
+  chainLed2.setup();
+
+  plainButton.setup();
+  plainButton.setOnPress(&onButtonPress);
+
+  callbackButton.setup();
+  callbackButton.setOnPress(&onButtonPress);
+  callbackButton.setOnLongPress(SECONDS_AS_MS, &onButtonLongPress);
+  callbackButton.setOnMultiPress(&onButtonMultiPress);
+
+  redundantSensor.setOnChange(&onRedundantSensorChange);
+  redundantSensor.setup();
+
+  led.setup();
+  buzzer.setup();
+
+  makeDashboardMessages();
+  for (uint8_t i = 0; i < SIPHASH_KEY_SIZE; i++) {
+    authenticationKey[i] = i;
+  }
+  for (uint8_t i = 0; i < sizeof(authenticatedFrame); i++) {
+    authenticatedFrame[i] = i;
+  }
+}
+
+struct Benchmark
+{
+  const char *name;
+  void (*setUp)(); // Brings the library to the state to measure (nullptr if none), whatever the benchmarks run before
+  void (*run)(unsigned long iterations);
+  bool needsController; // Calls the controller sketch
+};
+
+const Benchmark BENCHMARKS[] = {
+  { "state-machine/handle-event-transition", nullptr, &runStateMachineTransition, false },
+  { "state-machine/handle-event-no-transition", nullptr, &runStateMachineNoTransition, false },
+
+  { "action-orchestrator/loop-idle", nullptr, &runOrchestratorIdle, false },
+  { "action-orchestrator/loop-waiting", &setUpOrchestratorWaiting, &runOrchestratorWaiting, false },
+  { "action-orchestrator/loop-switching-actions", &setUpOrchestratorSwitching, &runOrchestratorSwitching, false },
+  { "action-orchestrator/loop-changing-chain", nullptr, &runOrchestratorChanging, false },
+
+  { "button/loop-idle", &setUpButtonsReleased, &runPlainButtonIdle, false },
+  { "button/loop-idle-long-multi-press", &setUpButtonsReleased, &runCallbackButtonIdle, false },
+  { "button/loop-held-long-press", &setUpCallbackButtonHeld, &runCallbackButtonHeld, false },
+  { "button/press-release", &setUpButtonsReleased, &runPlainButtonPressAndRelease, false },
+  { "button/press-release-long-multi-press", &setUpButtonsReleased, &runCallbackButtonPressAndRelease, false },
+
+  { "redundant-sensor/loop-agreeing", &setUpRedundantSensorAgreeing, &runRedundantSensor, false },
+  { "redundant-sensor/loop-disagreeing", &setUpRedundantSensorDisagreeing, &runRedundantSensor, false },
+
+  { "led/loop-steady", &setUpLedSteady, &runLed, false },
+  { "led/loop-blinking", &setUpLedBlinkingSlowly, &runLed, false },
+  { "led/loop-toggling", &setUpLedBlinkingFast, &runLedToggling, false },
+
+  { "buzzer/loop-silent", &setUpBuzzerSilent, &runBuzzer, false },
+  { "buzzer/loop-playing", &setUpBuzzerPlayingLongNote, &runBuzzer, false },
+  { "buzzer/loop-changing-notes", &setUpBuzzerPlayingShortNotes, &runBuzzerChangingNotes, false },
+
+  { "wireless/handle-data-poll", nullptr, &runHandlePollMessage, true },
+  { "wireless/handle-data-resent-presses", &setUpResentPressesMessage, &runHandleResentPressesMessage, true },
+  { "wireless/handle-data-erroneous", nullptr, &runHandleErroneousMessage, true },
+  { "wireless/siphash24-poll", nullptr, &runSipHashPollMessage, false },
+  { "wireless/siphash24-presses", nullptr, &runSipHashPressesMessage, false }
+};
+
+struct BenchmarkSample
+{
+  double nanosecondsPerOperation;
+  double cyclesPerOperation; // Reference cycles of the time-stamp counter (0 without one)
+};
+
+BenchmarkSample measure(const Benchmark &benchmark, unsigned long iterations)
+{
+  BenchmarkSample sample;
+  const auto start = std::chrono::steady_clock::now();
+#ifdef HAS_CYCLE_COUNTER
+  const unsigned long long startCycles = __rdtsc();
+#endif
+
+  benchmark.run(iterations);
+
+#ifdef HAS_CYCLE_COUNTER
+  sample.cyclesPerOperation = (double) (__rdtsc() - startCycles) / iterations;
+#else
+  sample.cyclesPerOperation = 0;
+#endif
+  sample.nanosecondsPerOperation = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+  return sample;
+}
+
+void ignoreSerialLine(HostBoard *board, const char *line, void *context)
+{
+}
+
+std::string directoryOf(const char *path)
+{
+  const char *slash = strrchr(path, '/');
+  return slash == nullptr ? "." : std::string(path, slash - path);
+}
+
+void printJsonString(const char *text)
+{
+  putchar('"');
+  for (const char *c = text; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      putchar('\\');
+    }
+    if ((unsigned char) *c >= 0x20) {
+      putchar(*c);
+    }
+  }
+  putchar('"');
+}
+
+int usage(const char *program)
+{
+  fprintf(stderr, "usage: %s [--samples <n>] [--min-sample-time <ms>] [--filter <text>] [--label <text>] [--sketch <door-controller.so>]\n", program);
+  return 2;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned int sampleCount = 5;
+  double minSampleNanoseconds = 20e6;
+  const char *filter = "";
+  const char *label = "";
+  std::string sketchLibraryPath = directoryOf(argv[0]) + "/" + DEFAULT_SKETCH;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+      sampleCount = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--min-sample-time") == 0 && i + 1 < argc) {
+      minSampleNanoseconds = strtod(argv[++i], nullptr) * 1e6;
+    } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) {
+      label = argv[++i];
+    } else if (strcmp(argv[i], "--sketch") == 0 && i + 1 < argc) {
+      sketchLibraryPath = argv[++i];
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (sampleCount == 0 || minSampleNanoseconds <= 0) {
+    return usage(argv[0]);
+  }
+
+  std::vector<const Benchmark *> benchmarks;
+  bool needsController = false;
+  for (const Benchmark &benchmark : BENCHMARKS) {
+    if (strstr(benchmark.name, filter) != nullptr) {
+      benchmarks.push_back(&benchmark);
+      needsController = needsController || benchmark.needsController;
+    }
+  }
+
+  if (needsController) {
+    controllerBoard = new HostBoard("door-controller");
+    if (!controllerBoard->load(sketchLibraryPath.c_str())) {
+      return 1;
+    }
+    handleWirelessDataReceived = (void (*)(byte *, uint8_t)) controllerBoard->findSymbol(HANDLE_WIRELESS_DATA_RECEIVED_SYMBOL);
+    if (handleWirelessDataReceived == nullptr) {
+      fprintf(stderr, "%s does not export handleWirelessDataReceived() (see tools/sketch.map)\n", sketchLibraryPath.c_str());
+      return 1;
+    }
+    controllerBoard->setSerialListener(&ignoreSerialLine, nullptr);
+    controllerBoard->setup();
+  }
+  benchmarkBoard.setSerialListener(&ignoreSerialLine, nullptr);
+  HostBoard::Activation activation(&benchmarkBoard);
+  setUpLibraries();
+
+  printf("{\n  \"label\": ");
+  printJsonString(label);
+  printf(",\n  \"samples\": %u,\n  \"benchmarks\": [", sampleCount);
+
+  for (size_t b = 0; b < benchmarks.size(); b++) {
+    const Benchmark &benchmark = *benchmarks[b];
+    if (benchmark.setUp != nullptr) {
+      benchmark.setUp();
+    }
+    benchmark.run(WARM_UP_ITERATIONS);
+
+    // Enough iterations for each sample to last minSampleNanoseconds, for the clock resolution and the noise to not matter
+    unsigned long iterations = WARM_UP_ITERATIONS;
+    double nanoseconds;
+    while ((nanoseconds = measure(benchmark, iterations).nanosecondsPerOperation * iterations) < minSampleNanoseconds) {
+      const double scale = nanoseconds > 0 ? 1.2 * minSampleNanoseconds / nanoseconds : 100;
+      iterations = (unsigned long) (iterations * constrain(scale, 2.0, 100.0)); // Arduino.h replaces std::min() and std::max() with its macros
+    }
+
+    std::vector<BenchmarkSample> samples;
+    for (unsigned int i = 0; i < sampleCount; i++) {
+      samples.push_back(measure(benchmark, iterations));
+    }
+    std::sort(samples.begin(), samples.end(), [](const BenchmarkSample &sample1, const BenchmarkSample &sample2) {
+      return sample1.nanosecondsPerOperation < sample2.nanosecondsPerOperation;
+    });
+    const BenchmarkSample &median = samples[samples.size() / 2];
+
+    printf("%s\n    { \"name\": ", b == 0 ? "" : ",");
+    printJsonString(benchmark.name);
+    printf(", \"iterations\": %lu, \"nsPerOp\": %.3f, \"minNsPerOp\": %.3f", iterations, median.nanosecondsPerOperation, samples.front().nanosecondsPerOperation);
+#ifdef HAS_CYCLE_COUNTER
+    printf(", \"cyclesPerOp\": %.1f", median.cyclesPerOperation);
+#endif
+    printf(" }");
+    fflush(stdout);
+  }
+
+  printf("\n  ]\n}\n");
+  delete controllerBoard;
+  return 0;
+}
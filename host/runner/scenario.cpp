@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host-ether.h"
+#include "scenario.h"
+#include "sketch-pins.h"
+
+const uint64_t DEFAULT_PRESS_DURATION_MS = 200;
+
+std::string joinWords(const std::vector<std::string> &words, size_t first)
+{
+  std::string text;
+  for (size_t i = first; i < words.size(); i++) {
+    text += (i == first ? "" : " ") + words[i];
+  }
+  return text;
+}
+
+Scenario::Scenario(const std::vector<std::string> &boardNames)
+  : boardNames(boardNames)
+  , millisOffsets(boardNames.size(), 0)
+{
+}
+
+bool Scenario::load(const char *path)
+{
+  this->path = path;
+  std::ifstream file(path);
+  if (!file) {
+    fprintf(stderr, "%s: cannot read\n", path);
+    return false;
+  }
+
+  bool isValid = true;
+  std::string statement;
+  for (int line = 1; std::getline(file, statement); line++) {
+    const size_t comment = statement.find('#');
+    if (comment != std::string::npos) {
+      statement.erase(comment);
+    }
+    isValid = parseStatement(statement, line) && isValid; // Report all the errors
+  }
+  return isValid;
+}
+
+bool Scenario::parseStatement(const std::string &statement, int line)
+{
+  std::istringstream stream(statement);
+  std::vector<std::string> words;
+  std::string word;
+  while (stream >> word) {
+    words.push_back(word);
+  }
+  if (words.empty()) {
+    return true;
+  }
+
+  std::vector<ScenarioEvent> actionEvents;
+  uint64_t time;
+  uint64_t endTime;
+
+  if (words[0] == "duration" && words.size() == 2) {
+    if (!parseTime(words[1], &duration)) {
+      return fail(line, "invalid duration");
+    }
+
+  } else if (words[0] == "millis-start" && words.size() == 3) {
+    int board;
+    if (!parseBoard(words[1], true, &board)) {
+      return fail(line, "unknown board " + words[1]);
+    }
+
+    uint32_t offset;
+    if (words[2].compare(0, 9, "overflow-") == 0) {
+      uint64_t beforeOverflow;
+      if (!parseTime(words[2].substr(9), &beforeOverflow) || beforeOverflow > 0xFFFFFFFFULL + 1) {
+        return fail(line, "invalid time before the overflow");
+      }
+      offset = (uint32_t) (0x100000000ULL - beforeOverflow);
+    } else {
+      char *end;
+      offset = strtoul(words[2].c_str(), &end, 10);
+      if (*end != '\0') {
+        return fail(line, "invalid start of millis()");
+      }
+    }
+    for (size_t i = 0; i < millisOffsets.size(); i++) {
+      if (board == SCENARIO_ALL_BOARDS || (int) i == board) {
+        millisOffsets[i] = offset;
+      }
+    }
+
+  } else if (words[0] == "at" && words.size() >= 3) {
+    if (!parseTime(words[1], &time)) {
+      return fail(line, "invalid time");
+    }
+    if (!parseAction(words, 2, time, line, &actionEvents)) {
+      return false;
+    }
+    for (const ScenarioEvent &event : actionEvents) {
+      addEvent(event);
+    }
+
+  } else if (words[0] == "every" && words.size() >= 7 && words[2] == "from" && words[4] == "until") {
+    uint64_t period;
+    if (!parseTime(words[1], &period) || period == 0 || !parseTime(words[3], &time) || !parseTime(words[5], &endTime)) {
+      return fail(line, "invalid period or times");
+    }
+    if (!parseAction(words, 6, 0, line, &actionEvents)) {
+      return false;
+    }
+    for (; time <= endTime; time += period) {
+      for (ScenarioEvent event : actionEvents) {
+        event.time += time;
+        addEvent(event);
+      }
+    }
+
+  } else if (words[0] == "from" && (words.size() == 5 || words.size() == 6) && words[2] == "to" && words[4] == "radio-drop") {
+    ScenarioEvent event;
+    event.type = ScenarioActionType::SET_RADIO_ISOLATED;
+    event.line = line;
+    event.board = SCENARIO_ALL_BOARDS;
+    if (!parseTime(words[1], &time) || !parseTime(words[3], &endTime) || endTime < time) {
+      return fail(line, "invalid times");
+    }
+    if (words.size() == 6 && !parseBoard(words[5], false, &event.board)) {
+      return fail(line, "unknown board " + words[5]);
+    }
+    event.time = time;
+    event.level = true;
+    addEvent(event);
+    event.time = endTime;
+    event.level = false;
+    addEvent(event);
+
+  } else {
+    return fail(line, "invalid statement");
+  }
+  return true;
+}
+
+bool Scenario::parseAction(const std::vector<std::string> &words, size_t first, uint64_t time, int line, std::vector<ScenarioEvent> *actionEvents)
+{
+  const std::string &action = words[first];
+  const size_t argumentCount = words.size() - first - 1;
+
+  ScenarioEvent event;
+  event.time = time;
+  event.line = line;
+
+  if (action == "door" && (argumentCount == 1 || argumentCount == 3) && (words[first + 1] == "open" || words[first + 1] == "close")) {
+    uint64_t duration = 0;
+    if (argumentCount == 3 && (words[first + 2] != "for" || !parseTime(words[first + 3], &duration))) {
+      return fail(line, "invalid duration");
+    }
+    event.board = findBoardWithPin("door-sensor-1");
+    if (event.board == SCENARIO_ALL_BOARDS) {
+      return fail(line, "no board with door sensors");
+    }
+
+    event.type = ScenarioActionType::SET_INPUT;
+    event.level = (words[first + 1] == "open" ? 0 : 1); // The sensors are pressed while the door is open
+    for (int repeat = 0; repeat < (argumentCount == 3 ? 2 : 1); repeat++) {
+      parsePin(event.board, "door-sensor-1", &event.pin);
+      actionEvents->push_back(event);
+      parsePin(event.board, "door-sensor-2", &event.pin);
+      actionEvents->push_back(event);
+      event.time += duration;
+      event.level = !event.level;
+    }
+    return true;
+  }
+
+  if (argumentCount < 1 || !parseBoard(words[first + 1], false, &event.board)) {
+    return fail(line, argumentCount < 1 ? "missing board" : "unknown board " + words[first + 1]);
+  }
+
+  if (action == "press" && (argumentCount == 2 || argumentCount == 4)) {
+    uint64_t duration = DEFAULT_PRESS_DURATION_MS;
+    if (!parsePin(event.board, words[first + 2], &event.pin)) {
+      return fail(line, "unknown pin " + words[first + 2]);
+    }
+    if (argumentCount == 4 && (words[first + 3] != "for" || !parseTime(words[first + 4], &duration))) {
+      return fail(line, "invalid duration");
+    }
+    event.type = ScenarioActionType::SET_INPUT;
+    event.level = 0;
+    actionEvents->push_back(event);
+    event.time += duration;
+    event.level = 1;
+    actionEvents->push_back(event);
+
+  } else if (action == "input" && argumentCount == 3 && (words[first + 3] == "high" || words[first + 3] == "low")) {
+    if (!parsePin(event.board, words[first + 2], &event.pin)) {
+      return fail(line, "unknown pin " + words[first + 2]);
+    }
+    event.type = ScenarioActionType::SET_INPUT;
+    event.level = (words[first + 3] == "high");
+    actionEvents->push_back(event);
+
+  } else if (action == "serial" && argumentCount >= 2) {
+    event.type = ScenarioActionType::WRITE_SERIAL;
+    event.text = joinWords(words, first + 2);
+    actionEvents->push_back(event);
+
+  } else if (action == "radio-lockup" && argumentCount == 1) {
+    event.type = ScenarioActionType::SET_RADIO_LOCKED_UP;
+    event.level = true;
+    actionEvents->push_back(event);
+
+  } else if ((action == "restart" || action == "power-cycle") && argumentCount == 1) {
+    event.type = ScenarioActionType::RESTART;
+    event.level = (action == "power-cycle");
+    actionEvents->push_back(event);
+
+  } else if (action == "link" && argumentCount == 3) {
+    int toBoard;
+    HostLinkConditions conditions;
+    if (!parseBoard(words[first + 2], true, &toBoard)) {
+      return fail(line, "unknown board " + words[first + 2]);
+    }
+    if (!HostEther::parseLinkConditions(words[first + 3].c_str(), &conditions)) {
+      return fail(line, "invalid link conditions " + words[first + 3]);
+    }
+    event.type = ScenarioActionType::SET_LINK_CONDITIONS;
+    event.pin = (toBoard == SCENARIO_ALL_BOARDS ? SCENARIO_ALL_BOARDS_PIN : toBoard);
+    event.text = words[first + 3];
+    actionEvents->push_back(event);
+
+  } else if (action == "expect" && argumentCount >= 3 && (words[first + 2] == "printed" || words[first + 2] == "not-printed")) {
+    event.type = (words[first + 2] == "printed" ? ScenarioActionType::EXPECT_PRINTED : ScenarioActionType::EXPECT_NOT_PRINTED);
+    event.text = joinWords(words, first + 3);
+    actionEvents->push_back(event);
+
+  } else if (action == "expect" && argumentCount == 4 && words[first + 2] == "pin") {
+    if (!parsePin(event.board, words[first + 3], &event.pin)) {
+      return fail(line, "unknown pin " + words[first + 3]);
+    }
+    const std::string &expected = words[first + 4];
+    if (expected == "high" || expected == "low") {
+      event.type = ScenarioActionType::EXPECT_PIN_LEVEL;
+      event.level = (expected == "high");
+    } else if (expected == "changed") {
+      event.type = ScenarioActionType::EXPECT_PIN_CHANGED;
+    } else if (expected == "unchanged") {
+      event.type = ScenarioActionType::EXPECT_PIN_UNCHANGED;
+    } else {
+      return fail(line, "invalid pin expectation " + expected);
+    }
+    actionEvents->push_back(event);
+
+  } else if (action == "expect" && argumentCount == 2 && words[first + 2] == "tone") {
+    event.type = ScenarioActionType::EXPECT_TONE;
+    actionEvents->push_back(event);
+
+  } else {
+    return fail(line, "invalid action " + action);
+  }
+  return true;
+}
+
+bool Scenario::parseTime(const std::string &text, uint64_t *time)
+{
+  static const struct {
+    const char *suffix;
+    uint64_t milliseconds;
+  } UNITS[] = { { "ms", 1 }, { "s", 1000 }, { "m", 60000 }, { "h", 3600000 }, { "d", 86400000 } };
+
+  *time = 0;
+  size_t start = 0;
+  while (start <= text.size()) {
+    size_t end = text.find('+', start);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    const std::string term = text.substr(start, end - start);
+
+    char *unit;
+    const uint64_t value = strtoull(term.c_str(), &unit, 10);
+    if (unit == term.c_str()) {
+      return false;
+    }
+    uint64_t milliseconds = 0;
+    for (const auto &candidate : UNITS) {
+      if (strcmp(unit, candidate.suffix) == 0 || (*unit == '\0' && candidate.milliseconds == 1)) {
+        milliseconds = candidate.milliseconds;
+      }
+    }
+    if (milliseconds == 0) {
+      return false;
+    }
+    *time += value * milliseconds;
+    start = end + 1;
+  }
+  return true;
+}
+
+void Scenario::setDuration(uint64_t duration)
+{
+  this->duration = duration;
+}
+
+uint64_t Scenario::getDuration() const
+{
+  return duration;
+}
+
+void Scenario::addEvent(const ScenarioEvent &event)
+{
+  isSorted = isSorted && (events.empty() || events.back().time <= event.time);
+  events.push_back(event);
+}
+
+const std::vector<ScenarioEvent> &Scenario::getEvents()
+{
+  if (!isSorted) {
+    std::stable_sort(events.begin(), events.end(), [](const ScenarioEvent &a, const ScenarioEvent &b) {
+      return a.time < b.time;
+    });
+    isSorted = true;
+  }
+  return events;
+}
+
+uint32_t Scenario::getMillisOffset(int board) const
+{
+  return millisOffsets[board];
+}
+
+const std::string &Scenario::getBoardName(int board) const
+{
+  return boardNames[board];
+}
+
+bool Scenario::parseBoard(const std::string &name, bool allowAll, int *board) const
+{
+  if (allowAll && name == "all") {
+    *board = SCENARIO_ALL_BOARDS;
+    return true;
+  }
+  for (size_t i = 0; i < boardNames.size(); i++) {
+    if (boardNames[i] == name || boardNames[i] == "door-" + name) {
+      *board = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Scenario::parsePin(int board, const std::string &name, uint8_t *pin) const
+{
+  *pin = findSketchPin(findSketchPins(boardNames[board].c_str()), name.c_str());
+  return *pin != NO_SKETCH_PIN;
+}
+
+int Scenario::findBoardWithPin(const char *pinName) const
+{
+  for (size_t i = 0; i < boardNames.size(); i++) {
+    const SketchPins *sketchPins = findSketchPins(boardNames[i].c_str());
+    if (sketchPins != nullptr && findSketchPin(sketchPins, pinName) != NO_SKETCH_PIN) {
+      return i;
+    }
+  }
+  return SCENARIO_ALL_BOARDS;
+}
+
+bool Scenario::fail(int line, const std::string &message) const
+{
+  fprintf(stderr, "%s:%d: %s\n", path.empty() ? "scenario" : path.c_str(), line, message.c_str());
+  return false;
+}
@@ -0,0 +1,103 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+const int SCENARIO_ALL_BOARDS = -1;
+const uint8_t SCENARIO_ALL_BOARDS_PIN = 0xFF; // For the destination board of SET_LINK_CONDITIONS
+
+enum class ScenarioActionType : uint8_t {
+  SET_INPUT,
+  WRITE_SERIAL,
+  SET_RADIO_LOCKED_UP,
+  SET_RADIO_ISOLATED, // Of one board, or of all of them (jamming the air)
+  SET_LINK_CONDITIONS, // Of the frames sent by the board to the board in pin, in text (see HostEther::parseLinkConditions())
+  RESTART,
+  EXPECT_PRINTED,
+  EXPECT_NOT_PRINTED,
+  EXPECT_PIN_LEVEL,
+  EXPECT_PIN_CHANGED,
+  EXPECT_PIN_UNCHANGED,
+  EXPECT_TONE
+};
+
+/**
+ * Something happening to a board at a given time of a simulation, or an expectation about a board to check at this time.
+ * Expectations cover what happened since the previous expectations about the same board (or since the start).
+ */
+struct ScenarioEvent
+{
+  uint64_t time; // Of HostClock
+  ScenarioActionType type;
+  int board; // Index in the board names given to Scenario, or SCENARIO_ALL_BOARDS
+  uint8_t pin = 0;
+  uint8_t level = 0; // Also the state of radio lockups and isolations, and whether restarts cut the power
+  std::string text; // To write to the serial port, or expected in the printed lines
+  int line = 0; // In the scenario file, to report failed expectations
+};
+
+/**
+ * A script of events, read from a text file with one statement per line ('#' starts a comment):
+ *
+ *   duration <time>                                  how long the simulation runs (1h by default)
+ *   millis-start <board>|all <value>|overflow-<time> where millis() starts, e.g. overflow-5m starts 5 minutes before its overflow
+ *   at <time> <action>
+ *   every <period> from <time> until <time> <action> at each period, until the time included
+ *   from <time> to <time> radio-drop [<board>]       the radio of the board (or all of them) neither sends nor receives
+ *
+ * Times add up durations with units: 1500ms, 10s, 5m, 2h, 100d, 2d+3h...
+ * Boards are named by their sketch name, with or without its "door-" prefix. Pins are numbers, A0~A7, or names (see sketch-pins.h).
+ *
+ * Actions:
+ *   door open|close [for <time>]              both door sensors of the board having them (then the opposite after the time)
+ *   press <board> <pin> [for <time>]          a button, released after the time (200ms by default)
+ *   input <board> <pin> high|low
+ *   serial <board> <text>                     sent to its serial port
+ *   radio-lockup <board>                      its radio locks up, until power-cycled
+ *   restart <board>                           resets its microcontroller (like the former Restarter of the dashboard did)
+ *   power-cycle <board>                       cuts its power, radio included, and restarts it
+ *   link <board> <board>|all <conditions>     the conditions of the frames sent by the first board, e.g. latency=5ms,jitter=2ms,loss=0.1
+ *                                             (see HostEther::parseLinkConditions()): "at 0 link ..." for the whole scenario
+ *   expect <board> printed|not-printed <text> a line containing the text was printed, or not
+ *   expect <board> pin <pin> high|low|changed|unchanged
+ *   expect <board> tone                       a tone started
+ */
+class Scenario {
+  public:
+    Scenario(const std::vector<std::string> &boardNames);
+
+    /**
+     * False, with the errors printed, if the file cannot be read or has invalid statements.
+     */
+    bool load(const char *path);
+    bool parseStatement(const std::string &statement, int line);
+
+    void setDuration(uint64_t duration);
+    uint64_t getDuration() const;
+
+    void addEvent(const ScenarioEvent &event);
+    const std::vector<ScenarioEvent> &getEvents(); // Sorted by time, then by order of addition
+
+    uint32_t getMillisOffset(int board) const;
+    const std::string &getBoardName(int board) const;
+
+    static bool parseTime(const std::string &text, uint64_t *time);
+
+  private:
+    std::vector<std::string> boardNames;
+    std::vector<uint32_t> millisOffsets;
+    uint64_t duration = 3600000;
+    std::vector<ScenarioEvent> events;
+    bool isSorted = true;
+    std::string path;
+
+    bool parseAction(const std::vector<std::string> &words, size_t first, uint64_t time, int line, std::vector<ScenarioEvent> *actionEvents);
+    bool parseBoard(const std::string &name, bool allowAll, int *board) const;
+    bool parsePin(int board, const std::string &name, uint8_t *pin) const;
+    int findBoardWithPin(const char *pinName) const;
+    bool fail(int line, const std::string &message) const;
+};
+
+#endif
@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "host-clock.h"
+#include "host-ether.h"
+#include "simulation.h"
+#include "sketch-pins.h"
+
+std::string sketchName(const char *sketchLibraryPath)
+{
+  std::string name = sketchLibraryPath;
+  const size_t slash = name.rfind('/');
+  if (slash != std::string::npos) {
+    name = name.substr(slash + 1);
+  }
+  const size_t extension = name.rfind(".so");
+  return extension == std::string::npos ? name : name.substr(0, extension);
+}
+
+Simulation::~Simulation()
+{
+  for (SimulatedBoard *simulatedBoard : boards) {
+    delete simulatedBoard->board;
+    delete simulatedBoard;
+  }
+  HostEther::reset();
+}
+
+bool Simulation::addBoard(const char *sketchLibraryPath, const char *eepromFile)
+{
+  SimulatedBoard *simulatedBoard = new SimulatedBoard();
+  simulatedBoard->simulation = this;
+  simulatedBoard->index = boards.size();
+  simulatedBoard->board = new HostBoard(sketchName(sketchLibraryPath).c_str());
+  boards.push_back(simulatedBoard);
+
+  HostBoard *board = simulatedBoard->board;
+  if (!board->load(sketchLibraryPath) || (eepromFile != nullptr && !board->setEepromFile(eepromFile))) {
+    return false;
+  }
+  board->setSerialListener(&onSerialLine, simulatedBoard);
+  board->setPinListener(&onPinChange, simulatedBoard);
+
+  const SketchPins *sketchPins = findSketchPins(board->getName());
+  if (sketchPins != nullptr && sketchPins->radioIrqPin != NO_SKETCH_PIN) {
+    board->getRadio()->setIrqPin(sketchPins->radioIrqPin);
+  }
+  return true;
+}
+
+std::vector<std::string> Simulation::getBoardNames() const
+{
+  std::vector<std::string> names;
+  for (const SimulatedBoard *simulatedBoard : boards) {
+    names.push_back(simulatedBoard->board->getName());
+  }
+  return names;
+}
+
+HostBoard *Simulation::getBoard(int board)
+{
+  return boards[board]->board;
+}
+
+void Simulation::setVerbose(bool isVerbose)
+{
+  this->isVerbose = isVerbose;
+}
+
+void Simulation::setTracePins(bool tracePins)
+{
+  this->tracePins = tracePins;
+}
+
+void Simulation::setLineListener(void (*listener)(int board, const char *line, void *context), void *context)
+{
+  lineListener = listener;
+  lineListenerContext = context;
+}
+
+void Simulation::setPinListener(void (*listener)(int board, uint8_t pin, uint8_t level, void *context), void *context)
+{
+  pinListener = listener;
+  pinListenerContext = context;
+}
+
+bool Simulation::run(Scenario *scenario)
+{
+  HostClock::reset();
+  for (SimulatedBoard *simulatedBoard : boards) {
+    simulatedBoard->board->setMillisOffset(scenario->getMillisOffset(simulatedBoard->index));
+    checkpoint(simulatedBoard);
+  }
+  for (SimulatedBoard *simulatedBoard : boards) {
+    simulatedBoard->board->setup();
+  }
+
+  const std::vector<ScenarioEvent> &events = scenario->getEvents();
+  size_t nextEvent = 0;
+  unsigned int sameTimeLoops = 0;
+  const unsigned int initialFailedCount = failedExpectationCount;
+
+  while (true) {
+    uint64_t time = (nextEvent < events.size() ? events[nextEvent].time : UINT64_MAX);
+    if (!timers.empty() && timers.front().time < time) {
+      time = timers.front().time;
+    }
+    const uint64_t deliveryTime = HostEther::nextDeliveryTime();
+    if (deliveryTime < time) {
+      time = deliveryTime;
+    }
+    for (const SimulatedBoard *simulatedBoard : boards) {
+      const uint64_t wakeUpTime = simulatedBoard->board->getNextWakeUpTime();
+      if (wakeUpTime < time) {
+        time = wakeUpTime;
+      }
+    }
+    if (time >= scenario->getDuration()) {
+      break;
+    }
+
+    if (time <= HostClock::now()) {
+      time = HostClock::now();
+      if (++sameTimeLoops > MAX_LOOPS_PER_MS) {
+        time++; // Like a real board, on which a loop() takes some time
+        sameTimeLoops = 0;
+      }
+    } else {
+      sameTimeLoops = 0;
+    }
+    HostClock::advanceTo(time);
+    HostEther::deliver();
+
+    for (; nextEvent < events.size() && events[nextEvent].time <= time; nextEvent++) {
+      apply(events[nextEvent]);
+    }
+    while (!timers.empty() && timers.front().time <= time) {
+      const Timer timer = timers.front(); // Its callback can schedule other timers
+      timers.erase(timers.begin());
+      timer.callback(timer.context);
+    }
+    for (SimulatedBoard *simulatedBoard : boards) {
+      if (simulatedBoard->expectationChecked) {
+        checkpoint(simulatedBoard); // After all the expectations of this time
+      }
+    }
+
+    for (SimulatedBoard *simulatedBoard : boards) {
+      if (simulatedBoard->board->getNextWakeUpTime() <= time) {
+        simulatedBoard->board->loop();
+        loopCount++;
+      }
+    }
+  }
+
+  HostClock::advanceTo(scenario->getDuration());
+  timers.clear();
+  return failedExpectationCount == initialFailedCount;
+}
+
+void Simulation::schedule(uint64_t time, void (*callback)(void *context), void *context)
+{
+  std::vector<Timer>::iterator position = timers.end();
+  while (position != timers.begin() && (position - 1)->time > time) {
+    position--;
+  }
+  timers.insert(position, { time, callback, context });
+}
+
+uint64_t Simulation::getLoopCount() const
+{
+  return loopCount;
+}
+
+unsigned int Simulation::getPassedExpectationCount() const
+{
+  return passedExpectationCount;
+}
+
+unsigned int Simulation::getFailedExpectationCount() const
+{
+  return failedExpectationCount;
+}
+
+void Simulation::apply(const ScenarioEvent &event)
+{
+  SimulatedBoard *simulatedBoard = (event.board == SCENARIO_ALL_BOARDS ? nullptr : boards[event.board]);
+  HostBoard *board = (simulatedBoard == nullptr ? nullptr : simulatedBoard->board);
+
+  switch (event.type) {
+    case ScenarioActionType::SET_INPUT:
+      board->setInput(event.pin, event.level);
+      break;
+
+    case ScenarioActionType::WRITE_SERIAL:
+      board->writeSerial(event.text.c_str());
+      break;
+
+    case ScenarioActionType::SET_RADIO_LOCKED_UP:
+      board->getRadio()->setLockedUp(event.level);
+      break;
+
+    case ScenarioActionType::SET_RADIO_ISOLATED:
+      if (board == nullptr) {
+        HostEther::setJammed(event.level);
+      } else {
+        board->getRadio()->setIsolated(event.level);
+      }
+      break;
+
+    case ScenarioActionType::SET_LINK_CONDITIONS: {
+      HostLinkConditions conditions;
+      HostEther::parseLinkConditions(event.text.c_str(), &conditions); // Already validated by Scenario
+      const uint8_t toRadioId = (event.pin == SCENARIO_ALL_BOARDS_PIN ? HOST_ETHER_ANY_RADIO : boards[event.pin]->board->getRadio()->getRadioId());
+      HostEther::setLinkConditions(board->getRadio()->getRadioId(), toRadioId, conditions);
+      break;
+    }
+
+    case ScenarioActionType::RESTART:
+      if (event.level) {
+        board->getRadio()->cutPower(true); // Clearing a lockup
+        board->getRadio()->cutPower(false);
+      }
+      board->restart();
+      break;
+
+    default: {
+      std::string failure;
+      if (check(event, simulatedBoard, &failure)) {
+        passedExpectationCount++;
+      } else {
+        failedExpectationCount++;
+        printf("[%10llu ms] %s: FAILED expectation of line %d: %s\n",
+          (unsigned long long) HostClock::now(), board->getName(), event.line, failure.c_str());
+      }
+      simulatedBoard->expectationChecked = true;
+    }
+  }
+}
+
+bool Simulation::check(const ScenarioEvent &event, SimulatedBoard *simulatedBoard, std::string *failure)
+{
+  const HostPin *pin = simulatedBoard->board->getPin(event.pin);
+
+  switch (event.type) {
+    case ScenarioActionType::EXPECT_PRINTED:
+    case ScenarioActionType::EXPECT_NOT_PRINTED: {
+      bool printed = false;
+      for (const std::string &line : simulatedBoard->lines) {
+        printed = printed || line.find(event.text) != std::string::npos;
+      }
+      *failure = (printed ? "printed \"" : "did not print \"") + event.text + "\"";
+      return printed == (event.type == ScenarioActionType::EXPECT_PRINTED);
+    }
+
+    case ScenarioActionType::EXPECT_PIN_LEVEL:
+      *failure = "pin " + std::to_string(event.pin) + (pin->outputLevel ? " is HIGH" : " is LOW");
+      return pin->outputLevel == event.level;
+
+    case ScenarioActionType::EXPECT_PIN_CHANGED:
+    case ScenarioActionType::EXPECT_PIN_UNCHANGED: {
+      const bool changed = (pin->changeCount != simulatedBoard->pinChangeCounts[event.pin]);
+      *failure = "pin " + std::to_string(event.pin) + (changed ? " changed" : " did not change");
+      return changed == (event.type == ScenarioActionType::EXPECT_PIN_CHANGED);
+    }
+
+    case ScenarioActionType::EXPECT_TONE:
+      *failure = "no tone started";
+      return simulatedBoard->board->getToneStartCount() != simulatedBoard->toneStartCount;
+
+    default:
+      *failure = "unknown expectation";
+      return false;
+  }
+}
+
+void Simulation::checkpoint(SimulatedBoard *simulatedBoard)
+{
+  simulatedBoard->lines.clear();
+  for (uint8_t pin = 0; pin < HOST_BOARD_PIN_COUNT; pin++) {
+    simulatedBoard->pinChangeCounts[pin] = simulatedBoard->board->getPin(pin)->changeCount;
+  }
+  simulatedBoard->toneStartCount = simulatedBoard->board->getToneStartCount();
+  simulatedBoard->expectationChecked = false;
+}
+
+void Simulation::onSerialLine(HostBoard *board, const char *line, void *context)
+{
+  SimulatedBoard *simulatedBoard = (SimulatedBoard *) context;
+  Simulation *simulation = simulatedBoard->simulation;
+
+  if (simulatedBoard->lines.size() == MAX_KEPT_LINES) {
+    simulatedBoard->lines.erase(simulatedBoard->lines.begin());
+  }
+  simulatedBoard->lines.push_back(line);
+
+  if (simulation->isVerbose) {
+    printf("[%10llu ms] %s: %s\n", (unsigned long long) HostClock::now(), board->getName(), line);
+  }
+  if (simulation->lineListener != nullptr) {
+    simulation->lineListener(simulatedBoard->index, line, simulation->lineListenerContext);
+  }
+}
+
+void Simulation::onPinChange(HostBoard *board, uint8_t pin, uint8_t level, void *context)
+{
+  SimulatedBoard *simulatedBoard = (SimulatedBoard *) context;
+  Simulation *simulation = simulatedBoard->simulation;
+
+  if (simulation->pinListener != nullptr) {
+    simulation->pinListener(simulatedBoard->index, pin, level, simulation->pinListenerContext);
+  }
+  if (!simulation->tracePins) {
+    return;
+  }
+  printf("[%10llu ms] %s: pin %u %s\n", (unsigned long long) HostClock::now(), board->getName(), pin, level ? "HIGH" : "LOW");
+}
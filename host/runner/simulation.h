@@ -0,0 +1,102 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "host-board.h"
+#include "scenario.h"
+
+/**
+ * Boards running a Scenario in virtual time, as a discrete-event simulation: instead of advancing HostClock millisecond by millisecond,
+ * it jumps to the next event of the scenario, to the next frame HostEther delivers, or to the earliest deadline a board sleeps until
+ * (see HostBoard::getNextWakeUpTime()),
+ * so days of idle boards take a fraction of a second. The radios of the boards are linked by HostEther, and wired to an IRQ pin when
+ * the sketch has one (see sketch-pins.h), so that boards sleep rather than poll their radio.
+ * Each thread runs its own simulations, one at a time: the link conditions of HostEther are reset at the end of each one.
+ */
+class Simulation {
+  public:
+    ~Simulation();
+
+    /**
+     * False, with the reason printed, if the sketch cannot be loaded. The name of the board is the name of the library, without its extension.
+     */
+    bool addBoard(const char *sketchLibraryPath, const char *eepromFile = nullptr);
+    std::vector<std::string> getBoardNames() const;
+    HostBoard *getBoard(int board);
+
+    void setVerbose(bool isVerbose); // Print the lines printed by the boards
+    void setTracePins(bool tracePins); // Print the changes of their output pins
+
+    /**
+     * Called with each line printed by a board, e.g. to measure when it changes state.
+     */
+    void setLineListener(void (*listener)(int board, const char *line, void *context), void *context);
+
+    /**
+     * Called at each change of an output pin of a board, e.g. to measure when a relay closes.
+     */
+    void setPinListener(void (*listener)(int board, uint8_t pin, uint8_t level, void *context), void *context);
+
+    /**
+     * Set up the boards and run them until the end of the scenario: false if an expectation failed (failures are printed).
+     */
+    bool run(Scenario *scenario);
+
+    /**
+     * Call back at the given time of the next or running scenario (before the boards loop at this time), e.g. for a door
+     * to close some time after a listener saw its motor powered. Timers left are forgotten at the end of the run.
+     */
+    void schedule(uint64_t time, void (*callback)(void *context), void *context);
+
+    uint64_t getLoopCount() const; // Calls to the loop() of the boards
+    unsigned int getPassedExpectationCount() const;
+    unsigned int getFailedExpectationCount() const;
+
+  private:
+    // A board looping without sleeping does not stop the simulation: after these loops in the same millisecond, time advances
+    static const unsigned int MAX_LOOPS_PER_MS = 8;
+    static const size_t MAX_KEPT_LINES = 1000; // Printed since the last expectation about the board
+
+    struct SimulatedBoard
+    {
+      Simulation *simulation;
+      int index;
+      HostBoard *board;
+      std::vector<std::string> lines;
+      unsigned long pinChangeCounts[HOST_BOARD_PIN_COUNT];
+      unsigned long toneStartCount;
+      bool expectationChecked;
+    };
+
+    std::vector<SimulatedBoard *> boards;
+    bool isVerbose = false;
+    bool tracePins = false;
+    void (*lineListener)(int board, const char *line, void *context) = nullptr;
+    void *lineListenerContext = nullptr;
+    void (*pinListener)(int board, uint8_t pin, uint8_t level, void *context) = nullptr;
+    void *pinListenerContext = nullptr;
+
+    struct Timer
+    {
+      uint64_t time;
+      void (*callback)(void *context);
+      void *context;
+    };
+
+    std::vector<Timer> timers; // Sorted by time, then by order of scheduling
+    uint64_t loopCount = 0;
+    unsigned int passedExpectationCount = 0;
+    unsigned int failedExpectationCount = 0;
+
+    void apply(const ScenarioEvent &event);
+    bool check(const ScenarioEvent &event, SimulatedBoard *simulatedBoard, std::string *failure);
+    void checkpoint(SimulatedBoard *simulatedBoard); // Expectations cover what happens from now on
+
+    static void onSerialLine(HostBoard *board, const char *line, void *context);
+    static void onPinChange(HostBoard *board, uint8_t pin, uint8_t level, void *context);
+};
+
+#endif
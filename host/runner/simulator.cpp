@@ -0,0 +1,115 @@
+// Runs scenarios on the controller and the dashboard, in virtual time skipping to the next deadline (see Simulation and Scenario):
+// days of use in seconds, with the expectations of the scenarios checked
+// usage: simulator [--verbose] [--trace-pins] [--eeprom-dir <dir>] [--sketch <sketch.so>]... <scenario>...
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+#include "host-clock.h"
+#include "scenario.h"
+#include "simulation.h"
+
+const char *DEFAULT_SKETCHES[] = { "door-controller.so", "door-dashboard.so" };
+
+double wallTime()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+std::string directoryOf(const char *path)
+{
+  const char *slash = strrchr(path, '/');
+  return slash == nullptr ? "." : std::string(path, slash - path);
+}
+
+int usage(const char *program)
+{
+  fprintf(stderr, "usage: %s [--verbose] [--trace-pins] [--eeprom-dir <dir>] [--sketch <sketch.so>]... <scenario>...\n", program);
+  fprintf(stderr, "By default, the sketches are %s and %s, next to %s\n", DEFAULT_SKETCHES[0], DEFAULT_SKETCHES[1], program);
+  return 2;
+}
+
+bool runScenario(const char *scenarioPath, const std::vector<std::string> &sketchLibraryPaths, const char *eepromDirectory, bool isVerbose, bool tracePins)
+{
+  Simulation simulation;
+  for (const std::string &path : sketchLibraryPaths) {
+    if (!simulation.addBoard(path.c_str())) {
+      return false;
+    }
+    if (eepromDirectory != nullptr) {
+      HostBoard *board = simulation.getBoard(simulation.getBoardNames().size() - 1);
+      if (!board->setEepromFile((std::string(eepromDirectory) + "/" + board->getName() + ".eeprom").c_str())) {
+        return false;
+      }
+    }
+  }
+  simulation.setVerbose(isVerbose);
+  simulation.setTracePins(tracePins);
+
+  Scenario scenario(simulation.getBoardNames());
+  if (!scenario.load(scenarioPath)) {
+    return false;
+  }
+
+  printf("%s\n", scenarioPath);
+  const double startTime = wallTime();
+  const bool passed = simulation.run(&scenario);
+  const double elapsedTime = wallTime() - startTime;
+
+  const double simulatedTime = HostClock::now() / 1000.0;
+  printf("  %.0f s simulated (%.1f days) in %.3f s: %.0f times faster than real time, %llu loops\n",
+    simulatedTime, simulatedTime / 86400, elapsedTime, simulatedTime / (elapsedTime > 0 ? elapsedTime : 1e-9),
+    (unsigned long long) simulation.getLoopCount());
+  printf("  %u expectations passed, %u failed\n", simulation.getPassedExpectationCount(), simulation.getFailedExpectationCount());
+  return passed;
+}
+
+int main(int argc, char **argv)
+{
+  bool isVerbose = false;
+  bool tracePins = false;
+  const char *eepromDirectory = nullptr;
+  std::vector<std::string> sketchLibraryPaths;
+  std::vector<const char *> scenarioPaths;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--verbose") == 0) {
+      isVerbose = true;
+    } else if (strcmp(argv[i], "--trace-pins") == 0) {
+      tracePins = true;
+    } else if (strcmp(argv[i], "--eeprom-dir") == 0 && i + 1 < argc) {
+      eepromDirectory = argv[++i];
+    } else if (strcmp(argv[i], "--sketch") == 0 && i + 1 < argc) {
+      sketchLibraryPaths.push_back(argv[++i]);
+    } else if (argv[i][0] == '-') {
+      return usage(argv[0]);
+    } else {
+      scenarioPaths.push_back(argv[i]);
+    }
+  }
+  if (scenarioPaths.empty()) {
+    return usage(argv[0]);
+  }
+  if (sketchLibraryPaths.empty()) {
+    for (const char *sketch : DEFAULT_SKETCHES) {
+      sketchLibraryPaths.push_back(directoryOf(argv[0]) + "/" + sketch);
+    }
+  }
+
+  unsigned int failedCount = 0;
+  for (const char *scenarioPath : scenarioPaths) {
+    if (!runScenario(scenarioPath, sketchLibraryPaths, eepromDirectory, isVerbose, tracePins)) {
+      failedCount++;
+    }
+  }
+
+  if (scenarioPaths.size() > 1) {
+    printf("%u of %zu scenarios failed\n", failedCount, scenarioPaths.size());
+  }
+  return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#ifndef SKETCH_PINS_H
+#define SKETCH_PINS_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Set by the Makefile: free pins of each board, wired to the IRQ pin of its simulated radio (see WIRELESS_IRQ_PIN in hardware.h)
+#ifndef DOOR_CONTROLLER_RADIO_IRQ_PIN
+#define DOOR_CONTROLLER_RADIO_IRQ_PIN 0xFF
+#endif
+#ifndef DOOR_DASHBOARD_RADIO_IRQ_PIN
+#define DOOR_DASHBOARD_RADIO_IRQ_PIN 0xFF
+#endif
+
+const uint8_t NO_SKETCH_PIN = 0xFF;
+
+struct SketchPin
+{
+  const char *name;
+  uint8_t pin;
+};
+
+/**
+ * How the pins of a sketch are wired, as configured in its hardware.h: to drive and check a board by names rather than pin numbers.
+ */
+struct SketchPins
+{
+  const char *sketchName; // The name of the board running it, from the name of its library (e.g. door-controller)
+  uint8_t radioIrqPin;
+  const SketchPin *pins; // Inputs then outputs, ending with a nullptr name
+};
+
+// Buttons and door sensors are pressed when LOW (pull-up resistors)
+const SketchPin DOOR_CONTROLLER_PINS[] = {
+  { "keep-open", 19 }, // A5
+  { "door-sensor-1", 7 },
+  { "door-sensor-2", 8 },
+  { "kept-open-led", 3 },
+  { "disconnected-led", 6 },
+  { "relay-1", 16 }, // A2
+  { "relay-2", 17 }, // A3
+  { nullptr, NO_SKETCH_PIN }
+};
+
+const SketchPin DOOR_DASHBOARD_PINS[] = {
+  { "keep-open", 19 }, // A5
+  { "close", 18 }, // A4
+  { "ack", 17 }, // A3
+  { "open-led", 2 },
+  { "kept-open-led", 3 },
+  { "closing-led", 4 },
+  { "auto-closed-led", 5 },
+  { "disconnected-led", 6 },
+  { nullptr, NO_SKETCH_PIN }
+};
+
+const SketchPins SKETCH_PINS[] = {
+  { "door-controller", DOOR_CONTROLLER_RADIO_IRQ_PIN, DOOR_CONTROLLER_PINS },
+  { "door-dashboard", DOOR_DASHBOARD_RADIO_IRQ_PIN, DOOR_DASHBOARD_PINS }
+};
+
+inline const SketchPins *findSketchPins(const char *sketchName)
+{
+  for (const SketchPins &sketchPins : SKETCH_PINS) {
+    if (strcmp(sketchPins.sketchName, sketchName) == 0) {
+      return &sketchPins;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * The pin with this name for the sketch (sketchPins may be nullptr), or a pin number (A0~A7 included): NO_SKETCH_PIN if unknown.
+ */
+inline uint8_t findSketchPin(const SketchPins *sketchPins, const char *name)
+{
+  if (sketchPins != nullptr) {
+    for (const SketchPin *pin = sketchPins->pins; pin->name != nullptr; pin++) {
+      if (strcmp(pin->name, name) == 0) {
+        return pin->pin;
+      }
+    }
+  }
+
+  const bool isAnalog = (name[0] == 'A');
+  char *end;
+  const unsigned long pin = strtoul(isAnalog ? name + 1 : name, &end, 10);
+  if (end == (isAnalog ? name + 1 : name) || *end != '\0' || (isAnalog && pin > 7)) {
+    return NO_SKETCH_PIN;
+  }
+  return isAnalog ? 14 + pin : (pin < 22 ? pin : NO_SKETCH_PIN);
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Stand-in for the Arduino core, to build the sketches on a computer (see host/README.md):
+// the functions act on the board currently running its setup() or loop() (see HostBoard), with the virtual time of HostClock
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARDUINO_ARCH_HOST // Like ARDUINO_ARCH_AVR on the board
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Pins of an Arduino Uno / Nano (ATmega328P)
+const uint8_t A0 = 14;
+const uint8_t A1 = 15;
+const uint8_t A2 = 16;
+const uint8_t A3 = 17;
+const uint8_t A4 = 18;
+const uint8_t A5 = 19;
+const uint8_t A6 = 20;
+const uint8_t A7 = 21;
+const uint8_t LED_BUILTIN = 13;
+const uint8_t HOST_PIN_COUNT = 22;
+
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#ifndef constrain
+#define constrain(x, low, high) ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
+#endif
+
+#define bit(b) (1UL << (b))
+#define bitRead(value, b) (((value) >> (b)) & 0x01)
+#define bitSet(value, b) ((value) |= (1UL << (b)))
+#define bitClear(value, b) ((value) &= ~(1UL << (b)))
+#define bitWrite(value, b, bitValue) ((bitValue) ? bitSet(value, b) : bitClear(value, b))
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+// No separate flash memory on a computer
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_word(address) (*(const uint16_t *) (address))
+#define pgm_read_dword(address) (*(const uint32_t *) (address))
+#define pgm_read_ptr(address) (*(void *const *) (address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+// Port registers, as read by InputBank: ports B, C and D of the ATmega328P, in the numbering of the Arduino core
+#define NOT_A_PIN 0
+#define digitalPinToPort(pin) ((pin) < 8 ? 4 : ((pin) < 14 ? 2 : 3))
+#define digitalPinToBitMask(pin) ((uint8_t) (1 << ((pin) < 8 ? (pin) : ((pin) < 14 ? (pin) - 8 : (pin) - 14))))
+#define portInputRegister(port) (hostPortInputRegister(port))
+volatile uint8_t *hostPortInputRegister(uint8_t port);
+
+// Interrupts are only simulated between two calls to loop() (see HostBoard::setInput()): nothing to disable
+inline void interrupts() {}
+inline void noInterrupts() {}
+
+unsigned long millis(); // 32 bits, as on AVR: overflows after 49.71 days
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+/**
+ * Called by IdleSleeper instead of sleeping, with the timestamp of the earliest deadline (0xFFFFFFFF if none):
+ * a simulation can skip the time until then (see HostBoard::getNextWakeUpTime()).
+ */
+void hostSleepUntil(uint32_t wakeUpTimestamp);
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+/**
+ * Serial port of the current board: what is printed is passed line by line to HostBoard::setSerialListener(),
+ * and what is sent with HostBoard::writeSerial() is available to read.
+ */
+class HostSerial {
+  public:
+    void begin(unsigned long baudRate) {}
+    void end() {}
+    void flush() {}
+    operator bool() const { return true; }
+
+    int available();
+    int read();
+    int peek();
+
+    size_t write(uint8_t value);
+    size_t write(const char *text);
+
+    size_t print(const char *text);
+    size_t print(char value);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    template <typename T> size_t println(T value) { return print(value) + println(); }
+    template <typename T> size_t println(T value, int format) { return print(value, format) + println(); }
+
+  private:
+    size_t printNumber(unsigned long value, int base, bool negative);
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+// Stand-in for the EEPROM library: the EEPROM of the current board (see HostBoard::setEepromFile())
+
+#include <Arduino.h>
+
+class HostEeprom {
+  public:
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value);
+    uint16_t length();
+
+    template <typename T> T &get(int address, T &value)
+    {
+      uint8_t *bytes = (uint8_t *) &value;
+      for (size_t i = 0; i < sizeof(T); i++) {
+        bytes[i] = read(address + i);
+      }
+      return value;
+    }
+
+    template <typename T> const T &put(int address, const T &value)
+    {
+      const uint8_t *bytes = (const uint8_t *) &value;
+      for (size_t i = 0; i < sizeof(T); i++) {
+        update(address + i, bytes[i]);
+      }
+      return value;
+    }
+};
+
+extern HostEeprom EEPROM;
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef NRF_LITE_H
+#define NRF_LITE_H
+
+// Stand-in for the NRFLite library, with the same API: radios of all boards are linked by HostEther
+
+#include <Arduino.h>
+
+class HostRadio;
+
+class NRFLite {
+  public:
+    enum Bitrates { BITRATE2MBPS, BITRATE1MBPS, BITRATE250KBPS };
+    enum SendType { REQUIRE_ACK, NO_ACK };
+
+    NRFLite() {}
+
+    uint8_t init(uint8_t radioId, uint8_t cePin, uint8_t csnPin, Bitrates bitrate = BITRATE2MBPS, uint8_t channel = 100, uint8_t callSpiBegin = 1);
+
+    uint8_t hasData(uint8_t usingInterrupts = 0);
+    uint8_t hasAckData();
+    void readData(void *data);
+    void discardData(uint8_t unexpectedDataLength);
+
+    uint8_t send(uint8_t toRadioId, void *data, uint8_t length, SendType sendType = REQUIRE_ACK);
+    void addAckData(void *data, uint8_t length, uint8_t removeExistingAcks = 0);
+
+    void startRx();
+    void powerDown();
+    uint8_t scanChannel(uint8_t channel, uint8_t measurementCount = 200);
+
+    uint8_t hasDataISR();
+    void startSend(uint8_t toRadioId, void *data, uint8_t length, SendType sendType = REQUIRE_ACK);
+    void whatHappened(uint8_t &txOk, uint8_t &txFail, uint8_t &rxReady);
+
+  private:
+    HostRadio *radio = nullptr; // The one of the board that called init()
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef SPI_H
+#define SPI_H
+
+// Stand-in for the SPI library: only the radio is on the bus (see HostRadio::transferSpi())
+
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0x00
+
+class SPISettings {
+  public:
+    SPISettings() {}
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+class HostSpi {
+  public:
+    void begin() {}
+    void end() {}
+    void beginTransaction(SPISettings settings);
+    void endTransaction() {}
+    uint8_t transfer(uint8_t data);
+};
+
+extern HostSpi SPI;
+
+#endif
@@ -0,0 +1,256 @@
+// The Arduino functions and libraries used by the sketches, acting on the current board
+
+#include <stdio.h>
+
+#include "host-board.h"
+#include "host-clock.h"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <NRFLite.h>
+#include <SPI.h>
+#include <toneAC.h>
+
+HostSerial Serial;
+HostEeprom EEPROM;
+HostSpi SPI;
+
+thread_local unsigned long randomState = 1;
+
+unsigned long millis()
+{
+  return HostBoard::current() != nullptr ? HostBoard::current()->millis() : (uint32_t) HostClock::now();
+}
+
+unsigned long micros()
+{
+  return (uint32_t) (millis() * 1000UL);
+}
+
+void delay(unsigned long ms)
+{
+  HostClock::advance(ms); // The other boards of the simulation do not run meanwhile
+}
+
+void delayMicroseconds(unsigned int us)
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  HostBoard::current()->pinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+  HostBoard::current()->digitalWrite(pin, level);
+}
+
+int digitalRead(uint8_t pin)
+{
+  return HostBoard::current()->digitalRead(pin);
+}
+
+int analogRead(uint8_t pin)
+{
+  return digitalRead(pin) == HIGH ? 1023 : 0;
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+  digitalWrite(pin, value >= 128 ? HIGH : LOW);
+}
+
+void hostSleepUntil(uint32_t wakeUpTimestamp)
+{
+  HostBoard::current()->sleepUntil(wakeUpTimestamp);
+}
+
+volatile uint8_t *hostPortInputRegister(uint8_t port)
+{
+  return HostBoard::current()->getPortInputRegister(port);
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration)
+{
+  HostBoard::current()->setToneFrequency(frequency);
+}
+
+void noTone(uint8_t pin)
+{
+  HostBoard::current()->setToneFrequency(0);
+}
+
+void toneAC(unsigned long frequency, uint8_t volume, unsigned long length, uint8_t background)
+{
+  HostBoard::current()->setToneFrequency(volume == 0 ? 0 : frequency);
+  if (length != PLAY_FOREVER && !background) {
+    delay(length);
+    noToneAC();
+  }
+}
+
+void noToneAC()
+{
+  HostBoard::current()->setToneFrequency(0);
+}
+
+long random(long howBig)
+{
+  if (howBig <= 0) {
+    return 0;
+  }
+  randomState = randomState * 1103515245UL + 12345UL; // Deterministic, like on the board
+  return (randomState >> 16) % howBig;
+}
+
+long random(long howSmall, long howBig)
+{
+  return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed)
+{
+  if (seed != 0) {
+    randomState = seed;
+  }
+}
+
+//////// Serial ////////
+
+int HostSerial::available()
+{
+  return HostBoard::current()->availableSerial();
+}
+
+int HostSerial::read()
+{
+  return HostBoard::current()->readSerial(true);
+}
+
+int HostSerial::peek()
+{
+  return HostBoard::current()->readSerial(false);
+}
+
+size_t HostSerial::write(uint8_t value)
+{
+  HostBoard::current()->printSerial(value);
+  return 1;
+}
+
+size_t HostSerial::write(const char *text)
+{
+  size_t size = 0;
+  while (text[size] != '\0') {
+    write(text[size++]);
+  }
+  return size;
+}
+
+size_t HostSerial::print(const char *text)
+{
+  return write(text);
+}
+
+size_t HostSerial::print(char value)
+{
+  return write(value);
+}
+
+size_t HostSerial::print(unsigned char value, int base)
+{
+  return printNumber(value, base, false);
+}
+
+size_t HostSerial::print(int value, int base)
+{
+  return print((long) value, base);
+}
+
+size_t HostSerial::print(unsigned int value, int base)
+{
+  return printNumber(value, base, false);
+}
+
+size_t HostSerial::print(long value, int base)
+{
+  if (base == DEC && value < 0) {
+    return printNumber(-(unsigned long) value, base, true);
+  }
+  return printNumber(value, base, false);
+}
+
+size_t HostSerial::print(unsigned long value, int base)
+{
+  return printNumber(value, base, false);
+}
+
+size_t HostSerial::print(double value, int digits)
+{
+  char text[32];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t HostSerial::println()
+{
+  return write("\r\n");
+}
+
+size_t HostSerial::printNumber(unsigned long value, int base, bool negative)
+{
+  if (base < 2) {
+    base = DEC;
+  }
+
+  char text[8 * sizeof(unsigned long) + 2];
+  char *digit = &text[sizeof(text) - 1];
+  *digit = '\0';
+  do {
+    const unsigned long remainder = value % base;
+    *--digit = remainder < 10 ? '0' + remainder : 'A' + remainder - 10;
+    value /= base;
+  } while (value > 0);
+  if (negative) {
+    *--digit = '-';
+  }
+
+  return write(digit);
+}
+
+//////// EEPROM ////////
+
+uint8_t HostEeprom::read(int address)
+{
+  return HostBoard::current()->readEeprom(address);
+}
+
+void HostEeprom::write(int address, uint8_t value)
+{
+  HostBoard::current()->writeEeprom(address, value);
+}
+
+void HostEeprom::update(int address, uint8_t value)
+{
+  if (read(address) != value) {
+    write(address, value); // Each write wears the EEPROM out on the board
+  }
+}
+
+uint16_t HostEeprom::length()
+{
+  return HOST_BOARD_EEPROM_SIZE;
+}
+
+//////// SPI ////////
+
+void HostSpi::beginTransaction(SPISettings settings)
+{
+  HostBoard::current()->getRadio()->beginSpiTransaction();
+}
+
+uint8_t HostSpi::transfer(uint8_t data)
+{
+  return HostBoard::current()->getRadio()->transferSpi(data);
+}
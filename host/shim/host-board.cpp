@@ -0,0 +1,404 @@
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "host-board.h"
+#include "host-clock.h"
+
+// Values of the Arduino core (not included here, for its min() and max() macros)
+const uint8_t OUTPUT_MODE = 0x1;
+const uint8_t HIGH_LEVEL = 0x1;
+
+// Exported by the sketch libraries (see tools/sketch.map)
+const char *SETUP_SYMBOL = "_Z5setupv";
+const char *LOOP_SYMBOL = "_Z4loopv";
+const char *CAPTURE_EDGES_SYMBOL = "_ZN9InputBank12captureEdgesEv";
+
+thread_local HostBoard *HostBoard::currentBoard = nullptr;
+
+void printSerialLine(HostBoard *board, const char *line, void *context)
+{
+  printf("[%10llu ms] %s: %s\n", (unsigned long long) HostClock::now(), board->getName(), line);
+}
+
+HostBoard::HostBoard(const char *name)
+  : name(name)
+  , serialListener(&printSerialLine)
+  , radio(this)
+{
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  for (uint8_t port = 0; port < PORT_COUNT; port++) {
+    portInputRegisters[port] = 0;
+  }
+  for (uint8_t pin = 0; pin < HOST_BOARD_PIN_COUNT; pin++) {
+    updatePortInputRegister(pin);
+  }
+}
+
+HostBoard::~HostBoard()
+{
+  unload();
+  if (eepromFile >= 0) {
+    close(eepromFile);
+  }
+}
+
+void HostBoard::unload()
+{
+  if (library != nullptr) {
+    Activation activation(this); // The destructors of the globals of the sketch run now
+    dlclose(library);
+    library = nullptr;
+  }
+}
+
+bool HostBoard::load(const char *sketchLibraryPath)
+{
+  this->sketchLibraryPath = sketchLibraryPath;
+
+  // dlopen() returns the same library when loading the same file twice: each board loads its own copy
+  char copyPath[] = "/tmp/host-board-XXXXXX";
+  const int copyFile = mkstemp(copyPath);
+  FILE *source = fopen(sketchLibraryPath, "rb");
+  if (copyFile < 0 || source == nullptr) {
+    fprintf(stderr, "%s: cannot copy %s\n", name.c_str(), sketchLibraryPath);
+    if (source != nullptr) {
+      fclose(source);
+    }
+    if (copyFile >= 0) {
+      close(copyFile);
+      unlink(copyPath);
+    }
+    return false;
+  }
+
+  char buffer[65536];
+  size_t size;
+  bool copied = true;
+  while ((size = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+    copied = copied && write(copyFile, buffer, size) == (ssize_t) size;
+  }
+  fclose(source);
+  close(copyFile);
+
+  {
+    Activation activation(this); // The constructors of the globals of the sketch run now
+    library = copied ? dlopen(copyPath, RTLD_NOW | RTLD_LOCAL) : nullptr;
+  }
+  unlink(copyPath); // Still mapped until dlclose()
+
+  if (library == nullptr) {
+    fprintf(stderr, "%s: cannot load %s: %s\n", name.c_str(), sketchLibraryPath, copied ? dlerror() : "copy failed");
+    return false;
+  }
+
+  sketchSetup = (void (*)()) dlsym(library, SETUP_SYMBOL);
+  sketchLoop = (void (*)()) dlsym(library, LOOP_SYMBOL);
+  captureEdges = (void (*)()) dlsym(library, CAPTURE_EDGES_SYMBOL);
+  if (sketchSetup == nullptr || sketchLoop == nullptr) {
+    fprintf(stderr, "%s: no setup() or loop() in %s\n", name.c_str(), sketchLibraryPath);
+    return false;
+  }
+  return true;
+}
+
+void *HostBoard::findSymbol(const char *symbol) const
+{
+  return library != nullptr ? dlsym(library, symbol) : nullptr;
+}
+
+const char *HostBoard::getName() const
+{
+  return name.c_str();
+}
+
+bool HostBoard::setEepromFile(const char *path)
+{
+  eepromFile = open(path, O_RDWR | O_CREAT, 0644);
+  if (eepromFile < 0) {
+    fprintf(stderr, "%s: cannot open EEPROM file %s\n", name.c_str(), path);
+    return false;
+  }
+
+  const ssize_t size = pread(eepromFile, eeprom, sizeof(eeprom), 0);
+  if (size < (ssize_t) sizeof(eeprom)) {
+    // New file: blank EEPROM
+    memset(eeprom + (size > 0 ? size : 0), 0xFF, sizeof(eeprom) - (size > 0 ? size : 0));
+    if (pwrite(eepromFile, eeprom, sizeof(eeprom), 0) != (ssize_t) sizeof(eeprom)) {
+      fprintf(stderr, "%s: cannot write EEPROM file %s\n", name.c_str(), path);
+      return false;
+    }
+  }
+  return true;
+}
+
+void HostBoard::setMillisOffset(uint32_t offset)
+{
+  millisOffset = offset;
+}
+
+void HostBoard::setup()
+{
+  Activation activation(this);
+  sketchSetup();
+}
+
+void HostBoard::loop()
+{
+  Activation activation(this);
+  nextWakeUpTime = HostClock::now(); // Unless the sketch goes to sleep
+  sketchLoop();
+}
+
+bool HostBoard::restart()
+{
+  unload();
+
+  for (uint8_t pin = 0; pin < HOST_BOARD_PIN_COUNT; pin++) {
+    // All pins are inputs after a reset
+    pins[pin].mode = 0;
+    pins[pin].outputLevel = 0;
+    updatePortInputRegister(pin);
+  }
+  serialInput.clear();
+  serialLine.clear();
+  toneFrequency = 0;
+
+  if (!load(std::string(sketchLibraryPath).c_str())) {
+    return false;
+  }
+  setup();
+  nextWakeUpTime = HostClock::now();
+  return true;
+}
+
+uint64_t HostBoard::getNextWakeUpTime() const
+{
+  return nextWakeUpTime;
+}
+
+void HostBoard::wakeUpAt(uint64_t time)
+{
+  if (time < nextWakeUpTime) {
+    nextWakeUpTime = time;
+  }
+}
+
+void HostBoard::sleepUntil(uint32_t wakeUpTimestamp)
+{
+  if (wakeUpTimestamp == 0xFFFFFFFF) {
+    nextWakeUpTime = UINT64_MAX;
+    return;
+  }
+
+  // Like IdleSleeper on the board: a deadline already reached does not sleep
+  const int32_t sleepDuration = (int32_t) (wakeUpTimestamp - (uint32_t) millis());
+  nextWakeUpTime = HostClock::now() + (sleepDuration > 0 ? sleepDuration : 0);
+}
+
+void HostBoard::setInput(uint8_t pin, uint8_t level)
+{
+  if (pin >= HOST_BOARD_PIN_COUNT || pins[pin].inputLevel == level) {
+    return;
+  }
+
+  pins[pin].inputLevel = level;
+  updatePortInputRegister(pin);
+
+  if (pins[pin].mode != OUTPUT_MODE) {
+    if (captureEdges != nullptr) {
+      Activation activation(this);
+      captureEdges(); // Like the pin change interrupt
+    }
+    wakeUpAt(HostClock::now());
+  }
+}
+
+uint8_t HostBoard::getOutput(uint8_t pin) const
+{
+  return pin < HOST_BOARD_PIN_COUNT ? pins[pin].outputLevel : 0;
+}
+
+const HostPin *HostBoard::getPin(uint8_t pin) const
+{
+  return pin < HOST_BOARD_PIN_COUNT ? &pins[pin] : nullptr;
+}
+
+void HostBoard::setPinListener(void (*listener)(HostBoard *board, uint8_t pin, uint8_t level, void *context), void *context)
+{
+  pinListener = listener;
+  pinListenerContext = context;
+}
+
+void HostBoard::setRadioPowerPin(uint8_t pin)
+{
+  radioPowerPin = pin;
+}
+
+void HostBoard::writeSerial(const char *text)
+{
+  serialInput += text;
+  wakeUpAt(HostClock::now()); // Like the interrupt of the serial port
+}
+
+void HostBoard::setSerialListener(void (*listener)(HostBoard *board, const char *line, void *context), void *context)
+{
+  serialListener = listener;
+  serialListenerContext = context;
+}
+
+unsigned long HostBoard::getToneFrequency() const
+{
+  return toneFrequency;
+}
+
+unsigned long HostBoard::getToneStartCount() const
+{
+  return toneStartCount;
+}
+
+HostRadio *HostBoard::getRadio()
+{
+  return &radio;
+}
+
+HostBoard *HostBoard::current()
+{
+  return currentBoard;
+}
+
+unsigned long HostBoard::millis() const
+{
+  return (uint32_t) (HostClock::now() + millisOffset);
+}
+
+void HostBoard::pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin < HOST_BOARD_PIN_COUNT) {
+    pins[pin].mode = mode;
+    updatePortInputRegister(pin);
+  }
+}
+
+void HostBoard::digitalWrite(uint8_t pin, uint8_t level)
+{
+  if (pin >= HOST_BOARD_PIN_COUNT) {
+    return;
+  }
+
+  HostPin *hostPin = &pins[pin];
+  level = level ? HIGH_LEVEL : 0;
+  hostPin->writeCount++;
+  if (hostPin->outputLevel == level) {
+    return;
+  }
+
+  hostPin->outputLevel = level;
+  hostPin->changeCount++;
+  updatePortInputRegister(pin);
+
+  if (pin == radioPowerPin) {
+    radio.cutPower(level != HIGH_LEVEL);
+  }
+  if (pinListener != nullptr && hostPin->mode == OUTPUT_MODE) {
+    pinListener(this, pin, level, pinListenerContext);
+  }
+}
+
+int HostBoard::digitalRead(uint8_t pin)
+{
+  if (pin >= HOST_BOARD_PIN_COUNT) {
+    return 0;
+  }
+
+  pins[pin].readCount++;
+  return pins[pin].mode == OUTPUT_MODE ? pins[pin].outputLevel : pins[pin].inputLevel;
+}
+
+volatile uint8_t *HostBoard::getPortInputRegister(uint8_t port)
+{
+  return port < PORT_COUNT ? &portInputRegisters[port] : nullptr;
+}
+
+void HostBoard::updatePortInputRegister(uint8_t pin)
+{
+  // Same mapping as digitalPinToPort() and digitalPinToBitMask() of the Arduino stand-in
+  const uint8_t port = pin < 8 ? 4 : (pin < 14 ? 2 : 3);
+  const uint8_t bitMask = 1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+  const uint8_t level = pins[pin].mode == OUTPUT_MODE ? pins[pin].outputLevel : pins[pin].inputLevel;
+
+  if (level) {
+    portInputRegisters[port] |= bitMask;
+  } else {
+    portInputRegisters[port] &= ~bitMask;
+  }
+}
+
+uint8_t HostBoard::readEeprom(int address) const
+{
+  return address >= 0 && address < HOST_BOARD_EEPROM_SIZE ? eeprom[address] : 0xFF;
+}
+
+void HostBoard::writeEeprom(int address, uint8_t value)
+{
+  if (address < 0 || address >= HOST_BOARD_EEPROM_SIZE) {
+    return;
+  }
+
+  eeprom[address] = value;
+  if (eepromFile >= 0 && pwrite(eepromFile, &value, 1, address) != 1) {
+    fprintf(stderr, "%s: cannot write EEPROM file\n", name.c_str());
+  }
+}
+
+void HostBoard::printSerial(char c)
+{
+  if (c == '\n') {
+    if (serialListener != nullptr) {
+      serialListener(this, serialLine.c_str(), serialListenerContext);
+    }
+    serialLine.clear();
+  } else if (c != '\r') {
+    serialLine += c;
+  }
+}
+
+int HostBoard::readSerial(bool remove)
+{
+  if (serialInput.empty()) {
+    return -1;
+  }
+
+  const int c = (unsigned char) serialInput[0];
+  if (remove) {
+    serialInput.erase(0, 1);
+  }
+  return c;
+}
+
+int HostBoard::availableSerial() const
+{
+  return serialInput.size();
+}
+
+void HostBoard::setToneFrequency(unsigned long frequency)
+{
+  if (frequency != 0 && frequency != toneFrequency) {
+    toneStartCount++;
+  }
+  toneFrequency = frequency;
+}
+
+HostBoard::Activation::Activation(HostBoard *board)
+  : previousBoard(currentBoard)
+{
+  currentBoard = board;
+}
+
+HostBoard::Activation::~Activation()
+{
+  currentBoard = previousBoard;
+}
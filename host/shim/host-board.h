@@ -0,0 +1,176 @@
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+
+#include <stdint.h>
+#include <string>
+
+#include "host-radio.h"
+
+const uint8_t HOST_BOARD_PIN_COUNT = 22; // Digital pins and A0~A7 of an ATmega328P
+const uint16_t HOST_BOARD_EEPROM_SIZE = 1024;
+const uint8_t HOST_BOARD_NO_PIN = 0xFF;
+
+struct HostPin
+{
+  uint8_t mode = 0; // INPUT, OUTPUT or INPUT_PULLUP
+  uint8_t outputLevel = 0; // Written by the sketch
+  uint8_t inputLevel = 1; // Driven from outside: HIGH by default, like a released button with a pull-up resistor
+  unsigned long writeCount = 0;
+  unsigned long readCount = 0;
+  unsigned long changeCount = 0; // Of the output level
+};
+
+/**
+ * An Arduino running a sketch built as a shared library (see host/Makefile), on a computer:
+ * the Arduino functions called by the sketch act on its pins, EEPROM, serial port and radio, with the virtual time of HostClock.
+ * Each board loads its own copy of the sketch, so several boards (even of the same sketch) run side by side, in the same thread.
+ */
+class HostBoard {
+  public:
+    HostBoard(const char *name);
+    ~HostBoard();
+
+    /**
+     * Load the sketch, without running it yet: false, with the reason printed, if it cannot be loaded.
+     */
+    bool load(const char *sketchLibraryPath);
+
+    const char *getName() const;
+
+    /**
+     * Before setup(): load the EEPROM from this file if it exists (otherwise, it is blank: all bytes at 0xFF),
+     * and save each write to it, so the EEPROM survives the restart of the board.
+     */
+    bool setEepromFile(const char *path);
+
+    /**
+     * millis() returns the time of HostClock plus this offset (truncated to 32 bits), e.g. to start close to its overflow.
+     */
+    void setMillisOffset(uint32_t offset);
+
+    void setup();
+    void loop();
+
+    /**
+     * Restart the sketch, like after a reset of the microcontroller: only the EEPROM, the inputs driven from outside and the radio
+     * (which is not reset with the microcontroller) stay, and setup() runs again.
+     */
+    bool restart();
+
+    /**
+     * When the board needs its loop() to run again, in the time of HostClock: UINT64_MAX if only an input can wake it up.
+     * The sketch sets it by going to sleep with IdleSleeper; otherwise, or after an input changed, it is the time of its last loop().
+     */
+    uint64_t getNextWakeUpTime() const;
+    void wakeUpAt(uint64_t time); // Only moves the wake-up time earlier
+
+    //////// Pins ////////
+
+    /**
+     * Drive an input pin from outside: the change is captured right away by the InputBank of the sketch, like by its pin change interrupt.
+     */
+    void setInput(uint8_t pin, uint8_t level);
+    uint8_t getOutput(uint8_t pin) const;
+    const HostPin *getPin(uint8_t pin) const;
+
+    /**
+     * Called at each change of the level of an output pin.
+     */
+    void setPinListener(void (*listener)(HostBoard *board, uint8_t pin, uint8_t level, void *context), void *context);
+
+    /**
+     * The radio is powered only while this output pin is HIGH (see the powerPin of Wireless).
+     */
+    void setRadioPowerPin(uint8_t pin);
+
+    //////// Serial port ////////
+
+    void writeSerial(const char *text); // Made available to Serial.read()
+
+    /**
+     * Called with each line printed by the sketch (without the line ending). By default, lines are printed to the standard output, after the name of the board.
+     */
+    void setSerialListener(void (*listener)(HostBoard *board, const char *line, void *context), void *context);
+
+    //////// Other peripherals ////////
+
+    unsigned long getToneFrequency() const; // 0 when silent
+    unsigned long getToneStartCount() const; // Times a tone started, e.g. the notes of melodies
+    HostRadio *getRadio();
+
+    /**
+     * A function or variable of the sketch exported by tools/sketch.map (by its mangled name), e.g. to measure it: nullptr if none.
+     * Call its functions with the board current (see Activation).
+     */
+    void *findSymbol(const char *symbol) const;
+
+    /**
+     * The board running its setup() or loop(), or loading its sketch, in this thread: the one the Arduino functions act on.
+     */
+    static HostBoard *current();
+
+    /**
+     * Makes the board current for the lifetime of the object, in this thread,
+     * e.g. to run library code of the sketches outside of a sketch, on a board without sketch.
+     */
+    class Activation {
+      public:
+        Activation(HostBoard *board);
+        ~Activation();
+      private:
+        HostBoard *previousBoard;
+    };
+
+    // Called by the Arduino stand-ins of the current board
+    unsigned long millis() const;
+    void pinMode(uint8_t pin, uint8_t mode);
+    void digitalWrite(uint8_t pin, uint8_t level);
+    int digitalRead(uint8_t pin);
+    volatile uint8_t *getPortInputRegister(uint8_t port);
+    uint8_t readEeprom(int address) const;
+    void writeEeprom(int address, uint8_t value);
+    void printSerial(char c);
+    int readSerial(bool remove);
+    int availableSerial() const;
+    void setToneFrequency(unsigned long frequency);
+    void sleepUntil(uint32_t wakeUpTimestamp); // Called by IdleSleeper, with the timestamp of the earliest deadline (0xFFFFFFFF if none)
+
+  private:
+    static const uint8_t PORT_COUNT = 5; // Indexed like in the Arduino core: ports B, C and D are 2, 3 and 4
+
+    static thread_local HostBoard *currentBoard;
+
+    std::string name;
+    std::string sketchLibraryPath;
+    void *library = nullptr;
+    std::string libraryCopyPath;
+    void (*sketchSetup)() = nullptr;
+    void (*sketchLoop)() = nullptr;
+    void (*captureEdges)() = nullptr; // InputBank::captureEdges() of the sketch, if it uses the InputBank
+
+    uint32_t millisOffset = 0;
+    uint64_t nextWakeUpTime = 0;
+
+    HostPin pins[HOST_BOARD_PIN_COUNT];
+    volatile uint8_t portInputRegisters[PORT_COUNT];
+    void (*pinListener)(HostBoard *board, uint8_t pin, uint8_t level, void *context) = nullptr;
+    void *pinListenerContext = nullptr;
+    uint8_t radioPowerPin = HOST_BOARD_NO_PIN;
+
+    uint8_t eeprom[HOST_BOARD_EEPROM_SIZE];
+    int eepromFile = -1;
+
+    std::string serialInput;
+    std::string serialLine;
+    void (*serialListener)(HostBoard *board, const char *line, void *context);
+    void *serialListenerContext = nullptr;
+
+    unsigned long toneFrequency = 0;
+    unsigned long toneStartCount = 0;
+    HostRadio radio;
+
+    void updatePortInputRegister(uint8_t pin);
+    void unload();
+};
+
+#endif
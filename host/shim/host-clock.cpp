@@ -0,0 +1,34 @@
+#include <time.h>
+
+#include "host-clock.h"
+
+thread_local uint64_t HostClock::time = 0;
+
+uint64_t HostClock::now()
+{
+  return time;
+}
+
+void HostClock::advance(uint64_t duration)
+{
+  time += duration;
+}
+
+void HostClock::advanceTo(uint64_t time)
+{
+  if (time > HostClock::time) {
+    HostClock::time = time;
+  }
+}
+
+void HostClock::reset()
+{
+  time = 0;
+}
+
+uint64_t HostClock::wallNow()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
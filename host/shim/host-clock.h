@@ -0,0 +1,32 @@
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <stdint.h>
+
+/**
+ * The virtual time of a simulation, shared by all its boards: it only moves when advanced,
+ * so a simulation runs as fast as the computer allows, and always the same way.
+ * Each thread has its own clock, to run its own simulation.
+ */
+class HostClock {
+  public:
+    /**
+     * Milliseconds since the start of the simulation: unlike millis(), never overflows.
+     */
+    static uint64_t now();
+
+    static void advance(uint64_t duration);
+    static void advanceTo(uint64_t time); // Ignored if time is in the past
+
+    static void reset();
+
+    /**
+     * Milliseconds of the real (monotonic) clock, for the runs in real time.
+     */
+    static uint64_t wallNow();
+
+  private:
+    static thread_local uint64_t time;
+};
+
+#endif
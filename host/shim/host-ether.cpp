@@ -0,0 +1,438 @@
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "host-clock.h"
+#include "host-ether.h"
+
+const uint8_t PEER_FRAME = 1;
+const uint8_t PEER_ACK = 2;
+
+/**
+ * Exchanged with the peer process: both are built from the same sources, so they agree on its layout.
+ */
+struct HostEther::PeerDatagram
+{
+  uint8_t type; // PEER_FRAME or PEER_ACK
+  uint8_t fromRadioId;
+  uint8_t toRadioId;
+  uint8_t channel;
+  uint8_t requireAck;
+  uint8_t isReceived; // Of the frame acknowledged by a PEER_ACK
+  uint16_t sequence; // Of the frame, repeated by its PEER_ACK
+  uint32_t latency; // Of the frame, applied by the receiving process
+  HostRadioPacket packet; // The frame, or the ACK payload (of size 0 if none)
+};
+
+thread_local HostRadio *HostEther::radios[MAX_RADIO_COUNT];
+thread_local uint8_t HostEther::radioCount = 0;
+thread_local bool HostEther::isJammed = false;
+thread_local HostEther::Link HostEther::links[MAX_LINK_COUNT];
+thread_local uint8_t HostEther::linkCount = 0;
+thread_local HostEther::Delivery HostEther::deliveries[MAX_DELIVERY_COUNT];
+thread_local unsigned int HostEther::deliveryCount = 0;
+thread_local uint64_t HostEther::randomState = 0x853C49E6748FEA9BULL;
+thread_local HostEtherCounters HostEther::counters;
+thread_local int HostEther::peerSocket = -1;
+thread_local sockaddr_un HostEther::localAddress;
+thread_local sockaddr_un HostEther::peerAddress;
+thread_local uint16_t HostEther::peerSequence = 0;
+
+const HostLinkConditions PERFECT_LINK_CONDITIONS;
+
+void HostEther::add(HostRadio *radio)
+{
+  if (radioCount < MAX_RADIO_COUNT) {
+    radios[radioCount++] = radio;
+  }
+}
+
+void HostEther::remove(HostRadio *radio)
+{
+  for (uint8_t i = 0; i < radioCount; i++) {
+    if (radios[i] == radio) {
+      radios[i] = radios[--radioCount];
+      return;
+    }
+  }
+}
+
+void HostEther::setJammed(bool isJammed)
+{
+  HostEther::isJammed = isJammed;
+}
+
+HostRadio *HostEther::findListeningRadio(uint8_t radioId, uint8_t channel)
+{
+  for (uint8_t i = 0; i < radioCount; i++) {
+    if (radios[i]->isListening() && radios[i]->getRadioId() == radioId && radios[i]->getChannel() == channel) {
+      return radios[i];
+    }
+  }
+  return nullptr;
+}
+
+bool HostEther::transmit(HostRadio *sender, uint8_t destinationRadioId, const uint8_t *data, uint8_t size, bool requireAck)
+{
+  if (!sender->isListening()) {
+    return false; // Nothing transmitted
+  }
+  sender->editCounters()->sentCount++;
+
+  const HostLinkConditions *forward = getLinkConditions(sender->getRadioId(), destinationRadioId);
+  const HostLinkConditions *backward = getLinkConditions(destinationRadioId, sender->getRadioId());
+
+  HostRadioPacket packet;
+  packet.size = size > HOST_RADIO_MAX_PACKET_SIZE ? HOST_RADIO_MAX_PACKET_SIZE : size;
+  memcpy(packet.data, data, packet.size);
+
+  if (isJammed || sender->isIsolated()) {
+    return !requireAck;
+  }
+  if (draw(forward->lossRate)) {
+    counters.lostFrameCount++;
+    return !requireAck;
+  }
+  if (packet.size > 0 && draw(forward->corruptionRate)) {
+    packet.data[randomNumber() % packet.size] ^= 1 << (randomNumber() % 8);
+    counters.corruptedFrameCount++;
+  }
+  const bool isDuplicated = draw(forward->duplicationRate);
+  const bool isAckLost = requireAck && draw(backward->lossRate);
+  const uint32_t latency = drawLatency(forward);
+
+  bool isReceived;
+  HostRadioPacket ackPayload;
+  ackPayload.size = 0;
+
+  HostRadio *receiver = findListeningRadio(destinationRadioId, sender->getChannel());
+  if (receiver != nullptr) {
+    if (receiver->isIsolated()) {
+      isReceived = false;
+    } else if (latency == 0) {
+      isReceived = receiver->pushReceived(packet.data, packet.size);
+    } else {
+      isReceived = !receiver->getRxFifo()->isFull(); // As far as it can be known now
+      send(destinationRadioId, sender->getChannel(), packet, latency);
+    }
+    if (isReceived && requireAck) {
+      receiver->getAckFifo()->pop(&ackPayload); // Even if the ACK is lost
+    }
+  } else if (peerSocket >= 0) {
+    isReceived = transmitToPeer(sender, destinationRadioId, packet, requireAck, latency, &ackPayload);
+  } else {
+    isReceived = false;
+  }
+
+  if (isReceived && isDuplicated) {
+    counters.duplicatedFrameCount++;
+    if (receiver != nullptr) {
+      send(destinationRadioId, sender->getChannel(), packet, latency + 1);
+    } else {
+      transmitToPeer(sender, destinationRadioId, packet, false, latency + 1, nullptr);
+    }
+  }
+
+  if (!requireAck) {
+    return true;
+  }
+  if (!isReceived) {
+    return false; // A full RX FIFO does not acknowledge either
+  }
+  if (isAckLost) {
+    counters.lostAckCount++;
+    return false;
+  }
+
+  if (ackPayload.size > 0) {
+    const uint32_t ackLatency = latency + drawLatency(backward);
+    if (ackLatency == 0) {
+      sender->pushReceived(ackPayload.data, ackPayload.size);
+    } else {
+      send(sender->getRadioId(), sender->getChannel(), ackPayload, ackLatency);
+    }
+  }
+  return true;
+}
+
+void HostEther::setLinkConditions(uint8_t fromRadioId, uint8_t toRadioId, const HostLinkConditions &conditions)
+{
+  for (uint8_t i = 0; i < linkCount; i++) {
+    if (links[i].fromRadioId == fromRadioId && links[i].toRadioId == toRadioId) {
+      links[i].conditions = conditions;
+      return;
+    }
+  }
+  if (linkCount < MAX_LINK_COUNT) {
+    links[linkCount++] = { fromRadioId, toRadioId, conditions };
+  }
+}
+
+const HostLinkConditions *HostEther::getLinkConditions(uint8_t fromRadioId, uint8_t toRadioId)
+{
+  // The most specific link wins
+  const HostLinkConditions *conditions = &PERFECT_LINK_CONDITIONS;
+  uint8_t bestMatchCount = 0;
+  for (uint8_t i = 0; i < linkCount; i++) {
+    const bool fromMatches = (links[i].fromRadioId == fromRadioId);
+    const bool toMatches = (links[i].toRadioId == toRadioId);
+    if ((fromMatches || links[i].fromRadioId == HOST_ETHER_ANY_RADIO) && (toMatches || links[i].toRadioId == HOST_ETHER_ANY_RADIO)) {
+      const uint8_t matchCount = 1 + fromMatches + toMatches;
+      if (matchCount > bestMatchCount) {
+        conditions = &links[i].conditions;
+        bestMatchCount = matchCount;
+      }
+    }
+  }
+  return conditions;
+}
+
+bool HostEther::parseLinkConditions(const char *text, HostLinkConditions *conditions)
+{
+  const char *item = text;
+  while (*item != '\0') {
+    const char *end = strchr(item, ',');
+    const size_t length = (end == nullptr ? strlen(item) : end - item);
+    const char *value = (const char *) memchr(item, '=', length);
+    if (value == nullptr) {
+      return false;
+    }
+    const size_t nameLength = value - item;
+    value++;
+
+    char *valueEnd;
+    if (strncmp(item, "latency", nameLength) == 0 || strncmp(item, "jitter", nameLength) == 0) {
+      unsigned long milliseconds = strtoul(value, &valueEnd, 10);
+      if (strncmp(valueEnd, "ms", 2) == 0) {
+        valueEnd += 2;
+      } else if (*valueEnd == 's') {
+        milliseconds *= 1000;
+        valueEnd++;
+      }
+      (item[0] == 'l' ? conditions->latencyMs : conditions->jitterMs) = milliseconds;
+    } else {
+      const float rate = strtof(value, &valueEnd);
+      if (rate < 0 || rate > 1) {
+        return false;
+      }
+      if (strncmp(item, "loss", nameLength) == 0) {
+        conditions->lossRate = rate;
+      } else if (strncmp(item, "duplication", nameLength) == 0) {
+        conditions->duplicationRate = rate;
+      } else if (strncmp(item, "corruption", nameLength) == 0) {
+        conditions->corruptionRate = rate;
+      } else {
+        return false;
+      }
+    }
+    if (valueEnd != item + length || valueEnd == value) {
+      return false;
+    }
+
+    item += length + (end == nullptr ? 0 : 1);
+  }
+  return true;
+}
+
+void HostEther::setRandomSeed(uint64_t seed)
+{
+  randomState = seed;
+}
+
+uint64_t HostEther::randomNumber()
+{
+  // SplitMix64: fast, and good enough to draw the fate of frames
+  uint64_t z = (randomState += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+bool HostEther::draw(float rate)
+{
+  return rate > 0 && (randomNumber() >> 11) * (1.0 / 9007199254740992.0) < rate;
+}
+
+uint32_t HostEther::drawLatency(const HostLinkConditions *conditions)
+{
+  return conditions->latencyMs + (conditions->jitterMs == 0 ? 0 : randomNumber() % (conditions->jitterMs + 1));
+}
+
+void HostEther::send(uint8_t radioId, uint8_t channel, const HostRadioPacket &packet, uint32_t latency)
+{
+  if (deliveryCount == MAX_DELIVERY_COUNT) {
+    counters.lostFrameCount++;
+    return;
+  }
+  deliveries[deliveryCount++] = { HostClock::now() + latency, radioId, channel, packet };
+  counters.delayedFrameCount++;
+}
+
+void HostEther::deliver()
+{
+  while (true) {
+    // The earliest due first, so that frames without jitter arrive in order
+    int due = -1;
+    for (unsigned int i = 0; i < deliveryCount; i++) {
+      if (deliveries[i].time <= HostClock::now() && (due < 0 || deliveries[i].time < deliveries[due].time)) {
+        due = i;
+      }
+    }
+    if (due < 0) {
+      return;
+    }
+
+    const Delivery delivery = deliveries[due];
+    for (unsigned int i = due + 1; i < deliveryCount; i++) {
+      deliveries[i - 1] = deliveries[i]; // Keep the order of the frames due at the same time
+    }
+    deliveryCount--;
+
+    HostRadio *receiver = findListeningRadio(delivery.radioId, delivery.channel);
+    if (receiver != nullptr && !receiver->isIsolated() && !isJammed) {
+      receiver->pushReceived(delivery.packet.data, delivery.packet.size);
+    }
+  }
+}
+
+uint64_t HostEther::nextDeliveryTime()
+{
+  uint64_t time = UINT64_MAX;
+  for (unsigned int i = 0; i < deliveryCount; i++) {
+    if (deliveries[i].time < time) {
+      time = deliveries[i].time;
+    }
+  }
+  return time;
+}
+
+const HostEtherCounters *HostEther::getCounters()
+{
+  return &counters;
+}
+
+void HostEther::reset()
+{
+  isJammed = false;
+  linkCount = 0;
+  deliveryCount = 0;
+  counters = HostEtherCounters();
+}
+
+bool HostEther::connect(const char *localPath, const char *peerPath)
+{
+  if (strlen(localPath) >= sizeof(localAddress.sun_path) || strlen(peerPath) >= sizeof(peerAddress.sun_path)) {
+    fprintf(stderr, "Socket path too long\n");
+    return false;
+  }
+  disconnect();
+
+  localAddress.sun_family = AF_UNIX;
+  strcpy(localAddress.sun_path, localPath);
+  peerAddress.sun_family = AF_UNIX;
+  strcpy(peerAddress.sun_path, peerPath);
+
+  peerSocket = socket(AF_UNIX, SOCK_DGRAM, 0);
+  unlink(localPath); // Left by a previous run
+  if (peerSocket < 0 || bind(peerSocket, (const sockaddr *) &localAddress, sizeof(localAddress)) < 0) {
+    perror(localPath);
+    disconnect();
+    return false;
+  }
+  return true;
+}
+
+int HostEther::getSocket()
+{
+  return peerSocket;
+}
+
+void HostEther::disconnect()
+{
+  if (peerSocket >= 0) {
+    close(peerSocket);
+    unlink(localAddress.sun_path);
+    peerSocket = -1;
+  }
+}
+
+void HostEther::receiveFromPeer()
+{
+  PeerDatagram datagram;
+  while (peerSocket >= 0 && recv(peerSocket, &datagram, sizeof(datagram), MSG_DONTWAIT) == sizeof(datagram)) {
+    handlePeerDatagram(&datagram, 0);
+  }
+}
+
+bool HostEther::transmitToPeer(HostRadio *sender, uint8_t destinationRadioId, const HostRadioPacket &packet, bool requireAck, uint32_t latency, HostRadioPacket *ackPayload)
+{
+  PeerDatagram frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.type = PEER_FRAME;
+  frame.fromRadioId = sender->getRadioId();
+  frame.toRadioId = destinationRadioId;
+  frame.channel = sender->getChannel();
+  frame.requireAck = requireAck;
+  frame.sequence = ++peerSequence;
+  frame.latency = latency;
+  frame.packet = packet;
+  if (sendto(peerSocket, &frame, sizeof(frame), 0, (const sockaddr *) &peerAddress, sizeof(peerAddress)) != sizeof(frame)) {
+    return false; // The peer is not running
+  }
+  if (!requireAck) {
+    return true;
+  }
+
+  // Like the radio waiting for the ACK, in real time: the peer handles the frame as soon as it is not running its loop()
+  const uint64_t timeoutTime = HostClock::wallNow() + PEER_ACK_TIMEOUT_MS;
+  for (uint64_t now = HostClock::wallNow(); now < timeoutTime; now = HostClock::wallNow()) {
+    pollfd socketPoll = { peerSocket, POLLIN, 0 };
+    if (poll(&socketPoll, 1, timeoutTime - now) <= 0) {
+      continue;
+    }
+
+    PeerDatagram datagram;
+    if (recv(peerSocket, &datagram, sizeof(datagram), MSG_DONTWAIT) == sizeof(datagram) && handlePeerDatagram(&datagram, frame.sequence)) {
+      *ackPayload = datagram.packet;
+      return datagram.isReceived;
+    }
+  }
+  return false;
+}
+
+bool HostEther::handlePeerDatagram(const PeerDatagram *datagram, uint16_t awaitedSequence)
+{
+  if (datagram->type == PEER_ACK) {
+    return datagram->sequence == awaitedSequence; // Otherwise, too late
+  }
+  if (datagram->type != PEER_FRAME) {
+    return false;
+  }
+
+  HostRadio *receiver = findListeningRadio(datagram->toRadioId, datagram->channel);
+  PeerDatagram ack;
+  memset(&ack, 0, sizeof(ack));
+  ack.type = PEER_ACK;
+  ack.sequence = datagram->sequence;
+
+  if (receiver != nullptr && !receiver->isIsolated() && !isJammed) {
+    if (datagram->latency == 0) {
+      ack.isReceived = receiver->pushReceived(datagram->packet.data, datagram->packet.size);
+    } else {
+      ack.isReceived = !receiver->getRxFifo()->isFull();
+      send(datagram->toRadioId, datagram->channel, datagram->packet, datagram->latency);
+    }
+    if (ack.isReceived && datagram->requireAck) {
+      receiver->getAckFifo()->pop(&ack.packet);
+    }
+  }
+
+  if (datagram->requireAck) {
+    sendto(peerSocket, &ack, sizeof(ack), 0, (const sockaddr *) &peerAddress, sizeof(peerAddress));
+  }
+  return false;
+}
@@ -0,0 +1,144 @@
+#ifndef HOST_ETHER_H
+#define HOST_ETHER_H
+
+#include <stdint.h>
+#include <sys/un.h>
+
+#include "host-radio.h"
+
+const uint8_t HOST_ETHER_ANY_RADIO = 0xFF;
+
+/**
+ * How frames travel in one direction, from a radio to another: perfectly by default.
+ * The ACK of a frame travels in the opposite direction, with the conditions of that direction.
+ */
+struct HostLinkConditions
+{
+  uint32_t latencyMs = 0; // From sending to receiving
+  uint32_t jitterMs = 0; // Random extra latency, up to this (frames can then arrive out of order)
+  float lossRate = 0; // 0~1: frames (or their ACK) not received
+  float duplicationRate = 0; // Frames received twice, like when their ACK is lost and the radio sends them again
+  float corruptionRate = 0; // Frames received with a bit flipped, as if their CRC did not catch it
+};
+
+/**
+ * Counters of what the link conditions did to the frames.
+ */
+struct HostEtherCounters
+{
+  unsigned long lostFrameCount = 0;
+  unsigned long lostAckCount = 0;
+  unsigned long duplicatedFrameCount = 0;
+  unsigned long corruptedFrameCount = 0;
+  unsigned long delayedFrameCount = 0; // Received later than sent (ACK payloads included)
+};
+
+/**
+ * The air between the radios of all the boards of a simulation (one per thread): a payload sent to a radio ID
+ * is received by the listening radio with this ID on the same channel, unless jammed or isolated, with the conditions of the link
+ * in this direction. The fate of a frame and of its ACK is drawn when sending it (NRFLite::send() returns right away),
+ * and the frame, and the ACK payload it brings back, are then received after their latencies (see deliver()).
+ *
+ * A radio can also be reached in another process, over a local datagram socket (see connect()):
+ * both processes then run in real time, each with its own clock.
+ */
+class HostEther {
+  public:
+    static void add(HostRadio *radio);
+    static void remove(HostRadio *radio);
+
+    /**
+     * Returns what NRFLite::send() returns: with requireAck, true if the payload was received (and its ACK payload, if any, is on its way back),
+     * otherwise, true if the payload was transmitted.
+     */
+    static bool transmit(HostRadio *sender, uint8_t destinationRadioId, const uint8_t *data, uint8_t size, bool requireAck);
+
+    /**
+     * Simulate interferences: no payload is received by any radio.
+     */
+    static void setJammed(bool isJammed);
+
+    /**
+     * Set the conditions of the frames sent by fromRadioId to toRadioId (either can be HOST_ETHER_ANY_RADIO).
+     */
+    static void setLinkConditions(uint8_t fromRadioId, uint8_t toRadioId, const HostLinkConditions &conditions);
+    static const HostLinkConditions *getLinkConditions(uint8_t fromRadioId, uint8_t toRadioId);
+
+    /**
+     * Parse conditions like "latency=5ms,jitter=2ms,loss=0.1,duplication=0.01,corruption=0.001": false if invalid.
+     */
+    static bool parseLinkConditions(const char *text, HostLinkConditions *conditions);
+
+    static void setRandomSeed(uint64_t seed); // The same seed draws the same fate for the same frames
+
+    /**
+     * Receive the frames and ACK payloads due at the time of HostClock.
+     */
+    static void deliver();
+    static uint64_t nextDeliveryTime(); // UINT64_MAX if nothing is on its way
+
+    static const HostEtherCounters *getCounters();
+
+    /**
+     * Forget the frames on their way, the link conditions, the jamming and the counters, e.g. between two simulations.
+     */
+    static void reset();
+
+    //////// Across processes ////////
+
+    /**
+     * Bind a datagram socket to localPath, and send the frames for the radios that are not in this process to the process bound to peerPath
+     * (its radios are not known: a frame is lost if the peer does not have the destination radio). False, with the reason printed, if it fails.
+     */
+    static bool connect(const char *localPath, const char *peerPath);
+    static int getSocket(); // -1 if not connected: to wait for the frames of the peer, then call receiveFromPeer()
+    static void receiveFromPeer(); // Without waiting
+    static void disconnect();
+
+  private:
+    static const uint8_t MAX_RADIO_COUNT = 16;
+    static const uint8_t MAX_LINK_COUNT = 8;
+    static const unsigned int MAX_DELIVERY_COUNT = 64; // Beyond, frames are lost
+    static const int PEER_ACK_TIMEOUT_MS = 20; // In real time
+
+    struct Link
+    {
+      uint8_t fromRadioId;
+      uint8_t toRadioId;
+      HostLinkConditions conditions;
+    };
+
+    struct PeerDatagram;
+
+    struct Delivery
+    {
+      uint64_t time;
+      uint8_t radioId;
+      uint8_t channel;
+      HostRadioPacket packet;
+    };
+
+    static thread_local HostRadio *radios[MAX_RADIO_COUNT];
+    static thread_local uint8_t radioCount;
+    static thread_local bool isJammed;
+    static thread_local Link links[MAX_LINK_COUNT];
+    static thread_local uint8_t linkCount;
+    static thread_local Delivery deliveries[MAX_DELIVERY_COUNT];
+    static thread_local unsigned int deliveryCount;
+    static thread_local uint64_t randomState;
+    static thread_local HostEtherCounters counters;
+    static thread_local int peerSocket;
+    static thread_local sockaddr_un localAddress;
+    static thread_local sockaddr_un peerAddress;
+    static thread_local uint16_t peerSequence;
+
+    static HostRadio *findListeningRadio(uint8_t radioId, uint8_t channel);
+    static bool draw(float rate);
+    static uint64_t randomNumber();
+    static uint32_t drawLatency(const HostLinkConditions *conditions);
+    static void send(uint8_t radioId, uint8_t channel, const HostRadioPacket &packet, uint32_t latency);
+    static bool transmitToPeer(HostRadio *sender, uint8_t destinationRadioId, const HostRadioPacket &packet, bool requireAck, uint32_t latency, HostRadioPacket *ackPayload);
+    static bool handlePeerDatagram(const PeerDatagram *datagram, uint16_t awaitedSequence); // True if it is the awaited ACK
+};
+
+#endif
@@ -0,0 +1,237 @@
+#include <string.h>
+
+#include "host-board.h"
+#include "host-ether.h"
+#include "host-radio.h"
+
+// NRF24L01+ SPI commands and registers, answered by transferSpi()
+const uint8_t NRF24_R_REGISTER = 0x00;
+const uint8_t NRF24_REGISTER_MASK = 0x1F;
+const uint8_t NRF24_RF_CH = 0x05;
+const uint8_t NRF24_FIFO_STATUS = 0x17;
+const uint8_t NRF24_FIFO_STATUS_RX_EMPTY = 0x01;
+const uint8_t NRF24_FIFO_STATUS_TX_EMPTY = 0x10;
+const uint8_t NRF24_FLUSH_TX = 0xE1;
+const uint8_t NRF24_STATUS_IDLE = 0x0E; // RX FIFO empty
+
+bool HostRadioFifo::isEmpty() const
+{
+  return count == 0;
+}
+
+bool HostRadioFifo::isFull() const
+{
+  return count == HOST_RADIO_FIFO_SIZE;
+}
+
+const HostRadioPacket *HostRadioFifo::first() const
+{
+  return count == 0 ? nullptr : &packets[firstIndex];
+}
+
+bool HostRadioFifo::push(const uint8_t *data, uint8_t size)
+{
+  if (isFull()) {
+    return false;
+  }
+
+  HostRadioPacket *packet = &packets[(firstIndex + count) % HOST_RADIO_FIFO_SIZE];
+  packet->size = size > HOST_RADIO_MAX_PACKET_SIZE ? HOST_RADIO_MAX_PACKET_SIZE : size;
+  memcpy(packet->data, data, packet->size);
+  count++;
+  return true;
+}
+
+bool HostRadioFifo::pop(HostRadioPacket *packet)
+{
+  if (isEmpty()) {
+    return false;
+  }
+
+  if (packet != nullptr) {
+    *packet = packets[firstIndex];
+  }
+  firstIndex = (firstIndex + 1) % HOST_RADIO_FIFO_SIZE;
+  count--;
+  return true;
+}
+
+void HostRadioFifo::clear()
+{
+  firstIndex = 0;
+  count = 0;
+}
+
+HostRadio::HostRadio(HostBoard *board)
+  : board(board)
+{
+  HostEther::add(this);
+}
+
+HostRadio::~HostRadio()
+{
+  HostEther::remove(this);
+}
+
+HostBoard *HostRadio::getBoard() const
+{
+  return board;
+}
+
+bool HostRadio::init(uint8_t radioId, uint8_t channel)
+{
+  counters.initCount++;
+  if (isPowerCut || lockedUp || isUnresponsive) {
+    return false;
+  }
+
+  this->radioId = radioId;
+  this->channel = channel;
+  isInitialized = true;
+  rxFifo.clear(); // NRFLite flushes both FIFOs
+  ackFifo.clear();
+  updateIrq();
+  return true;
+}
+
+void HostRadio::powerDown()
+{
+  isInitialized = false;
+}
+
+void HostRadio::cutPower(bool isCut)
+{
+  isPowerCut = isCut;
+  if (isCut) {
+    isInitialized = false;
+    lockedUp = false; // Only a power cycle clears a lockup
+    rxFifo.clear();
+    ackFifo.clear();
+    updateIrq();
+  }
+}
+
+bool HostRadio::isListening() const
+{
+  return isInitialized && !isPowerCut && !lockedUp;
+}
+
+uint8_t HostRadio::getRadioId() const
+{
+  return radioId;
+}
+
+uint8_t HostRadio::getChannel() const
+{
+  return channel;
+}
+
+void HostRadio::setLockedUp(bool isLockedUp)
+{
+  lockedUp = isLockedUp;
+}
+
+bool HostRadio::isLockedUp() const
+{
+  return lockedUp;
+}
+
+void HostRadio::setUnresponsive(bool isUnresponsive)
+{
+  this->isUnresponsive = isUnresponsive;
+}
+
+const HostRadioFifo *HostRadio::getRxFifo() const
+{
+  return &rxFifo;
+}
+
+bool HostRadio::pushReceived(const uint8_t *data, uint8_t size)
+{
+  if (!rxFifo.push(data, size)) {
+    counters.overflowCount++;
+    return false;
+  }
+
+  counters.receivedCount++;
+  updateIrq();
+  return true;
+}
+
+bool HostRadio::popReceived(HostRadioPacket *packet)
+{
+  const bool popped = rxFifo.pop(packet);
+  updateIrq();
+  return popped;
+}
+
+HostRadioFifo *HostRadio::getAckFifo()
+{
+  return &ackFifo;
+}
+
+void HostRadio::setIrqPin(uint8_t pin)
+{
+  irqPin = pin;
+  updateIrq();
+}
+
+void HostRadio::updateIrq()
+{
+  if (irqPin != HOST_BOARD_NO_PIN) {
+    board->setInput(irqPin, rxFifo.isEmpty() ? 1 : 0); // Active low
+  }
+}
+
+void HostRadio::setIsolated(bool isIsolated)
+{
+  isolated = isIsolated;
+}
+
+bool HostRadio::isIsolated() const
+{
+  return isolated;
+}
+
+void HostRadio::beginSpiTransaction()
+{
+  hasSpiCommand = false;
+}
+
+uint8_t HostRadio::transferSpi(uint8_t data)
+{
+  if (isPowerCut || isUnresponsive) {
+    return 0x00;
+  }
+  if (lockedUp) {
+    return 0xFF;
+  }
+
+  if (!hasSpiCommand) {
+    spiCommand = data;
+    hasSpiCommand = true;
+    if (spiCommand == NRF24_FLUSH_TX) {
+      ackFifo.clear(); // Only ACK payloads wait in the TX FIFO: NRFLite sends the other payloads right away
+    }
+    return NRF24_STATUS_IDLE; // The radio answers its status to each command
+  }
+
+  // Only the registers and commands used by Wireless are simulated
+  if ((spiCommand & ~NRF24_REGISTER_MASK) == NRF24_R_REGISTER && (spiCommand & NRF24_REGISTER_MASK) == NRF24_RF_CH) {
+    return isInitialized ? channel : 2; // 2 is the channel after a reset
+  }
+  if ((spiCommand & ~NRF24_REGISTER_MASK) == NRF24_R_REGISTER && (spiCommand & NRF24_REGISTER_MASK) == NRF24_FIFO_STATUS) {
+    return (rxFifo.isEmpty() ? NRF24_FIFO_STATUS_RX_EMPTY : 0) | (ackFifo.isEmpty() ? NRF24_FIFO_STATUS_TX_EMPTY : 0);
+  }
+  return 0x00;
+}
+
+const HostRadioCounters *HostRadio::getCounters() const
+{
+  return &counters;
+}
+
+HostRadioCounters *HostRadio::editCounters()
+{
+  return &counters;
+}
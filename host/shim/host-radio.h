@@ -0,0 +1,122 @@
+#ifndef HOST_RADIO_H
+#define HOST_RADIO_H
+
+#include <stdint.h>
+
+class HostBoard;
+
+const uint8_t HOST_RADIO_MAX_PACKET_SIZE = 32;
+const uint8_t HOST_RADIO_FIFO_SIZE = 3; // Like the RX and TX FIFOs of the NRF24L01+
+
+struct HostRadioPacket
+{
+  uint8_t data[HOST_RADIO_MAX_PACKET_SIZE];
+  uint8_t size;
+};
+
+/**
+ * Fixed-size queue of packets, like the FIFOs of the NRF24L01+.
+ */
+class HostRadioFifo {
+  public:
+    bool isEmpty() const;
+    bool isFull() const;
+    const HostRadioPacket *first() const; // nullptr if empty
+
+    bool push(const uint8_t *data, uint8_t size); // False if full
+    bool pop(HostRadioPacket *packet); // False if empty
+    void clear();
+
+  private:
+    HostRadioPacket packets[HOST_RADIO_FIFO_SIZE];
+    uint8_t firstIndex = 0;
+    uint8_t count = 0;
+};
+
+/**
+ * Counters of the traffic of a radio, as seen from outside of the firmware.
+ */
+struct HostRadioCounters
+{
+  unsigned long sentCount = 0; // Transmitted payloads, received or not
+  unsigned long receivedCount = 0; // Payloads pushed to the RX FIFO, including ACK payloads
+  unsigned long overflowCount = 0; // Payloads lost because the RX FIFO was full
+  unsigned long initCount = 0;
+};
+
+/**
+ * The NRF24L01+ of a board, as driven by the NRFLite stand-in: it only exchanges payloads with the radios linked by HostEther,
+ * and can be made to fail like a real one (see setLockedUp()).
+ */
+class HostRadio {
+  public:
+    HostRadio(HostBoard *board);
+    ~HostRadio();
+
+    HostBoard *getBoard() const;
+
+    bool init(uint8_t radioId, uint8_t channel); // False, like NRFLite, if the radio does not answer
+    void powerDown();
+    void cutPower(bool isCut); // Until power is back, it does not answer, and it restarts unconfigured
+
+    bool isListening() const; // Initialized, powered and not locked up
+    uint8_t getRadioId() const;
+    uint8_t getChannel() const;
+
+    /**
+     * Simulate a lockup: the radio stops sending and receiving, and answers 0xFF over SPI, until it is power-cycled.
+     */
+    void setLockedUp(bool isLockedUp);
+    bool isLockedUp() const;
+
+    /**
+     * Simulate a radio that does not answer at all (e.g. miswired): init() fails.
+     */
+    void setUnresponsive(bool isUnresponsive);
+
+    const HostRadioFifo *getRxFifo() const;
+    bool pushReceived(const uint8_t *data, uint8_t size); // False if the RX FIFO is full
+    bool popReceived(HostRadioPacket *packet); // False if the RX FIFO is empty
+    HostRadioFifo *getAckFifo(); // Payloads to send back in the next ACKs
+
+    /**
+     * Drive this input pin of the board like the IRQ pin of the radio: LOW while the RX FIFO has data.
+     */
+    void setIrqPin(uint8_t pin);
+
+    /**
+     * Simulate a radio out of range: it neither receives nor is received, although it works.
+     */
+    void setIsolated(bool isIsolated);
+    bool isIsolated() const;
+
+    uint8_t transferSpi(uint8_t data);
+    void beginSpiTransaction();
+
+    const HostRadioCounters *getCounters() const;
+    HostRadioCounters *editCounters();
+
+  private:
+    HostBoard *board;
+
+    uint8_t radioId = 0;
+    uint8_t channel = 0;
+    bool isInitialized = false;
+    bool isPowerCut = false;
+    bool lockedUp = false;
+    bool isUnresponsive = false;
+    bool isolated = false;
+    uint8_t irqPin = 0xFF;
+
+    HostRadioFifo rxFifo;
+    HostRadioFifo ackFifo;
+
+    void updateIrq();
+
+    uint8_t spiCommand;
+    bool hasSpiCommand = false;
+
+    HostRadioCounters counters;
+};
+
+#endif
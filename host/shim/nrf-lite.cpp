@@ -0,0 +1,92 @@
+// NRFLite, over the radio of the current board (see HostRadio)
+
+#include "host-board.h"
+#include "host-ether.h"
+
+#include <NRFLite.h>
+
+uint8_t NRFLite::init(uint8_t radioId, uint8_t cePin, uint8_t csnPin, Bitrates bitrate, uint8_t channel, uint8_t callSpiBegin)
+{
+  radio = HostBoard::current()->getRadio();
+  return radio->init(radioId, channel);
+}
+
+uint8_t NRFLite::hasData(uint8_t usingInterrupts)
+{
+  if (radio == nullptr || !radio->isListening() || radio->getRxFifo()->isEmpty()) {
+    return 0;
+  }
+  return radio->getRxFifo()->first()->size;
+}
+
+uint8_t NRFLite::hasAckData()
+{
+  return hasData(); // ACK payloads are received in the RX FIFO too
+}
+
+void NRFLite::readData(void *data)
+{
+  HostRadioPacket packet;
+  if (radio != nullptr && radio->popReceived(&packet)) {
+    memcpy(data, packet.data, packet.size);
+  }
+}
+
+void NRFLite::discardData(uint8_t unexpectedDataLength)
+{
+  if (radio != nullptr) {
+    radio->popReceived(nullptr);
+  }
+}
+
+uint8_t NRFLite::send(uint8_t toRadioId, void *data, uint8_t length, SendType sendType)
+{
+  if (radio == nullptr) {
+    return 0;
+  }
+  return HostEther::transmit(radio, toRadioId, (const uint8_t *) data, length, sendType == REQUIRE_ACK);
+}
+
+void NRFLite::addAckData(void *data, uint8_t length, uint8_t removeExistingAcks)
+{
+  if (radio == nullptr || !radio->isListening()) {
+    return;
+  }
+  if (removeExistingAcks) {
+    radio->getAckFifo()->clear();
+  }
+  radio->getAckFifo()->push((const uint8_t *) data, length);
+}
+
+void NRFLite::startRx()
+{
+}
+
+void NRFLite::powerDown()
+{
+  if (radio != nullptr) {
+    radio->powerDown();
+  }
+}
+
+uint8_t NRFLite::scanChannel(uint8_t channel, uint8_t measurementCount)
+{
+  return 0;
+}
+
+uint8_t NRFLite::hasDataISR()
+{
+  return hasData();
+}
+
+void NRFLite::startSend(uint8_t toRadioId, void *data, uint8_t length, SendType sendType)
+{
+  send(toRadioId, data, length, sendType);
+}
+
+void NRFLite::whatHappened(uint8_t &txOk, uint8_t &txFail, uint8_t &rxReady)
+{
+  txOk = 0;
+  txFail = 0;
+  rxReady = hasData() > 0;
+}
@@ -0,0 +1,13 @@
+#ifndef TONE_AC_H
+#define TONE_AC_H
+
+// Stand-in for the toneAC library: the tone played by the current board (see HostBoard::getToneFrequency())
+
+#include <Arduino.h>
+
+#define PLAY_FOREVER 0
+
+void toneAC(unsigned long frequency = 0, uint8_t volume = 10, unsigned long length = 0, uint8_t background = false);
+void noToneAC();
+
+#endif
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+Print the results of micro-benchmark (see runner/micro-benchmark.cpp), or compare two of them, e.g. before and after a change:
+the change of the time per operation of each benchmark, flagged when it is beyond the noise (the spread of the samples of both runs).
+
+usage: compare-benchmarks.py [<before.json>] <after.json>
+"""
+
+import json
+import sys
+
+MIN_SIGNIFICANT_CHANGE = 0.05  # Even when the samples are close: a change below 5% is noise on most computers
+
+
+def load(path):
+    with open(path) as file:
+        results = json.load(file)
+    return results['label'] or path, {benchmark['name']: benchmark for benchmark in results['benchmarks']}
+
+
+def spread(benchmark):
+    """Return the relative difference between the median and the fastest sample."""
+    return (benchmark['nsPerOp'] - benchmark['minNsPerOp']) / benchmark['nsPerOp'] if benchmark['nsPerOp'] > 0 else 0
+
+
+def print_results(label, benchmarks):
+    print(f'{label} (ns per operation, median of the samples)')
+    for name, benchmark in benchmarks.items():
+        print(f'  {name:45} {benchmark["nsPerOp"]:10.2f}')
+
+
+def print_comparison(before_label, before, after_label, after):
+    print(f'{before_label} -> {after_label} (ns per operation, median of the samples)')
+    for name, benchmark in after.items():
+        if name not in before:
+            print(f'  {name:45} {"":10} {benchmark["nsPerOp"]:10.2f}   new')
+            continue
+        before_ns, after_ns = before[name]['nsPerOp'], benchmark['nsPerOp']
+        change = (after_ns - before_ns) / before_ns if before_ns > 0 else 0
+        noise = max(MIN_SIGNIFICANT_CHANGE, spread(before[name]) + spread(benchmark))
+        verdict = ('faster' if change < 0 else 'slower') if abs(change) > noise else ''
+        print(f'  {name:45} {before_ns:10.2f} {after_ns:10.2f} {change:+8.1%}   {verdict}')
+    for name in before:
+        if name not in after:
+            print(f'  {name:45} {before[name]["nsPerOp"]:10.2f} {"":10}   removed')
+
+
+def main():
+    if len(sys.argv) == 2:
+        print_results(*load(sys.argv[1]))
+    elif len(sys.argv) == 3:
+        print_comparison(*load(sys.argv[1]), *load(sys.argv[2]))
+    else:
+        sys.exit(__doc__.strip())
+
+
+if __name__ == '__main__':
+    main()
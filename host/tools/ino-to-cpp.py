@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Turn a sketch (.ino) into C++, like the Arduino IDE does before compiling it:
+include Arduino.h, and declare all the functions of the sketch before the first one, so they can be called before being defined.
+
+usage: ino-to-cpp.py <sketch.ino> <output.cpp>
+"""
+
+import re
+import sys
+
+FUNCTION_DEFINITION = re.compile(r'^(?!\s)([A-Za-z_][\w:<>,\s\*&]*?[\s\*&])(\w+)\s*\(([^;{}]*)\)\s*(const\s*)?(\{.*)?$')
+KEYWORDS = {'if', 'while', 'for', 'switch', 'return', 'else', 'do', 'sizeof'}
+
+
+def code_without_comments_and_strings(line, in_comment):
+    """Return the code of the line, and whether a /* comment continues on the next line."""
+    code = ''
+    i = 0
+    while i < len(line):
+        if in_comment:
+            end = line.find('*/', i)
+            if end < 0:
+                return code, True
+            i = end + 2
+            in_comment = False
+        elif line.startswith('//', i):
+            break
+        elif line.startswith('/*', i):
+            in_comment = True
+            i += 2
+        elif line[i] in '"\'':
+            quote = line[i]
+            i += 1
+            while i < len(line) and line[i] != quote:
+                i += 2 if line[i] == '\\' else 1
+            i += 1
+        else:
+            code += line[i]
+            i += 1
+    return code, in_comment
+
+
+def find_function_definitions(lines):
+    """Return the index of the first line defining a function, and the prototypes of all functions defined at the top level."""
+    prototypes = []
+    first_index = None
+    depth = 0
+    in_comment = False
+    codes = []
+    for line in lines:
+        code, in_comment = code_without_comments_and_strings(line, in_comment)
+        codes.append(code)
+
+    for index, code in enumerate(codes):
+        if depth == 0 and not code.startswith('#'):
+            match = FUNCTION_DEFINITION.match(code.rstrip())
+            next_code = next((c.strip() for c in codes[index + 1:] if c.strip()), '')
+            if match and match.group(2) not in KEYWORDS and (match.group(5) or next_code.startswith('{')):
+                return_type, name, parameters, const = match.group(1), match.group(2), match.group(3), match.group(4) or ''
+                if '::' not in name and not return_type.strip().startswith(('class', 'struct', 'enum', 'typedef')):
+                    prototypes.append('%s%s(%s)%s;' % (return_type, name, parameters, (' ' + const.strip()) if const else ''))
+                    if first_index is None:
+                        first_index = index
+        depth += code.count('{') - code.count('}')
+    return first_index, prototypes
+
+
+def main():
+    source_path, output_path = sys.argv[1], sys.argv[2]
+    with open(source_path) as source:
+        lines = source.read().split('\n')
+
+    first_index, prototypes = find_function_definitions(lines)
+    if first_index is None:
+        first_index = len(lines)
+
+    with open(output_path, 'w') as output:
+        output.write('#include <Arduino.h>\n')
+        output.write('#line 1 "%s"\n' % source_path)
+        output.write('\n'.join(lines[:first_index]) + '\n')
+        output.write('\n'.join(prototypes) + '\n')
+        output.write('#line %d "%s"\n' % (first_index + 1, source_path))
+        output.write('\n'.join(lines[first_index:]))
+
+
+if __name__ == '__main__':
+    main()